@@ -41,6 +41,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "utils/KoIconUtils.h"
 #include "mltcontroller/clipcontroller.h"
 #include "mltcontroller/clippropertiescontroller.h"
+#include "mltcontroller/producerqueue.h"
 #include "project/projectcommands.h"
 #include "project/invaliddialog.h"
 #include "projectsortproxymodel.h"
@@ -60,6 +61,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMenu>
 #include <QDebug>
 #include <QtConcurrent>
+#include <QThread>
 #include <QUndoCommand>
 
 
@@ -279,6 +281,9 @@ Bin::Bin(QWidget* parent) :
   , m_blankThumb()
   , m_invalidClipDialog(NULL)
   , m_gainedFocus(false)
+  , m_audioThumbWorkers(0)
+  , m_audioThumbsTotal(0)
+  , m_audioThumbsDone(0)
 {
     QVBoxLayout *layout = new QVBoxLayout(this);
 
@@ -457,58 +462,155 @@ Bin::~Bin()
 
 void Bin::slotAbortAudioThumb(const QString &id)
 {
-    if (!m_audioThumbsThread.isRunning()) return;
     QMutexLocker aMutex(&m_audioThumbMutex);
     m_audioThumbsList.removeAll(id);
 }
 
 void Bin::requestAudioThumbs(const QString &id)
 {
-    if (!m_audioThumbsList.contains(id) && m_processingAudioThumb != id) {
-        m_audioThumbMutex.lock();
-        m_audioThumbsList.append(id);
+    m_audioThumbMutex.lock();
+    if (m_audioThumbsList.contains(id) || m_processingAudioThumbs.contains(id)) {
         m_audioThumbMutex.unlock();
-        processAudioThumbs();
+        return;
+    }
+    m_audioThumbsList.append(id);
+    m_audioThumbsTotal++;
+    m_audioThumbMutex.unlock();
+    ProjectClip *clip = m_rootFolder->clip(id);
+    if (clip && audioThumbPriority(clip, currentFolder()) > 0) {
+        prioritizeAudioThumbs();
+    }
+    processAudioThumbs();
+}
+
+AbstractProjectItem *Bin::currentFolder()
+{
+    if (!m_rootFolder) return NULL;
+    if (m_listType == BinIconView && m_itemView) {
+        // In icon view, the displayed folder is the view's root
+        QModelIndex ix = m_proxyModel->mapToSource(m_itemView->rootIndex());
+        if (ix.isValid()) {
+            return static_cast<AbstractProjectItem *>(ix.internalPointer());
+        }
+    }
+    QStringList folderInfo = getFolderInfo();
+    if (!folderInfo.isEmpty()) {
+        AbstractProjectItem *folder = m_rootFolder->folder(folderInfo.first());
+        if (folder) return folder;
+    }
+    return m_rootFolder;
+}
+
+int Bin::audioThumbPriority(ProjectClip *clip, AbstractProjectItem *folder) const
+{
+    int priority = 0;
+    if (clip->refCount() > 0) {
+        // Clip is used in timeline
+        priority++;
+    }
+    if (folder && clip->parent() == folder) {
+        // Clip is displayed in the current bin folder
+        priority += 2;
+    }
+    return priority;
+}
+
+void Bin::prioritizeAudioThumbs()
+{
+    AbstractProjectItem *folder = currentFolder();
+    QMutexLocker aMutex(&m_audioThumbMutex);
+    if (m_audioThumbsList.count() < 2) return;
+    QMap <int, QStringList> sorted;
+    foreach (const QString &id, m_audioThumbsList) {
+        ProjectClip *clip = m_rootFolder->clip(id);
+        int priority = clip ? audioThumbPriority(clip, folder) : 0;
+        // Negative key so that highest priorities come first
+        sorted[-priority] << id;
+    }
+    m_audioThumbsList.clear();
+    QMapIterator <int, QStringList> i(sorted);
+    while (i.hasNext()) {
+        i.next();
+        m_audioThumbsList << i.value();
     }
 }
 
+void Bin::prioritizeClipLoading()
+{
+    AbstractProjectItem *folder = currentFolder();
+    if (!folder) return;
+    QStringList ids;
+    for (int i = 0; i < folder->count(); ++i) {
+        AbstractProjectItem *item = folder->at(i);
+        if (item->itemType() == AbstractProjectItem::ClipItem) {
+            ids << item->clipId();
+        }
+    }
+    pCore->producerQueue()->prioritize(ids);
+}
+
 void Bin::processAudioThumbs()
 {
-    if (m_audioThumbsThread.isRunning()) return;
-    m_audioThumbsThread = QtConcurrent::run(this, &Bin::slotCreateAudioThumbs);
+    QMutexLocker aMutex(&m_audioThumbMutex);
+    if (!m_audioThumbsThreads.futures().isEmpty()) {
+        // Remove inactive threads
+        QList <QFuture<void> > futures = m_audioThumbsThreads.futures();
+        m_audioThumbsThreads.clearFutures();
+        for (int i = 0; i < futures.count(); ++i)
+            if (!futures.at(i).isFinished()) {
+                m_audioThumbsThreads.addFuture(futures.at(i));
+            }
+    }
+    // Each worker may open an avformat producer, they share the producerthreads budget, see Render::checkMaxThreads
+    int maxThreads = qBound(1, KdenliveSettings::audiothumbthreads(), qMax(1, qMin(KdenliveSettings::producerthreads(), QThread::idealThreadCount())));
+    int wanted = qMin(maxThreads, m_audioThumbsList.count());
+    while (m_audioThumbWorkers < wanted) {
+        m_audioThumbWorkers++;
+        m_audioThumbsThreads.addFuture(QtConcurrent::run(this, &Bin::slotCreateAudioThumbs));
+    }
 }
 
 void Bin::abortAudioThumbs()
 {
-    if (!m_audioThumbsThread.isRunning()) return;
-    if (!m_processingAudioThumb.isEmpty()) {
-        ProjectClip *clip = m_rootFolder->clip(m_processingAudioThumb);
-        if (clip) clip->abortAudioThumbs();
-    }
     m_audioThumbMutex.lock();
     m_audioThumbsList.clear();
+    foreach (const QString &id, m_processingAudioThumbs) {
+        ProjectClip *clip = m_rootFolder->clip(id);
+        if (clip) clip->abortAudioThumbs();
+    }
     m_audioThumbMutex.unlock();
-    m_audioThumbsThread.waitForFinished();
+    m_audioThumbsThreads.waitForFinished();
+    m_audioThumbsThreads.clearFutures();
 }
 
 void Bin::slotCreateAudioThumbs()
 {
-    int max = m_audioThumbsList.count();
-    int count = 0;
-    while (!m_audioThumbsList.isEmpty()) {
+    forever {
         m_audioThumbMutex.lock();
-        max = qMax(max, m_audioThumbsList.count());
-        m_processingAudioThumb = m_audioThumbsList.takeFirst();
-        count++;
+        if (m_audioThumbsList.isEmpty()) {
+            m_audioThumbWorkers--;
+            bool finished = m_audioThumbWorkers == 0;
+            if (finished) {
+                m_audioThumbsTotal = 0;
+                m_audioThumbsDone = 0;
+            }
+            m_audioThumbMutex.unlock();
+            if (finished) emitMessage(i18n("Audio thumbnails done"), OperationCompletedMessage);
+            break;
+        }
+        QString id = m_audioThumbsList.takeFirst();
+        m_processingAudioThumbs << id;
+        m_audioThumbsDone++;
+        int count = m_audioThumbsDone;
+        int max = qMax(m_audioThumbsTotal, count);
         m_audioThumbMutex.unlock();
         emitMessage(i18n("Creating audio thumbnails") + QString(" (%1/%2)").arg(count).arg(max), ProcessingJobMessage);
-        ProjectClip *clip = m_rootFolder->clip(m_processingAudioThumb);
+        ProjectClip *clip = m_rootFolder->clip(id);
         if (clip) clip->slotCreateAudioThumbs();
+        m_audioThumbMutex.lock();
+        m_processingAudioThumbs.removeAll(id);
+        m_audioThumbMutex.unlock();
     }
-    m_audioThumbMutex.lock();
-    m_processingAudioThumb.clear();
-    m_audioThumbMutex.unlock();
-    emitMessage(i18n("Audio thumbnails done"), OperationCompletedMessage);
 }
 
 bool Bin::eventFilter(QObject *obj, QEvent *event)
@@ -821,6 +923,11 @@ QUrl Bin::projectFolder() const
     return m_doc->projectFolder();
 }
 
+ThumbnailCache *Bin::thumbnailCache()
+{
+    return m_doc->clipManager()->thumbnailCache();
+}
+
 void Bin::setMonitor(Monitor *monitor)
 {
     m_monitor = monitor;
@@ -1503,6 +1610,8 @@ void Bin::slotItemDoubleClicked(const QModelIndex &ix, const QPoint pos)
         if (item->count() > 0 || item->itemType() == AbstractProjectItem::FolderItem) {
             m_folderUp->setParent(item);
             m_itemView->setRootIndex(ix);
+            prioritizeAudioThumbs();
+            prioritizeClipLoading();
             return;
         }
         if (item == m_folderUp) {
@@ -1514,6 +1623,8 @@ void Bin::slotItemDoubleClicked(const QModelIndex &ix, const QPoint pos)
             }
             else m_folderUp->setParent(NULL);
             m_itemView->setRootIndex(m_proxyModel->mapFromSource(parent));
+            prioritizeAudioThumbs();
+            prioritizeClipLoading();
             return;
         }
     }
@@ -3091,10 +3202,9 @@ void Bin::slotSendAudioThumb(QString id)
 {
     ProjectClip *clip = m_rootFolder->clip(id);
     if (clip && clip->audioThumbCreated()) {
-        m_monitor->prepareAudioThumb(clip->audioChannels(), clip->audioFrameCache);
+        m_monitor->prepareAudioThumb(clip->audioFrameCache);
     } else {
-        QVariantList list;
-        m_monitor->prepareAudioThumb(0, list);
+        m_monitor->prepareAudioThumb(AudioPeaks());
     }
 }
 
@@ -37,6 +37,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QUrl>
 #include <QListView>
 #include <QFuture>
+#include <QFutureSynchronizer>
 #include <QMutex>
 #include <QLineEdit>
 
@@ -57,6 +58,7 @@ class ProjectSortProxyModel;
 class JobManager;
 class ProjectFolderUp;
 class InvalidDialog;
+class ThumbnailCache;
 
 namespace Mlt {
   class Producer;
@@ -483,6 +485,8 @@ public:
     void updateMasterEffect(ClipController *ctl);
     /** @brief Returns current project's folder for storing items. */
     QUrl projectFolder() const;
+    /** @brief Returns the persistent video thumbnail store of the project. */
+    ThumbnailCache *thumbnailCache();
     /** @brief Display a message about an operation in status bar. */
     void emitMessage(const QString &, MessageType);
     void rebuildMenu();
@@ -673,12 +677,18 @@ private:
     InvalidDialog *m_invalidClipDialog;
     /** @brief Set to true if widget just gained focus (means we have to update effect stack . */
     bool m_gainedFocus;
-    /** @brief List of Clip Ids that want an audio thumb. */
+    /** @brief List of Clip Ids that want an audio thumb, by priority. */
     QStringList m_audioThumbsList;
-    QString m_processingAudioThumb;
+    /** @brief Clip Ids whose audio thumb is currently being created. */
+    QStringList m_processingAudioThumbs;
     QMutex m_audioThumbMutex;
-    /** @brief Indicates whether audio thumbnail creation is running. */
-    QFuture<void> m_audioThumbsThread;
+    /** @brief Number of running audio thumbnail workers. */
+    int m_audioThumbWorkers;
+    /** @brief Audio thumbnails requested / started since the workers were last idle, for progress display. */
+    int m_audioThumbsTotal;
+    int m_audioThumbsDone;
+    /** @brief The running audio thumbnail workers. */
+    QFutureSynchronizer<void> m_audioThumbsThreads;
     void showClipProperties(ProjectClip *clip, bool forceRefresh = false, bool openExternalDialog = true);
     const QStringList getFolderInfo(QModelIndex selectedIx = QModelIndex());
     /** @brief Get the QModelIndex value for an item in the Bin. */
@@ -688,7 +698,15 @@ private:
     ProjectClip *getFirstSelectedClip();
     void showTitleWidget(ProjectClip *clip);
     void showSlideshowWidget(ProjectClip *clip);
+    /** @brief Start audio thumbnail workers, up to the configured thread count. */
     void processAudioThumbs();
+    /** @brief Sort pending audio thumbnails so that clips used in timeline or displayed in current folder come first. */
+    void prioritizeAudioThumbs();
+    int audioThumbPriority(ProjectClip *clip, AbstractProjectItem *folder) const;
+    /** @brief Ask the producer queue to load the clips of the current folder first. */
+    void prioritizeClipLoading();
+    /** @brief Returns the folder currently displayed or selected in the bin. */
+    AbstractProjectItem *currentFolder();
 
 signals:
     void itemUpdated(AbstractProjectItem*);
@@ -26,12 +26,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bin.h"
 #include "timecode.h"
 #include "doc/kthumb.h"
+#include "doc/thumbnailcache.h"
 #include "kdenlivesettings.h"
 #include "timeline/clip.h"
 #include "project/projectcommands.h"
 #include "mltcontroller/clipcontroller.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "mltcontroller/clippropertiescontroller.h"
+#include "mltcontroller/mediainfocache.h"
+#include "core.h"
 
 #include <QDomElement>
 #include <QFile>
@@ -41,6 +44,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtConcurrent>
 #include <KLocalizedString>
 #include <KMessageBox>
+#include <cmath>
 
 
 ProjectClip::ProjectClip(const QString &id, QIcon thumb, ClipController *controller, ProjectFolder* parent) :
@@ -48,6 +52,7 @@ ProjectClip::ProjectClip(const QString &id, QIcon thumb, ClipController *control
     , m_abortAudioThumb(false)
     , m_controller(controller)
     , m_thumbsProducer(NULL)
+    , m_filmstripHeight(0)
 {
     m_clipStatus = StatusReady;
     m_thumbnail = thumb;
@@ -70,6 +75,7 @@ ProjectClip::ProjectClip(const QDomElement& description, QIcon thumb, ProjectFol
     , m_controller(NULL)
     , m_type(Unknown)
     , m_thumbsProducer(NULL)
+    , m_filmstripHeight(0)
 {
     Q_ASSERT(description.hasAttribute("id"));
     m_clipStatus = StatusWaiting;
@@ -99,6 +105,7 @@ ProjectClip::~ProjectClip()
     QMutexLocker audioLock(&m_audioMutex);
     m_thumbMutex.lock();
     m_requestedThumbs.clear();
+    m_filmstripQueue.clear();
     m_thumbMutex.unlock();
     m_thumbThread.waitForFinished();
     delete m_thumbsProducer;
@@ -108,7 +115,6 @@ ProjectClip::~ProjectClip()
 void ProjectClip::abortAudioThumbs()
 {
     m_abortAudioThumb = true;
-    emit doAbortAudioThumbs();
 }
 
 QString ProjectClip::getToolTip() const
@@ -129,7 +135,7 @@ QString ProjectClip::getXmlProperty(const QDomElement &producer, const QString &
     return value;
 }
 
-void ProjectClip::updateAudioThumbnail(QVariantList audioLevels)
+void ProjectClip::updateAudioThumbnail(const AudioPeaks &audioLevels)
 {
     audioFrameCache = audioLevels;
     m_controller->audioThumbCreated = true;
@@ -346,6 +352,8 @@ bool ProjectClip::setProducer(ClipController *controller, bool replaceProducer)
 void ProjectClip::createAudioThumbs()
 {
     if (KdenliveSettings::audiothumbnails() && (m_type == AV || m_type == Audio || m_type == Playlist)) {
+        // Mapping a cached peak file is cheap, only queue clips that need processing
+        if (loadAudioPeaks()) return;
         bin()->requestAudioThumbs(m_id);
     }
 }
@@ -521,23 +529,17 @@ const QString ProjectClip::getFileHash() const
           fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
           break;
       default:
-          QFile file(m_controller ? m_controller->clipUrl().toLocalFile() : m_temporaryUrl.toLocalFile());
-          if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
-              /*
-               * 1 MB = 1 second per 450 files (or faster)
-               * 10 MB = 9 seconds per 450 files (or faster)
-               */
-            if (file.size() > 2000000) {
-                fileData = file.read(1000000);
-                if (file.seek(file.size() - 1000000))
-                    fileData.append(file.readAll());
-            } else
-                fileData = file.readAll();
-            file.close();
-            if (m_controller) m_controller->setProperty(QStringLiteral("kdenlive:file_size"), QString::number(file.size()));
-            fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
+          {
+            // The media info index only reads the file if it changed since last time
+            qint64 fileSize = 0;
+            const QString hash = pCore->mediaInfoCache()->fileHash(m_controller ? m_controller->clipUrl().toLocalFile() : m_temporaryUrl.toLocalFile(), &fileSize);
+            if (hash.isEmpty()) return QString();
+            if (m_controller) {
+                m_controller->setProperty(QStringLiteral("kdenlive:file_size"), QString::number(fileSize));
+                m_controller->setProperty(QStringLiteral("kdenlive:file_hash"), hash);
+            }
+            return hash;
           }
-          break;
     }
     if (fileHash.isEmpty()) return QString();
     QString result = fileHash.toHex();
@@ -793,28 +795,110 @@ void ProjectClip::slotExtractImage(QList <int> frames)
     }
 }
 
+QImage ProjectClip::cachedThumbnail(int frame)
+{
+    return bin()->thumbnailCache()->cachedImage(hash(), frame, 150);
+}
+
+QImage ProjectClip::filmstripTile(int frame, int height)
+{
+    return bin()->thumbnailCache()->cachedImage(hash(), frame, height);
+}
+
+void ProjectClip::requestFilmstripTiles(const QList <int> &frames, int height)
+{
+    QMutexLocker lock(&m_thumbMutex);
+    if (height != m_filmstripHeight) {
+        // Track height changed, pending tiles are useless
+        m_filmstripQueue.clear();
+        m_filmstripHeight = height;
+    }
+    foreach (int frame, frames) {
+        if (!m_filmstripQueue.contains(frame)) m_filmstripQueue << frame;
+    }
+    // Tiles requested for a previously exposed area are dropped when scrolling fast
+    while (m_filmstripQueue.count() > 200) {
+        m_filmstripQueue.removeFirst();
+    }
+    if (!m_thumbThread.isRunning()) {
+        m_thumbThread = QtConcurrent::run(this, &ProjectClip::doExtractImage);
+    }
+}
+
 void ProjectClip::doExtractImage()
 {
     Mlt::Producer *prod = thumbProducer();
     if (prod == NULL || !prod->is_valid()) return;
     int fullWidth = (int)((double) 150 * prod->profile()->dar() + 0.5);
     QDir thumbFolder(bin()->projectFolder().path() + "/thumbs/");
+    ThumbnailCache *cache = bin()->thumbnailCache();
+    const QString clipHash = hash();
     int max = prod->get_length();
     int pos;
-    while (!m_requestedThumbs.isEmpty()) {
+    int lastTile = 0;
+    int readyTiles = 0;
+    while (true) {
         m_thumbMutex.lock();
+        if (m_requestedThumbs.isEmpty()) {
+            if (m_filmstripQueue.isEmpty()) {
+                m_thumbMutex.unlock();
+                break;
+            }
+            // Decode filmstrip tiles in increasing frame order from the last one, so that
+            // the producer mostly seeks forward and does not restart from a keyframe for each tile
+            int index = -1;
+            for (int i = 0; i < m_filmstripQueue.count(); ++i) {
+                int frame = m_filmstripQueue.at(i);
+                if (frame >= lastTile && (index == -1 || frame < m_filmstripQueue.at(index))) index = i;
+            }
+            if (index == -1) {
+                index = 0;
+                for (int i = 1; i < m_filmstripQueue.count(); ++i) {
+                    if (m_filmstripQueue.at(i) < m_filmstripQueue.at(index)) index = i;
+                }
+            }
+            lastTile = m_filmstripQueue.takeAt(index);
+            int height = m_filmstripHeight;
+            bool lastInQueue = m_filmstripQueue.isEmpty();
+            m_thumbMutex.unlock();
+            bool decoded = !cache->find(clipHash, lastTile, height).isNull();
+            if (!decoded) {
+                prod->seek(qBound(0, lastTile, max - 1));
+                Mlt::Frame *frame = prod->get_frame();
+                if (frame && frame->is_valid()) {
+                    QImage img = KThumb::getFrame(frame, (int)(height * prod->profile()->dar() + 0.5), height);
+                    cache->insert(clipHash, lastTile, height, img);
+                    decoded = !img.isNull();
+                }
+                delete frame;
+            }
+            if (decoded) readyTiles++;
+            // Don't repaint the timeline for every single tile
+            if (readyTiles > 0 && (readyTiles >= 8 || lastInQueue)) {
+                readyTiles = 0;
+                emit filmstripReady();
+            }
+            continue;
+        }
         pos = m_requestedThumbs.takeFirst();
         m_thumbMutex.unlock();
-        if (thumbFolder.exists(hash() + '#' + QString::number(pos) + ".png")) {
-            emit thumbReady(pos, QImage(thumbFolder.absoluteFilePath(hash() + '#' + QString::number(pos) + ".png")));
+        if (thumbFolder.exists(clipHash + '#' + QString::number(pos) + ".png")) {
+            emit thumbReady(pos, QImage(thumbFolder.absoluteFilePath(clipHash + '#' + QString::number(pos) + ".png")));
             continue;
         }
+        QImage cached = cache->find(clipHash, pos, 150);
+        if (!cached.isNull()) {
+            emit thumbReady(pos, cached);
+            continue;
+        }
+        int requestedPos = pos;
 	if (pos >= max) pos = max - 1;
 	prod->seek(pos);
 	Mlt::Frame *frame = prod->get_frame();
 	if (frame && frame->is_valid()) {
             QImage img = KThumb::getFrame(frame, fullWidth, 150);
-            emit thumbReady(pos, img);
+            cache->insert(clipHash, requestedPos, 150, img);
+            emit thumbReady(requestedPos, img);
         }
         delete frame;
     }
@@ -871,148 +955,115 @@ void ProjectClip::slotCreateAudioThumbs()
     Mlt::Producer *prod = originalProducer();
     if (!prod || !prod->is_valid()) return;
     AudioStreamInfo *audioInfo = m_controller->audioInfo();
-    int audioStream = audioInfo->ffmpeg_audio_index();
     if (audioInfo == NULL) return;
-    QString clipHash = hash();
-    if (clipHash.isEmpty()) return;
-    QString audioPath = bin()->projectFolder().path() + "/thumbs/" + clipHash;
-    if (audioStream > 0) {
-        audioPath.append("_" + QString::number(audioInfo->audio_index()));
+    int audioStream = audioInfo->ffmpeg_audio_index();
+    QString audioPath = audioPeaksPath();
+    if (audioPath.isEmpty()) return;
+    if (loadAudioPeaks()) {
+        // Peaks were cached on disk
+        return;
     }
-    audioPath.append("_audio.png");
     int lengthInFrames = prod->get_length();
     int frequency = audioInfo->samplingRate();
     if (frequency <= 0) frequency = 48000;
     int channels = audioInfo->channels();
     if (channels <= 0) channels = 2;
-    QVariantList audioLevels;
-    QImage image(audioPath);
-    if (!image.isNull()) {
-        // convert cached image
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p = image.pixel(i / 2, i % channels);
-            audioLevels << qRed(p);
-            audioLevels << qGreen(p);
-            audioLevels << qBlue(p);
-            audioLevels << qAlpha(p);
-        }
-    }
-    if (audioLevels.size() > 0) {
-        updateAudioThumbnail(audioLevels);
-        return;
-    }
+    AudioPeaks audioLevels(channels, lengthInFrames);
+    QVector <AudioPeak> framePeaks(channels);
 
     if (KdenliveSettings::ffmpegaudiothumbnails() && m_type != Playlist) {
+        // Decode all channels of the audio stream as interleaved 16 bit samples on stdout,
+        // peaks are computed while reading so that memory use does not depend on clip length
         QStringList args;
-        QTemporaryFile tmpfile;
-        if (!tmpfile.open()) {
-            bin()->emitMessage(i18n("Cannot create temporary file, check disk space and permissions"), ErrorMessage);
-            return;
-        }
-        QTemporaryFile tmpfile2;
-        if (!tmpfile2.open()) {
-            bin()->emitMessage(i18n("Cannot create temporary file, check disk space and permissions"), ErrorMessage);
-            return;
-        }
-        tmpfile.close();
-        tmpfile2.close();
         args << QStringLiteral("-i") << QUrl::fromLocalFile(prod->get("resource")).path();
-
-        bool isFFmpeg = KdenliveSettings::ffmpegpath().contains("ffmpeg");
-
-        if (channels == 1) {
-            if (isFFmpeg) {
-                args << QStringLiteral("-ac") << QString::number(channels);
-                args << QStringLiteral("-filter_complex:a") << QStringLiteral("aformat=channel_layouts=mono,aresample=async=100");
-                args << QStringLiteral("-map") << QStringLiteral("0:a%1").arg(audioStream > 0 ? ":" + QString::number(audioStream) : "") << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("data")<< tmpfile.fileName();
-            } else {
-                args << QStringLiteral("-filter_complex:a") << QStringLiteral("aformat=channel_layouts=mono:sample_rates=100");
-                args << QStringLiteral("-map") << QStringLiteral("0:a%1").arg(audioStream > 0 ? ":" + QString::number(audioStream) : "") << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("s16le")<< tmpfile.fileName();
-            }
-        } else {
-            if (isFFmpeg) {
-                //args << QStringLiteral("-ac") << QString::number(channels);
-                args << QStringLiteral("-filter_complex:a") << QStringLiteral("[0:a%1]aresample=async=100,channelsplit=channel_layout=stereo[0:0][0:1]").arg(audioStream > 0 ? ":" + QString::number(audioStream) : "");
-                // Channel 1
-                args << QStringLiteral("-map") << QStringLiteral("[0:1]") << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("data")<< tmpfile.fileName();
-                // Channel 2
-                args << QStringLiteral("-map") << QStringLiteral("[0:0]") << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("data")<< tmpfile2.fileName();
-            } else {
-                args << QStringLiteral("-filter_complex:a") << QStringLiteral("[0:a%1]aformat=sample_rates=100,channelsplit=channel_layout=stereo[0:0][0:1]").arg(audioStream > 0 ? ":" + QString::number(audioStream) : "");
-                // Channel 1
-                args << QStringLiteral("-map") << QStringLiteral("[0:1]") << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("s16le")<< tmpfile.fileName();
-                // Channel 2
-                args << QStringLiteral("-map") << QStringLiteral("[0:0]") << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("s16le")<< tmpfile2.fileName();
-            }
-        }
+        args << QStringLiteral("-map") << QStringLiteral("0:a:%1").arg(qMax(audioStream, 0)) << QStringLiteral("-vn");
+        args << QStringLiteral("-ac") << QString::number(channels) << QStringLiteral("-ar") << QString::number(frequency);
+        args << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-f") << QStringLiteral("s16le") << QStringLiteral("-");
         emit updateJobStatus(AbstractClipJob::THUMBJOB, JobWaiting, 0);
         QProcess audioThumbsProcess;
-        connect(this, SIGNAL(doAbortAudioThumbs()), &audioThumbsProcess, SLOT(kill()));
+        // Nobody reads the log, make sure it cannot fill the pipe and block the decoder
+        audioThumbsProcess.setStandardErrorFile(QProcess::nullDevice());
+        audioThumbsProcess.setReadChannel(QProcess::StandardOutput);
         audioThumbsProcess.start(KdenliveSettings::ffmpegpath(), args);
-        bool ffmpegError = false;
         if (!audioThumbsProcess.waitForStarted()) {
-            ffmpegError = true;
+            emit updateJobStatus(AbstractClipJob::THUMBJOB, JobDone, 0);
+            bin()->emitMessage(i18n("Crash in %1 - creating audio thumbnails", KdenliveSettings::ffmpegpath()), ErrorMessage);
+            return;
+        }
+        audioThumbsProcess.closeWriteChannel();
+        const int sampleFrameSize = 2 * channels;
+        double samplesPerFrame = (double) frequency / prod->get_fps();
+        QVector <qint16> mins(channels, 0);
+        QVector <qint16> maxs(channels, 0);
+        QVector <double> squares(channels, 0);
+        qint64 sampleCount = 0;
+        qint64 nextFrame = qMax((qint64) 1, (qint64) samplesPerFrame);
+        int samplesInFrame = 0;
+        int progress = 0;
+        QByteArray pending;
+        while (!m_abortAudioThumb) {
+            if (audioThumbsProcess.bytesAvailable() == 0) {
+                if (audioThumbsProcess.state() == QProcess::NotRunning) break;
+                audioThumbsProcess.waitForReadyRead(100);
+                continue;
+            }
+            pending.append(audioThumbsProcess.readAll());
+            int usable = pending.size() - pending.size() % sampleFrameSize;
+            const qint16 *samples = (const qint16 *) pending.constData();
+            for (int i = 0; i < usable / 2; i += channels) {
+                for (int channel = 0; channel < channels; channel++) {
+                    qint16 sample = samples[i + channel];
+                    if (sample < mins.at(channel)) mins[channel] = sample;
+                    if (sample > maxs.at(channel)) maxs[channel] = sample;
+                    squares[channel] += (double) sample * sample;
+                }
+                samplesInFrame++;
+                if (++sampleCount >= nextFrame) {
+                    for (int channel = 0; channel < channels; channel++) {
+                        framePeaks[channel] = AudioPeaks::fromSamples(mins.at(channel), maxs.at(channel), sqrt(squares.at(channel) / samplesInFrame));
+                        mins[channel] = 0;
+                        maxs[channel] = 0;
+                        squares[channel] = 0;
+                    }
+                    audioLevels.appendFrame(framePeaks.constData());
+                    samplesInFrame = 0;
+                    nextFrame = (qint64) ((audioLevels.frameCount() + 1) * samplesPerFrame);
+                }
+            }
+            pending.remove(0, usable);
+            if (lengthInFrames > 0) {
+                int p = qMin(audioLevels.frameCount() * 100 / lengthInFrames, 100);
+                if (p != progress) {
+                    emit updateJobStatus(AbstractClipJob::THUMBJOB, JobWorking, p);
+                    progress = p;
+                }
+            }
         }
-        audioThumbsProcess.waitForFinished();
         if (m_abortAudioThumb) {
+            audioThumbsProcess.kill();
+            audioThumbsProcess.waitForFinished();
             emit updateJobStatus(AbstractClipJob::THUMBJOB, JobDone, 0);
             m_abortAudioThumb = false;
             return;
         }
-        if (ffmpegError || audioThumbsProcess.exitStatus() == QProcess::CrashExit) {
+        audioThumbsProcess.waitForFinished();
+        if (samplesInFrame > 0) {
+            // Last, incomplete frame
+            for (int channel = 0; channel < channels; channel++) {
+                framePeaks[channel] = AudioPeaks::fromSamples(mins.at(channel), maxs.at(channel), sqrt(squares.at(channel) / samplesInFrame));
+            }
+            audioLevels.appendFrame(framePeaks.constData());
+        }
+        if (audioThumbsProcess.exitStatus() == QProcess::CrashExit) {
             emit updateJobStatus(AbstractClipJob::THUMBJOB, JobDone, 0);
             bin()->emitMessage(i18n("Crash in %1 - creating audio thumbnails", KdenliveSettings::ffmpegpath()), ErrorMessage);
             return;
         }
-        tmpfile.open();
-        QByteArray res = tmpfile.readAll();
-        tmpfile.close();
-        if (res.size() == 0) {
+        if (audioLevels.frameCount() == 0) {
             emit updateJobStatus(AbstractClipJob::THUMBJOB, JobDone, 0);
             bin()->emitMessage(i18n("Error reading audio thumbnail"), ErrorMessage);
             return;
         }
-        const qint16* raw = (const qint16*) res.constData();
-        const qint16* raw2 = raw;
-        QByteArray res2;
-        QList<qint16> data2;
-        if (channels > 1) {
-            tmpfile2.open();
-            res2 = tmpfile2.readAll();
-            tmpfile2.close();
-            raw2 = (const qint16*) res2.constData();
-        }
-        int progress = 0;
-        double offset = (double) res.size() / (2 * lengthInFrames);
-        int pos = 0;
-        for (int i = 0; i < lengthInFrames; i++) {
-            long c1 = 0;
-            long c2 = 0;
-            pos = (int) (i * offset);
-            int steps = 0;
-            for (int j = 0; j < (int) offset && (pos + j < res.size()); j++) {
-                steps ++;
-                c1 += abs(raw[pos + j]);
-                if (channels > 1) {
-                    c2 += abs(raw2[pos + j]);
-                }
-            }
-            c1 /= steps;
-            c1 = c1 * 800 / 32768.0;
-            audioLevels << (double) c1;
-            if (channels > 1) {
-                c2 /= steps;
-                c2 = c2 * 800 / 32768.0;
-                audioLevels << (double)c2;
-            }
-            int p = i * 100 / lengthInFrames;
-            if (p != progress) {
-                emit updateJobStatus(AbstractClipJob::THUMBJOB, JobWorking, p);
-                progress = p;
-            }
-            if (m_abortAudioThumb) break;
-        }
     } else {
         QString service = prod->get("mlt_service");
         if (service == QLatin1String("avformat-novalidate"))
@@ -1052,46 +1103,56 @@ void ProjectClip::slotCreateAudioThumbs()
                 int samples = mlt_sample_calculator(framesPerSecond, frequency, z);
                 mlt_frame->get_audio(audioFormat, frequency, channels, samples);
                 for (int channel = 0; channel < channels; ++channel) {
-                    double level = 256 * qMin(mlt_frame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
-                    audioLevels << level;
+                    double level = qMin(mlt_frame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
+                    framePeaks[channel] = AudioPeaks::fromLevel(level);
                 }
-            } else if (!audioLevels.isEmpty()) {
-                for (int channel = 0; channel < channels; channel++)
-                    audioLevels << audioLevels.last();
+                audioLevels.appendFrame(framePeaks.constData());
+            } else if (audioLevels.frameCount() > 0) {
+                // Repeat previous frame
+                audioLevels.appendFrame(framePeaks.constData());
             }
             if (m_abortAudioThumb) break;
         }
     }
 
     emit updateJobStatus(AbstractClipJob::THUMBJOB, JobDone, 0);
+    audioLevels.finalize();
     if (!m_abortAudioThumb) {
         updateAudioThumbnail(audioLevels);
     }
 
-    if (!m_abortAudioThumb && audioLevels.size() > 0) {
-        // Put into an image for caching.
-        int count = audioLevels.size();
-        QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i ++) {
-            QRgb p; 
-            if ((4*i + 3) < count) {
-                p = qRgba(audioLevels.at(4*i).toInt(), audioLevels.at(4*i+1).toInt(), audioLevels.at(4*i+2).toInt(), audioLevels.at(4*i+3).toInt());
-            } else {
-                int last = audioLevels.last().toInt();
-                int r = (4*i+0) < count? audioLevels.at(4*i+0).toInt() : last;
-                int g = (4*i+1) < count? audioLevels.at(4*i+1).toInt() : last;
-                int b = (4*i+2) < count? audioLevels.at(4*i+2).toInt() : last;
-                int a = last;
-                p = qRgba(r, g, b, a);
-            }
-            image.setPixel(i / 2, i % channels, p);
+    if (!m_abortAudioThumb && !audioLevels.isEmpty()) {
+        // Cache peaks for next project load
+        if (!audioLevels.save(audioPath, audioInfo->audio_index())) {
+            qDebug() << "// Cannot write audio peaks to " << audioPath;
         }
-        image.save(audioPath);
     }
     m_abortAudioThumb = false;
 }
 
+const QString ProjectClip::audioPeaksPath()
+{
+    if (!m_controller || !m_controller->audioInfo()) return QString();
+    QString clipHash = hash();
+    if (clipHash.isEmpty()) return QString();
+    return bin()->projectFolder().path() + "/thumbs/" + clipHash + '_' + QString::number(m_controller->audioInfo()->audio_index()) + ".peaks";
+}
+
+bool ProjectClip::loadAudioPeaks()
+{
+    QString path = audioPeaksPath();
+    if (path.isEmpty() || !QFile::exists(path)) return false;
+    AudioStreamInfo *audioInfo = m_controller->audioInfo();
+    AudioPeaks peaks;
+    if (!peaks.load(path, audioInfo->audio_index()) || (audioInfo->channels() > 0 && peaks.channels() != audioInfo->channels())) {
+        // Outdated or half written file, it will be regenerated
+        QFile::remove(path);
+        return false;
+    }
+    updateAudioThumbnail(peaks);
+    return true;
+}
+
 bool ProjectClip::isTransparent() const
 {
     if (m_type == Text) return true;
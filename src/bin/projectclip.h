@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "abstractprojectitem.h"
 #include "definitions.h"
+#include "lib/audio/audioPeaks.h"
 
 
 #include <QUrl>
@@ -136,6 +137,13 @@ public:
     /** @brief Returns this clip's producer. */
     Mlt::Producer *originalProducer();
     Mlt::Producer *thumbProducer();
+    /** @brief Returns the timeline thumbnail of @param frame if it is kept in memory, or a null image.
+     *  Never reads the disk, thumbnails stored there are loaded by slotExtractImage(). */
+    QImage cachedThumbnail(int frame);
+    /** @brief Returns a filmstrip tile if it is already decoded and in memory, never blocks on disk or decoding. */
+    QImage filmstripTile(int frame, int height);
+    /** @brief Queue filmstrip tiles for decoding in the thumbnail thread, filmstripReady() is emitted as they arrive. */
+    void requestFilmstripTiles(const QList <int> &frames, int height);
     
     ClipController *controller();
 
@@ -174,9 +182,8 @@ public:
     /** @brief Returns true if we are using a proxy for this clip. */
     bool hasProxy() const;
 
-    /** Cache for every audio Frame with 10 Bytes */
-    /** format is frame -> channel ->bytes */
-    QVariantList audioFrameCache;
+    /** @brief Audio peaks for every frame and channel, with reduced levels for zoomed out display. */
+    AudioPeaks audioFrameCache;
     bool audioThumbCreated() const;
 
     void updateParentInfo(const QString &folderid, const QString &foldername);
@@ -207,7 +214,7 @@ public:
     QStringList subClipIds() const;
 
 public slots:
-    void updateAudioThumbnail(QVariantList audioLevels);
+    void updateAudioThumbnail(const AudioPeaks &audioLevels);
     /** @brief Extract image thumbnails for timeline. */
     void slotExtractImage(QList <int> frames);
     /** @brief Extract image thumbnails for clip's subclips. */
@@ -235,7 +242,14 @@ private:
     QMutex m_audioMutex;
     QFuture <void> m_thumbThread;
     QList <int> m_requestedThumbs;
+    /** @brief Filmstrip tiles to decode, most recent requests last. */
+    QList <int> m_filmstripQueue;
+    int m_filmstripHeight;
     const QString geometryWithOffset(const QString &data, int offset);
+    /** @brief Returns the peak cache file for this clip's hash and audio stream. */
+    const QString audioPeaksPath();
+    /** @brief Map this clip's cached audio peaks if a valid peak file exists. */
+    bool loadAudioPeaks();
     void doExtractImage();
 
 signals:
@@ -244,12 +258,12 @@ signals:
     void refreshAnalysisPanel();
     void refreshClipDisplay();
     void thumbReady(int, QImage);
+    /** @brief New filmstrip tiles were decoded. */
+    void filmstripReady();
     void thumbUpdated(QImage);
     void updateJobStatus(int jobType, int status, int progress = 0, const QString &statusMessage = QString());
     /** @brief Clip is ready, load properties. */
     void loadPropertiesPanel();
-    /** @brief Terminate running audio proxy job. */
-    void doAbortAudioThumbs();
 };
 
 #endif
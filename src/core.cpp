@@ -14,9 +14,12 @@ the Free Software Foundation, either version 3 of the License, or
 #include "monitor/monitormanager.h"
 #include "mltcontroller/bincontroller.h"
 #include "mltcontroller/producerqueue.h"
+#include "mltcontroller/mediainfocache.h"
 #include "bin/bin.h"
 #include "library/librarywidget.h"
 #include <QCoreApplication>
+#include <QStandardPaths>
+#include <QDir>
 #include <QDebug>
 
 #include <locale>
@@ -32,6 +35,8 @@ Core::Core(MainWindow *mainWindow) :
     , m_projectManager(NULL)
     , m_monitorManager(NULL)
     , m_binController(NULL)
+    , m_producerQueue(NULL)
+    , m_mediaInfoCache(NULL)
     , m_binWidget(NULL)
     , m_library(NULL)
 {
@@ -42,6 +47,7 @@ Core::~Core()
 {
     m_monitorManager->stopActiveMonitor();
     delete m_producerQueue;
+    delete m_mediaInfoCache;
     delete m_projectManager;
     delete m_binWidget;
     delete m_binController;
@@ -69,11 +75,16 @@ void Core::initialize()
     connect(m_binController, SIGNAL(abortAudioThumbs()), m_binWidget, SLOT(abortAudioThumbs()));
     connect(m_binController, SIGNAL(loadThumb(QString,QImage,bool)), m_binWidget, SLOT(slotThumbnailReady(QString,QImage,bool)));
     m_monitorManager = new MonitorManager(this);
+    // Media info shared by all projects, so that unchanged files are not probed again
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    cacheDir.mkpath(QStringLiteral("."));
+    m_mediaInfoCache = new MediaInfoCache(cacheDir.absoluteFilePath(QStringLiteral("mediainfo.index")));
     // Producer queue, creating MLT::Producers on request
     m_producerQueue = new ProducerQueue(m_binController);
     connect(m_producerQueue, SIGNAL(gotFileProperties(requestClipInfo,ClipController *)), m_binWidget, SLOT(slotProducerReady(requestClipInfo,ClipController *)), Qt::DirectConnection);
     connect(m_producerQueue, SIGNAL(replyGetImage(QString,QImage,bool)), m_binWidget, SLOT(slotThumbnailReady(QString,QImage,bool)));
-    connect(m_producerQueue, SIGNAL(removeInvalidClip(QString,bool,QString)), m_binWidget, SLOT(slotRemoveInvalidClip(QString,bool,QString)), Qt::DirectConnection);
+    // Emitted by the clip info workers, the bin must only be touched from the GUI thread
+    connect(m_producerQueue, SIGNAL(removeInvalidClip(QString,bool,QString)), m_binWidget, SLOT(slotRemoveInvalidClip(QString,bool,QString)), Qt::QueuedConnection);
     connect(m_producerQueue, SIGNAL(addClip(const QString&,const QMap<QString,QString>&)), m_binWidget, SLOT(slotAddUrl(const QString&,const QMap<QString,QString>&)));
     connect(m_binController, SIGNAL(createThumb(QDomElement,QString,int)), m_producerQueue, SLOT(getFileProperties(QDomElement,QString,int)));
     connect(m_binWidget, SIGNAL(producerReady(QString)), m_producerQueue, SLOT(slotProcessingDone(QString)), Qt::DirectConnection);
@@ -120,6 +131,11 @@ ProducerQueue *Core::producerQueue()
     return m_producerQueue;
 }
 
+MediaInfoCache *Core::mediaInfoCache()
+{
+    return m_mediaInfoCache;
+}
+
 LibraryWidget *Core::library()
 {
     return m_library;
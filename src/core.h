@@ -21,6 +21,7 @@ class BinController;
 class Bin;
 class LibraryWidget;
 class ProducerQueue;
+class MediaInfoCache;
 
 #define pCore Core::self()
 
@@ -65,6 +66,8 @@ public:
     Bin *bin();
     /** @brief Returns a pointer to the producer queue. */
     ProducerQueue *producerQueue();
+    /** @brief Returns a pointer to the persistent index of probed media files. */
+    MediaInfoCache *mediaInfoCache();
     /** @brief Returns a pointer to the library. */
     LibraryWidget *library();
 
@@ -80,6 +83,7 @@ private:
     MonitorManager *m_monitorManager;
     BinController *m_binController;
     ProducerQueue *m_producerQueue;
+    MediaInfoCache *m_mediaInfoCache;
     Bin *m_binWidget;
     LibraryWidget *m_library;
 
@@ -31,6 +31,7 @@
 #include "project/projectcommands.h"
 #include "bin/bincommands.h"
 #include "effectslist/initeffects.h"
+#include "effectslist/effectslist.h"
 #include "dialogs/profilesdialog.h"
 #include "titler/titlewidget.h"
 #include "project/notesplugin.h"
@@ -41,6 +42,7 @@
 #include "utils/KoIconUtils.h"
 #include "mltcontroller/bincontroller.h"
 #include "mltcontroller/effectscontroller.h"
+#include "timeline/compactelement.h"
 
 #include <KMessageBox>
 #include <KRecentDirs>
@@ -52,13 +54,17 @@
 
 #include <QCryptographicHash>
 #include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
 #include <QDebug>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QDomImplementation>
+#include <QElapsedTimer>
 #include <QUndoGroup>
 #include <QTimer>
 #include <QUndoStack>
+#include <QVector>
 #include <QTextEdit>
 
 #include <mlt++/Mlt.h>
@@ -82,7 +88,9 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QUrl &projectFolder, QUndoGroup
     m_notesWidget(notes->widget()),
     m_commandStack(new QUndoStack(undoGroup)),
     m_modified(false),
-    m_projectFolder(projectFolder)
+    m_projectFolder(projectFolder),
+    m_autoSaveChanges(0),
+    m_undoMemory(0)
 {
     // init m_profile struct
     m_profile.frame_rate_num = 0;
@@ -99,6 +107,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QUrl &projectFolder, QUndoGroup
     connect(m_clipManager, SIGNAL(displayMessage(QString,int)), parent, SLOT(slotGotProgressInfo(QString,int)));
     bool success = false;
     connect(m_commandStack, SIGNAL(indexChanged(int)), this, SLOT(slotModified()));
+    connect(m_commandStack, SIGNAL(indexChanged(int)), this, SLOT(slotCheckUndoBudget()));
     connect(m_render, SIGNAL(setDocumentNotes(QString)), this, SLOT(slotSetDocumentNotes(QString)));
     connect(pCore->producerQueue(), &ProducerQueue::switchProfile, this, &KdenliveDoc::switchProfile);
     //connect(m_commandStack, SIGNAL(cleanChanged(bool)), this, SLOT(setModified(bool)));
@@ -162,7 +171,10 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QUrl &projectFolder, QUndoGroup
             int line;
             int col;
             QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
+            QElapsedTimer timer;
+            timer.start();
             success = m_document.setContent(&file, false, &errorMsg, &line, &col);
+            qDebug() << "// Project file parsed in" << timer.elapsed() << "ms";
             file.close();
 
             if (!success) {
@@ -275,6 +287,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QUrl &projectFolder, QUndoGroup
     dir.mkdir(QStringLiteral("thumbs"));
     dir.mkdir(QStringLiteral("proxy"));
     dir.mkdir(QStringLiteral(".backup"));
+    m_clipManager->updateThumbnailFolder();
 
     updateProjectFolderPlacesEntry();
 }
@@ -291,6 +304,7 @@ KdenliveDoc::~KdenliveDoc()
     //qDebug() << "// DEL CLP MAN";
     delete m_clipManager;
     //qDebug() << "// DEL CLP MAN done";
+    m_autoSaveFuture.waitForFinished();
     if (m_autosave) {
         if (!m_autosave->fileName().isEmpty()) m_autosave->remove();
         delete m_autosave;
@@ -302,7 +316,8 @@ int KdenliveDoc::setSceneList()
     //m_render->resetProfile(m_profile);
     pCore->bin()->isLoading = true;
     pCore->producerQueue()->abortOperations();
-    if (m_render->setSceneList(m_document.toString(), m_documentProperties.value(QStringLiteral("position")).toInt()) == -1) {
+    // Pass the document itself, it is only serialized once for MLT
+    if (m_render->setSceneList(m_document, m_documentProperties.value(QStringLiteral("position")).toInt()) == -1) {
         // INVALID MLT Consumer, something is wrong
         return -1;
     }
@@ -537,16 +552,51 @@ void KdenliveDoc::slotAutoSave()
             qDebug() << "ERROR; CANNOT CREATE AUTOSAVE FILE";
         }
         //qDebug() << "// AUTOSAVE FILE: " << m_autosave->fileName();
-        QDomDocument sceneList = xmlSceneList(m_render->sceneList());
-        if (sceneList.isNull()) {
-            //Make sure we don't save if scenelist is corrupted
-            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
-            return;
-        }
-        m_autosave->resize(0); 
-        m_autosave->write(sceneList.toString().toUtf8());
-        m_autosave->flush();
+        // Don't start writing before the previous autosave is finished
+        m_autoSaveFuture.waitForFinished();
+        // Changes made while the file is written are counted for the next autosave
+        const int changes = m_autoSaveChanges.load();
+        // Only the MLT serialization needs to be done here, parsing and writing the xml is done in a thread
+        const QString scene = m_render->sceneList();
+        EffectsList customEffects;
+        customEffects.clone(MainWindow::customEffects);
+        m_autoSaveFuture = QtConcurrent::run(this, &KdenliveDoc::runAutoSave, m_autosave->fileName(), scene, pCore->binController()->binPlaylistId(), customEffects, changes);
+    }
+}
+
+void KdenliveDoc::runAutoSave(const QString &path, const QString &scene, const QString &binPlaylistId, const EffectsList &customEffects, int changes)
+{
+    if (writeAutoSave(path, scene, binPlaylistId, customEffects)) {
+        m_autoSaveChanges.fetchAndAddOrdered(-changes);
+    }
+}
+
+bool KdenliveDoc::autoSaveNeeded() const
+{
+    return m_autoSaveChanges.load() != 0;
+}
+
+//static
+bool KdenliveDoc::writeAutoSave(const QString &path, const QString &scene, const QString &binPlaylistId, const EffectsList &customEffects)
+{
+    QDomDocument sceneList = xmlSceneList(scene, binPlaylistId, customEffects);
+    if (sceneList.isNull()) {
+        //Make sure we don't save if scenelist is corrupted
+        qWarning() << "//////  Scene list is corrupted, cannot write autosave file: " << path;
+        return false;
+    }
+    // Write to a temporary file renamed over the previous autosave, so that a crash while writing does not lose it
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "//////  ERROR writing to file: " << path;
+        return false;
     }
+    file.write(sceneList.toString().toUtf8());
+    if (!file.commit()) {
+        qWarning() << "//////  ERROR writing to file: " << path;
+        return false;
+    }
+    return true;
 }
 
 void KdenliveDoc::setZoom(int horizontal, int vertical)
@@ -572,6 +622,12 @@ QPoint KdenliveDoc::zone() const
 }
 
 QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
+{
+    return xmlSceneList(scene, pCore->binController()->binPlaylistId(), MainWindow::customEffects);
+}
+
+//static
+QDomDocument KdenliveDoc::xmlSceneList(const QString &scene, const QString &binPlaylistId, const EffectsList &customEffects)
 {
     QDomDocument sceneList;
     sceneList.setContent(scene, true);
@@ -595,7 +651,7 @@ QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
     QDomNodeList pls = mlt.elementsByTagName(QStringLiteral("playlist"));
     QDomElement mainPlaylist;
     for (int i = 0; i < pls.count(); ++i) {
-        if (pls.at(i).toElement().attribute(QStringLiteral("id")) == pCore->binController()->binPlaylistId()) {
+        if (pls.at(i).toElement().attribute(QStringLiteral("id")) == binPlaylistId) {
             mainPlaylist = pls.at(i).toElement();
             break;
         }
@@ -623,19 +679,9 @@ QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
         }
     }
     //TODO: find a way to process this before rendering MLT scenelist to xml
-    QDomDocument customeffects = initEffects::getUsedCustomEffects(effectIds);
+    QDomDocument customeffects = initEffects::getUsedCustomEffects(effectIds, customEffects);
     mainPlaylist.setAttribute(QStringLiteral("kdenlive:customeffects"), customeffects.toString());
     //addedXml.appendChild(sceneList.importNode(customeffects.documentElement(), true));
-
-    //TODO: move metadata to previous step in saving process
-    QDomElement docmetadata = sceneList.createElement(QStringLiteral("documentmetadata"));
-    QMapIterator<QString, QString> j(m_documentMetadata);
-    while (j.hasNext()) {
-        j.next();
-        docmetadata.setAttribute(j.key(), j.value());
-    }
-    //addedXml.appendChild(docmetadata);
-
     return sceneList;
 }
 
@@ -713,6 +759,7 @@ void KdenliveDoc::setProjectFolder(QUrl url)
     dir.mkdir(QStringLiteral(".backup"));
     if (KMessageBox::questionYesNo(QApplication::activeWindow(), i18n("You have changed the project folder. Do you want to copy the cached data from %1 to the new folder %2?", m_projectFolder.path(), url.path())) == KMessageBox::Yes) moveProjectData(url);
     m_projectFolder = url;
+    m_clipManager->updateThumbnailFolder();
 
     updateProjectFolderPlacesEntry();
 }
@@ -735,9 +782,11 @@ void KdenliveDoc::moveProjectData(const QUrl &url)
         if (QFile::exists(oldVideoThumbUrl.path())) {
             cacheUrls << oldVideoThumbUrl;
         }
-        QUrl oldAudioThumbUrl = QUrl::fromLocalFile(m_projectFolder.path() + QDir::separator() + "thumbs/" + hash + ".thumb");
-        if (QFile::exists(oldAudioThumbUrl.path())) {
-            cacheUrls << oldAudioThumbUrl;
+        // Audio thumbnails are stored as peak files, one per audio stream
+        QDir thumbDir(m_projectFolder.path() + QDir::separator() + "thumbs/");
+        QStringList peakFiles = thumbDir.entryList(QStringList() << hash + "_*.peaks", QDir::Files);
+        foreach (const QString &peakFile, peakFiles) {
+            cacheUrls << QUrl::fromLocalFile(thumbDir.absoluteFilePath(peakFile));
         }
         QUrl oldVideoProxyUrl = QUrl::fromLocalFile(m_projectFolder.path() + QDir::separator() + "proxy/" + hash + '.' + KdenliveSettings::proxyextension());
         if (QFile::exists(oldVideoProxyUrl.path())) {
@@ -844,11 +893,60 @@ void KdenliveDoc::setUrl(const QUrl &url)
 
 void KdenliveDoc::slotModified()
 {
+    // Undo and redo change the document even when they go back to the saved state
+    m_autoSaveChanges.fetchAndAddOrdered(1);
     setModified(m_commandStack->isClean() == false);
 }
 
+//static
+int KdenliveDoc::commandCost(const QUndoCommand *command, bool compact)
+{
+    int cost = 0;
+    CompactableCommand *compactable = dynamic_cast <CompactableCommand *>(const_cast <QUndoCommand *>(command));
+    if (compactable) {
+        if (compact) compactable->compact();
+        cost += compactable->memoryCost();
+    }
+    for (int i = 0; i < command->childCount(); ++i) {
+        cost += commandCost(command->child(i), compact);
+    }
+    return cost;
+}
+
+void KdenliveDoc::slotCheckUndoBudget()
+{
+    const qint64 budget = (qint64) qMax(KdenliveSettings::undobudget(), 1) * 1024 * 1024;
+    const int count = m_commandStack->count();
+    QVector <int> costs(count);
+    qint64 total = 0;
+    for (int i = 0; i < count; ++i) {
+        costs[i] = commandCost(m_commandStack->command(i), false);
+        total += costs[i];
+    }
+    // Compress the oldest commands first, recent ones are the most likely to be undone
+    for (int i = 0; i < count && total > budget; ++i) {
+        total += commandCost(m_commandStack->command(i), true) - costs.at(i);
+    }
+    if (total > budget) {
+        // QUndoStack only accepts an undo limit while empty, commands cannot be dropped here
+        qDebug() << "Undo history uses" << total / 1024 / 1024 << "MB, over its budget even compressed";
+    }
+    if (total != m_undoMemory) {
+        m_undoMemory = total;
+        emit undoMemoryChanged(m_undoMemory);
+    }
+}
+
+qint64 KdenliveDoc::undoMemory() const
+{
+    return m_undoMemory;
+}
+
 void KdenliveDoc::setModified(bool mod)
 {
+    if (mod) {
+        m_autoSaveChanges.fetchAndAddOrdered(1);
+    }
     // fix mantis#3160: The document may have an empty URL if not saved yet, but should have a m_autosave in any case
     if (m_autosave && mod && KdenliveSettings::crashrecovery()) {
         emit startAutoSave();
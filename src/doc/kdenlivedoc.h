@@ -32,6 +32,8 @@
 #include <QObject>
 #include <QTimer>
 #include <QUrl>
+#include <QFuture>
+#include <QAtomicInt>
 
 #include <kautosavefile.h>
 #include <KDirWatch>
@@ -47,6 +49,7 @@ class ClipManager;
 class MainWindow;
 class TrackInfo;
 class NotesPlugin;
+class EffectsList;
 class ProjectClip;
 class ClipController;
 
@@ -54,6 +57,7 @@ class QTextEdit;
 class QUndoGroup;
 class QTimer;
 class QUndoStack;
+class QUndoCommand;
 
 namespace Mlt {
     class Profile;
@@ -120,6 +124,8 @@ public:
     double projectDuration() const;
     /** @brief Returns the project file xml. */
     QDomDocument xmlSceneList(const QString &scene);
+    /** @brief Returns false if the document was not changed since last successful autosave. */
+    bool autoSaveNeeded() const;
     /** @brief Saves the project file xml to a file. */
     bool saveSceneList(const QString &path, const QString &scene);
     void cacheImage(const QString &fileId, const QImage &img) const;
@@ -158,6 +164,8 @@ public:
     /** @brief Force processing of clip id in producer queue. */
     void forceProcessing(const QString &id);
     void getFileProperties(const QDomElement &xml, const QString &clipId, int imageHeight, bool replaceProducer = true);
+    /** @brief Approximate memory used by the undo history, in bytes. */
+    qint64 undoMemory() const;
 
 private:
     QUrl m_url;
@@ -184,10 +192,25 @@ private:
     QUrl m_projectFolder;
     QMap <QString, QString> m_documentProperties;
     QMap <QString, QString> m_documentMetadata;
+    /** @brief The autosave being written in a thread. */
+    QFuture<void> m_autoSaveFuture;
+    /** @brief Number of changes since last successful autosave, to skip unchanged documents. */
+    QAtomicInt m_autoSaveChanges;
+    /** @brief Memory used by the undo history at last check. */
+    qint64 m_undoMemory;
+
+    /** @brief Builds the project file xml from the MLT scene list, can be called from any thread. */
+    static QDomDocument xmlSceneList(const QString &scene, const QString &binPlaylistId, const EffectsList &customEffects);
+    /** @brief Builds the project file xml and atomically replaces the autosave file, run in a thread. */
+    static bool writeAutoSave(const QString &path, const QString &scene, const QString &binPlaylistId, const EffectsList &customEffects);
+    /** @brief Writes the autosave in a thread, then forgets the @param changes it contains if it succeeded. */
+    void runAutoSave(const QString &path, const QString &scene, const QString &binPlaylistId, const EffectsList &customEffects, int changes);
 
     void setNewClipResource(const QString &id, const QString &path);
     QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
     void moveProjectData(const QUrl &url);
+    /** @brief Returns the memory used by a command and its children, compressing their data first if @param compact is true. */
+    static int commandCost(const QUndoCommand *command, bool compact);
 
     /** @brief Creates a new project. */
     QDomDocument createEmptyDocument(int videotracks, int audiotracks);
@@ -223,6 +246,10 @@ private slots:
     void slotSetDocumentNotes(const QString &notes);
     void switchProfile(MltVideoProfile profile, const QString &id, const QDomElement &xml);
     void slotSwitchProfile();
+    /** @brief Updates the undo history memory use, compressing the oldest commands when over the budget.
+     *  The budget is best-effort: QUndoStack cannot drop commands once pushed, so the history can stay
+     *  over it when compression is not enough. */
+    void slotCheckUndoBudget();
 
 signals:
     void resetProjectList();
@@ -242,6 +269,8 @@ signals:
     void reloadEffects();
     /** @brief Fps was changed, update timeline */
     void updateFps(bool changed);
+    /** @brief The memory used by the undo history changed, in bytes. */
+    void undoMemoryChanged(qint64 bytes);
 };
 
 #endif
@@ -23,6 +23,7 @@
 #include "kthumb.h"
 
 #include "project/clipmanager.h"
+#include "doc/thumbnailcache.h"
 #include "renderer.h"
 #include "kdenlivesettings.h"
 
@@ -48,7 +49,8 @@ KThumb::KThumb(ClipManager *clipManager, const QUrl &url, const QString &id, con
     m_ratio(1),
     m_producer(NULL),
     m_clipManager(clipManager),
-    m_id(id)
+    m_id(id),
+    m_hash(hash)
 {
     m_thumbFile = clipManager->projectFolder() + "/thumbs/" + hash + ".thumb";
 }
@@ -90,6 +92,7 @@ bool KThumb::hasProducer() const
 void KThumb::updateClipUrl(const QUrl &url, const QString &hash)
 {
     m_url = url;
+    m_hash = hash;
     m_thumbFile = m_clipManager->projectFolder() + "/thumbs/" + hash + ".thumb";
 }
 
@@ -194,65 +197,6 @@ QImage KThumb::getProducerFrame(int framepos, int displayWidth, int height)
     return p;
 }
 
-//static
-QImage KThumb::getFrame(Mlt::Producer *producer, int framepos, int displayWidth, int height)
-{
-    if (producer == NULL || !producer->is_valid()) {
-        QImage p(displayWidth, height, QImage::Format_ARGB32_Premultiplied);
-        p.fill(QColor(Qt::red).rgb());
-        return p;
-    }
-    if (producer->is_blank()) {
-        QImage p(displayWidth, height, QImage::Format_ARGB32_Premultiplied);
-        p.fill(QColor(Qt::black).rgb());
-        return p;
-    }
-
-    producer->seek(framepos);
-    Mlt::Frame *frame = producer->get_frame();
-    const QImage p = getFrame(frame, displayWidth, height);
-    delete frame;
-    return p;
-}
-
-
-//static
-QImage KThumb::getFrame(Mlt::Frame *frame, int width, int height)
-{
-    QImage p(width, height, QImage::Format_ARGB32_Premultiplied);
-    if (frame == NULL || !frame->is_valid()) {
-        p.fill(QColor(Qt::red).rgb());
-        return p;
-    }
-    int ow = width;
-    int oh = height;
-    mlt_image_format format = mlt_image_rgb24a;
-    //frame->set("progressive", "1");
-    if (ow % 2 == 1) ow++;
-    const uchar* imagedata = frame->get_image(format, ow, oh);
-    if (imagedata == NULL) {
-        p.fill(QColor(Qt::red).rgb());
-        return p;
-    }
-    QImage image(ow, oh, QImage::Format_ARGB32_Premultiplied);
-    memcpy(image.bits(), imagedata, ow * oh * 4);
-
-    if (!image.isNull()) {
-        if (ow > (2 * width)) {
-            // there was a scaling problem, do it manually
-            image = image.scaled(width, height).rgbSwapped();
-        } else {
-            image = image.scaled(width, height, Qt::IgnoreAspectRatio).rgbSwapped();
-        }
-	p.fill(QColor(100, 100, 100, 70));
-        QPainter painter(&p);
-        painter.drawImage(p.rect(), image);
-        painter.end();
-    } else
-        p.fill(QColor(Qt::red).rgb());
-    return p;
-}
-
 //static
 uint KThumb::imageVariance(const QImage &image )
 {
@@ -383,7 +327,7 @@ void KThumb::slotGetIntraThumbs()
 {
     const int theight = KdenliveSettings::trackheight();
     const int displayWidth = (int)(theight * m_dar + 0.5);
-    QString path = m_url.path() + '_';
+    ThumbnailCache *cache = m_clipManager->thumbnailCache();
     bool addedThumbs = false;
     while (true) {
         m_intraMutex.lock();
@@ -393,10 +337,11 @@ void KThumb::slotGetIntraThumbs()
         }
         int pos = m_intraFramesQueue.takeFirst();
         m_intraMutex.unlock();
-        const QString key = path + QString::number(pos);
-        if (!m_clipManager->pixmapCache->contains(key)) {
+        // Thumbnails stored by a previous session don't need to be decoded again
+        if (!cache->contains(m_hash, pos, theight)) {
             QImage img = getProducerFrame(pos, displayWidth, theight);
-            if (m_clipManager->pixmapCache->insertImage(key, img)) {
+            if (!img.isNull()) {
+                cache->insert(m_hash, pos, theight, img);
                 addedThumbs = true;
             }
             else qDebug()<<"// INSERT FAILD FOR: "<<pos;
@@ -408,10 +353,7 @@ void KThumb::slotGetIntraThumbs()
 
 QImage KThumb::findCachedThumb(int pos)
 {
-    QImage img;
-    const QString path = m_url.path() + '_' + QString::number(pos);
-    m_clipManager->pixmapCache->findImage(path, &img);
-    return img;
+    return m_clipManager->thumbnailCache()->find(m_hash, pos, KdenliveSettings::trackheight());
 }
 
 
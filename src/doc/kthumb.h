@@ -91,6 +91,8 @@ private:
     Mlt::Producer *m_producer;
     ClipManager *m_clipManager;
     QString m_id;
+    /** @brief Hash of the clip, used as key in the thumbnail cache. */
+    QString m_hash;
     /** @brief Controls the intra frames thumbnails process (cached thumbnails). */
     QFuture<void> m_intra;
     /** @brief List of frame numbers from which we want to extract thumbnails. */
@@ -0,0 +1,93 @@
+/***************************************************************************
+                        krender.cpp  -  description
+                           -------------------
+  begin                : Fri Nov 22 2002
+  copyright            : (C) 2002 by Jason Wood
+  email                : jasonwood@blueyonder.co.uk
+  copyright            : (C) 2005 Lcio Fl�io Corr�
+  email                : lucio.correa@gmail.com
+  copyright            : (C) Marco Gittler
+  email                : g.marco@freenet.de
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+// Frame conversions of KThumb, kept apart from the thumbnail jobs so that
+// they only depend on MLT and Qt and can be built in the benchmarks.
+
+#include "kthumb.h"
+
+#include <mlt++/Mlt.h>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+
+#include <string.h>
+
+//static
+QImage KThumb::getFrame(Mlt::Producer *producer, int framepos, int displayWidth, int height)
+{
+    if (producer == NULL || !producer->is_valid()) {
+        QImage p(displayWidth, height, QImage::Format_ARGB32_Premultiplied);
+        p.fill(QColor(Qt::red).rgb());
+        return p;
+    }
+    if (producer->is_blank()) {
+        QImage p(displayWidth, height, QImage::Format_ARGB32_Premultiplied);
+        p.fill(QColor(Qt::black).rgb());
+        return p;
+    }
+
+    producer->seek(framepos);
+    Mlt::Frame *frame = producer->get_frame();
+    const QImage p = getFrame(frame, displayWidth, height);
+    delete frame;
+    return p;
+}
+
+
+//static
+QImage KThumb::getFrame(Mlt::Frame *frame, int width, int height)
+{
+    QImage p(width, height, QImage::Format_ARGB32_Premultiplied);
+    if (frame == NULL || !frame->is_valid()) {
+        p.fill(QColor(Qt::red).rgb());
+        return p;
+    }
+    int ow = width;
+    int oh = height;
+    mlt_image_format format = mlt_image_rgb24a;
+    //frame->set("progressive", "1");
+    if (ow % 2 == 1) ow++;
+    const uchar* imagedata = frame->get_image(format, ow, oh);
+    if (imagedata == NULL) {
+        p.fill(QColor(Qt::red).rgb());
+        return p;
+    }
+    QImage image(ow, oh, QImage::Format_ARGB32_Premultiplied);
+    memcpy(image.bits(), imagedata, ow * oh * 4);
+
+    if (!image.isNull()) {
+        if (ow > (2 * width)) {
+            // there was a scaling problem, do it manually
+            image = image.scaled(width, height).rgbSwapped();
+        } else {
+            image = image.scaled(width, height, Qt::IgnoreAspectRatio).rgbSwapped();
+        }
+	p.fill(QColor(100, 100, 100, 70));
+        QPainter painter(&p);
+        painter.drawImage(p.rect(), image);
+        painter.end();
+    } else
+        p.fill(QColor(Qt::red).rgb());
+    return p;
+}
@@ -0,0 +1,264 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "thumbnailcache.h"
+#include "kdenlivesettings.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QDebug>
+
+#include <algorithm>
+
+static const char indexFileName[] = "index";
+
+static bool isOpaque(const QImage &img)
+{
+    if (!img.hasAlphaChannel()) return true;
+    for (int y = 0; y < img.height(); ++y) {
+        const QRgb *line = (const QRgb *) img.constScanLine(y);
+        for (int x = 0; x < img.width(); ++x) {
+            if (qAlpha(line[x]) != 255) return false;
+        }
+    }
+    return true;
+}
+
+ThumbnailCache::ThumbnailCache() :
+    m_loaded(false),
+    m_totalSize(0),
+    m_counter(0),
+    m_images(20000)
+{
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    QMutexLocker lock(&m_mutex);
+    saveIndex();
+}
+
+QString ThumbnailCache::key(const QString &hash, int frame, int height)
+{
+    return hash + '_' + QString::number(frame) + '_' + QString::number(height);
+}
+
+void ThumbnailCache::setFolder(const QString &folder)
+{
+    QMutexLocker lock(&m_mutex);
+    if (folder == m_folder) return;
+    saveIndex();
+    m_folder = folder;
+    m_entries.clear();
+    m_images.clear();
+    m_totalSize = 0;
+    m_loaded = false;
+}
+
+void ThumbnailCache::loadIndex()
+{
+    if (m_loaded || m_folder.isEmpty()) return;
+    m_loaded = true;
+    QDir dir(m_folder);
+    if (!dir.exists() && !dir.mkpath(QStringLiteral("."))) {
+        qDebug() << "// Cannot create thumbnail cache folder: " << m_folder;
+        return;
+    }
+    // Oldest files first
+    QFileInfoList files = dir.entryInfoList(QStringList() << QStringLiteral("*.jpg") << QStringLiteral("*.png"), QDir::Files, QDir::Time | QDir::Reversed);
+    foreach (const QFileInfo &info, files) {
+        Entry entry;
+        entry.fileName = info.fileName();
+        entry.size = info.size();
+        entry.lastUse = 0;
+        m_entries.insert(info.completeBaseName(), entry);
+        m_totalSize += entry.size;
+    }
+    // Restore the usage order of the last session
+    QFile index(dir.absoluteFilePath(indexFileName));
+    if (index.open(QIODevice::ReadOnly)) {
+        QTextStream stream(&index);
+        while (!stream.atEnd()) {
+            QHash <QString, Entry>::iterator it = m_entries.find(stream.readLine());
+            if (it != m_entries.end() && it->lastUse == 0) {
+                it->lastUse = ++m_counter;
+            }
+        }
+    }
+    // Files written after the index was saved are the most recent ones
+    foreach (const QFileInfo &info, files) {
+        Entry &entry = m_entries[info.completeBaseName()];
+        if (entry.lastUse == 0) entry.lastUse = ++m_counter;
+    }
+    evict();
+}
+
+void ThumbnailCache::saveIndex()
+{
+    if (!m_loaded || m_folder.isEmpty()) return;
+    QList <QPair <quint64, QString> > order;
+    QHash <QString, Entry>::const_iterator it = m_entries.constBegin();
+    for (; it != m_entries.constEnd(); ++it) {
+        order << qMakePair(it->lastUse, it.key());
+    }
+    std::sort(order.begin(), order.end());
+    QSaveFile index(QDir(m_folder).absoluteFilePath(indexFileName));
+    if (!index.open(QIODevice::WriteOnly)) return;
+    QTextStream stream(&index);
+    for (int i = 0; i < order.count(); ++i) {
+        stream << order.at(i).second << '\n';
+    }
+    stream.flush();
+    index.commit();
+}
+
+QImage ThumbnailCache::cachedImage(const QString &hash, int frame, int height)
+{
+    const QString k = key(hash, frame, height);
+    QMutexLocker lock(&m_mutex);
+    QImage *cached = m_images.object(k);
+    if (!cached) return QImage();
+    QHash <QString, Entry>::iterator it = m_entries.find(k);
+    if (it != m_entries.end()) it->lastUse = ++m_counter;
+    return *cached;
+}
+
+bool ThumbnailCache::contains(const QString &hash, int frame, int height)
+{
+    QMutexLocker lock(&m_mutex);
+    loadIndex();
+    return m_entries.contains(key(hash, frame, height));
+}
+
+QImage ThumbnailCache::find(const QString &hash, int frame, int height)
+{
+    const QString k = key(hash, frame, height);
+    QString path;
+    m_mutex.lock();
+    loadIndex();
+    QHash <QString, Entry>::iterator it = m_entries.find(k);
+    if (it == m_entries.end()) {
+        m_mutex.unlock();
+        return QImage();
+    }
+    it->lastUse = ++m_counter;
+    QImage *cached = m_images.object(k);
+    if (cached) {
+        QImage img = *cached;
+        m_mutex.unlock();
+        return img;
+    }
+    path = QDir(m_folder).absoluteFilePath(it->fileName);
+    m_mutex.unlock();
+
+    // Decode outside of the lock, other threads may use the cache meanwhile
+    QImage img(path);
+    QMutexLocker lock(&m_mutex);
+    if (img.isNull()) {
+        // File was deleted or is corrupted
+        it = m_entries.find(k);
+        if (it != m_entries.end()) {
+            m_totalSize -= it->size;
+            m_entries.erase(it);
+            QFile::remove(path);
+        }
+        return img;
+    }
+    img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    m_images.insert(k, new QImage(img), qMax(1, img.byteCount() / 1024));
+    return img;
+}
+
+void ThumbnailCache::insert(const QString &hash, int frame, int height, const QImage &img)
+{
+    if (img.isNull()) return;
+    const QString k = key(hash, frame, height);
+    m_mutex.lock();
+    loadIndex();
+    if (m_folder.isEmpty()) {
+        m_mutex.unlock();
+        return;
+    }
+    m_images.insert(k, new QImage(img), qMax(1, img.byteCount() / 1024));
+    const QString folder = m_folder;
+    m_mutex.unlock();
+
+    // Opaque frames are much smaller as jpeg, keep transparency of titles and images
+    bool opaque = isOpaque(img);
+    const QString fileName = k + (opaque ? ".jpg" : ".png");
+    QSaveFile file(QDir(folder).absoluteFilePath(fileName));
+    if (!file.open(QIODevice::WriteOnly) || !img.save(&file, opaque ? "JPG" : "PNG", opaque ? 90 : -1) || !file.commit()) {
+        qDebug() << "// Cannot write thumbnail: " << file.fileName();
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    if (folder != m_folder) return;
+    Entry entry;
+    entry.fileName = fileName;
+    entry.size = QFileInfo(QDir(folder).absoluteFilePath(fileName)).size();
+    entry.lastUse = ++m_counter;
+    QHash <QString, Entry>::iterator it = m_entries.find(k);
+    if (it != m_entries.end()) {
+        m_totalSize -= it->size;
+        if (it->fileName != fileName) QFile::remove(QDir(folder).absoluteFilePath(it->fileName));
+    }
+    m_entries.insert(k, entry);
+    m_totalSize += entry.size;
+    evict();
+}
+
+void ThumbnailCache::remove(const QString &hash)
+{
+    QMutexLocker lock(&m_mutex);
+    loadIndex();
+    const QString prefix = hash + '_';
+    QDir dir(m_folder);
+    QHash <QString, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end()) {
+        if (it.key().startsWith(prefix)) {
+            m_images.remove(it.key());
+            m_totalSize -= it->size;
+            dir.remove(it->fileName);
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ThumbnailCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_images.clear();
+}
+
+void ThumbnailCache::evict()
+{
+    const qint64 budget = (qint64) qMax(KdenliveSettings::thumbcachesize(), 1) * 1024 * 1024;
+    if (m_totalSize <= budget) return;
+    QList <QPair <quint64, QString> > order;
+    QHash <QString, Entry>::const_iterator it = m_entries.constBegin();
+    for (; it != m_entries.constEnd(); ++it) {
+        order << qMakePair(it->lastUse, it.key());
+    }
+    std::sort(order.begin(), order.end());
+    // Free some more space so that we don't evict on each insert
+    const qint64 target = budget * 9 / 10;
+    QDir dir(m_folder);
+    for (int i = 0; i < order.count() && m_totalSize > target; ++i) {
+        const QString &k = order.at(i).second;
+        Entry entry = m_entries.take(k);
+        m_images.remove(k);
+        dir.remove(entry.fileName);
+        m_totalSize -= entry.size;
+    }
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+/**
+  Persistent store for video thumbnails.
+
+  Thumbnails are saved in a folder of the project cache, one file per
+  clip hash, frame and height, so they survive a restart and are shared
+  by the timeline and the bin. The most recently used images are also
+  kept in memory. When the files go over the size budget set in the
+  settings (thumbcachesize), the least recently used ones are deleted.
+  The usage order is saved in the folder to be restored next session.
+
+  All methods are thread safe.
+  */
+class ThumbnailCache
+{
+public:
+    ThumbnailCache();
+    ~ThumbnailCache();
+
+    /** @brief Sets the folder where thumbnails are stored, saving the state of the previous one. */
+    void setFolder(const QString &folder);
+    /** @brief Returns the thumbnail of @param frame for clip @param hash, or a null image. */
+    QImage find(const QString &hash, int frame, int height);
+    /** @brief Returns the thumbnail only if it is kept in memory, safe to call while painting. */
+    QImage cachedImage(const QString &hash, int frame, int height);
+    bool contains(const QString &hash, int frame, int height);
+    /** @brief Stores a thumbnail, evicting old ones if the budget is exceeded. */
+    void insert(const QString &hash, int frame, int height, const QImage &img);
+    /** @brief Removes all thumbnails of a clip, for example when its file changed. */
+    void remove(const QString &hash);
+    /** @brief Drops the images kept in memory, files are kept. */
+    void clear();
+
+private:
+    struct Entry
+    {
+        QString fileName;
+        qint64 size;
+        quint64 lastUse;
+    };
+    QMutex m_mutex;
+    QString m_folder;
+    /** @brief Files stored in m_folder, by key. */
+    QHash <QString, Entry> m_entries;
+    bool m_loaded;
+    qint64 m_totalSize;
+    /** @brief Incremented on each access, gives the usage order. */
+    quint64 m_counter;
+    /** @brief Recently used images, cost is in kB. */
+    QCache <QString, QImage> m_images;
+
+    static QString key(const QString &hash, int frame, int height);
+    /** @brief Scans the folder on first access. */
+    void loadIndex();
+    /** @brief Writes the usage order of the stored files. */
+    void saveIndex();
+    /** @brief Deletes least recently used files until the budget is met. */
+    void evict();
+};
+
+#endif
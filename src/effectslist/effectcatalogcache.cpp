@@ -0,0 +1,193 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "effectcatalogcache.h"
+#include "effectslist.h"
+#include "kdenlivesettings.h"
+#include "mainwindow.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+#include <KLocalizedString>
+#include <mlt++/Mlt.h>
+#include <config-kdenlive.h>
+
+// Bump the version whenever the content of the cache changes
+static const quint32 cacheMagic = 0x4b454643; // "KEFC"
+static const quint32 cacheVersion = 1;
+
+// Fingerprint of the folders the catalogue in use was loaded or saved with, empty if unknown
+static QByteArray s_loadedFingerprint;
+// True if the catalogue in use was loaded from the cache
+static bool s_fromCache = false;
+
+/** Global lists stored in the cache, in file order. */
+static EffectsList *catalogLists[] = { &MainWindow::transitions, &MainWindow::customEffects,
+                                       &MainWindow::audioEffects, &MainWindow::videoEffects };
+
+//static
+QString EffectCatalogCache::cacheFile()
+{
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    // One file per locale, opening a document in another locale must not overwrite the default catalogue
+    const QByteArray key = QCryptographicHash::hash(versionKey().toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    return cacheDir.absoluteFilePath(QStringLiteral("effectcatalog-") + QString::fromLatin1(key) + QStringLiteral(".cache"));
+}
+
+//static
+QString EffectCatalogCache::versionKey()
+{
+    QStringList key;
+    key << QString::fromLatin1(mlt_version_get_string()) << QStringLiteral(KDENLIVE_VERSION);
+    // Descriptions are translated and numbers are converted to the decimal point in use
+    key << QLocale().name() << QLocale().decimalPoint() << KLocalizedString::languages().join(QLatin1Char(':'));
+    return key.join(QLatin1Char('|'));
+}
+
+//static
+QByteArray EffectCatalogCache::folderFingerprint()
+{
+    QStringList folders;
+    folders << QStandardPaths::locateAll(QStandardPaths::DataLocation, QStringLiteral("effects"), QStandardPaths::LocateDirectory);
+    folders << QStandardPaths::locateAll(QStandardPaths::DataLocation, QStringLiteral("transitions"), QStandardPaths::LocateDirectory);
+    folders << QStandardPaths::locateAll(QStandardPaths::DataLocation, QStringLiteral("lumas"), QStandardPaths::LocateDirectory);
+    folders << QString(mlt_environment("MLT_DATA")) + QDir::separator() + "lumas" + QDir::separator() + QString(mlt_environment("MLT_NORMALISATION"));
+    // MLT modules, services are added or removed with them
+    folders << QString(mlt_environment("MLT_REPOSITORY"));
+    QStringList files;
+    files << QStandardPaths::locate(QStandardPaths::DataLocation, QStringLiteral("blacklisted_effects.txt"));
+    files << QStandardPaths::locate(QStandardPaths::DataLocation, QStringLiteral("blacklisted_transitions.txt"));
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QFileInfoList entries;
+    foreach(const QString &folder, folders) {
+        hash.addData(folder.toUtf8());
+        entries << QDir(folder).entryInfoList(QDir::Files, QDir::Name);
+    }
+    foreach(const QString &file, files) {
+        entries << QFileInfo(file);
+    }
+    foreach(const QFileInfo &info, entries) {
+        hash.addData(info.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    return hash.result();
+}
+
+//static
+bool EffectCatalogCache::load(bool *movit)
+{
+    // The fingerprint in use is kept on failure, the catalogue is then rebuilt and saved with a new one
+    s_fromCache = false;
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    QString key;
+    stream >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion) {
+        qDebug() << "// Ignoring effect catalogue cache from another version";
+        return false;
+    }
+    stream >> key;
+    if (key != versionKey()) {
+        qDebug() << "// Effect catalogue cache was built for another MLT version or locale";
+        return false;
+    }
+    QByteArray fingerprint;
+    QStringList producers;
+    bool gpu;
+    stream >> fingerprint >> producers >> gpu;
+    QList <QDomDocument> documents;
+    for (uint i = 0; i < sizeof(catalogLists) / sizeof(catalogLists[0]); ++i) {
+        QByteArray data;
+        stream >> data;
+        QDomDocument doc;
+        if (stream.status() != QDataStream::Ok || !doc.setContent(qUncompress(data))) {
+            qDebug() << "// Corrupted effect catalogue cache";
+            return false;
+        }
+        documents << doc;
+    }
+    for (int i = 0; i < documents.count(); ++i) {
+        catalogLists[i]->setList(documents.at(i).documentElement());
+    }
+    KdenliveSettings::setProducerslist(producers);
+    if (!gpu) KdenliveSettings::setGpu_accel(false);
+    *movit = gpu;
+    s_loadedFingerprint = fingerprint;
+    s_fromCache = true;
+    return true;
+}
+
+//static
+void EffectCatalogCache::save(bool movit)
+{
+    // The catalogue was just built from the folders, a pending check must not rebuild it again
+    s_loadedFingerprint = folderFingerprint();
+    QDir().mkpath(QFileInfo(cacheFile()).absolutePath());
+    QSaveFile file(cacheFile());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "// Cannot write effect catalogue cache: " << cacheFile();
+        return;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << versionKey() << s_loadedFingerprint << KdenliveSettings::producerslist() << movit;
+    for (uint i = 0; i < sizeof(catalogLists) / sizeof(catalogLists[0]); ++i) {
+        stream << qCompress(catalogLists[i]->toByteArray(-1));
+    }
+    file.commit();
+}
+
+//static
+void EffectCatalogCache::invalidate()
+{
+    s_loadedFingerprint.clear();
+    // Caches of the other locales were built from the same folders
+    QDir cacheDir(QFileInfo(cacheFile()).absolutePath());
+    foreach(const QString &fileName, cacheDir.entryList(QStringList() << QStringLiteral("effectcatalog*.cache"), QDir::Files)) {
+        QFile::remove(cacheDir.absoluteFilePath(fileName));
+    }
+}
+
+//static
+bool EffectCatalogCache::isLoaded()
+{
+    return s_fromCache;
+}
+
+//static
+bool EffectCatalogCache::matches(const QByteArray &fingerprint)
+{
+    return fingerprint == s_loadedFingerprint;
+}
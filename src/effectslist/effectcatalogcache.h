@@ -0,0 +1,71 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef EFFECTCATALOGCACHE_H
+#define EFFECTCATALOGCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @class EffectCatalogCache
+ * @brief Binary cache of the effect and transition catalogue built by initEffects.
+ *
+ * Building the catalogue queries MLT for every service, parses all effect and
+ * transition XML files and scans the luma folders. The result (the global
+ * effect and transition lists) is stored compressed in the cache folder.
+ *
+ * There is one cache file per MLT and Kdenlive versions and locale, so that
+ * opening a document in another locale does not replace the default one.
+ * Changes in the effect, transition, luma and MLT module folders are detected
+ * by comparing their fingerprint, which the main window computes in the
+ * background after startup.
+ */
+
+class EffectCatalogCache
+{
+public:
+    /** @brief Fills the global effect and transition lists from the cache.
+     *  @param movit set to the Movit availability stored with the catalogue
+     *  @return false if there is no usable cache for this MLT version and locale */
+    static bool load(bool *movit);
+    /** @brief Writes the global effect and transition lists to the cache of the current locale. */
+    static void save(bool movit);
+    /** @brief Deletes the cache files of all locales. */
+    static void invalidate();
+    /** @brief Returns true if the catalogue in use was loaded from the cache. */
+    static bool isLoaded();
+    /** @brief Returns true if @param fingerprint is the one of the catalogue in use, loaded or saved. */
+    static bool matches(const QByteArray &fingerprint);
+
+    /** @brief Hash of the files and modification times of the folders the catalogue is built from.
+     *  Only reads the file system, can be called from any thread. */
+    static QByteArray folderFingerprint();
+
+private:
+    EffectCatalogCache(); // disable the constructor
+    static QString cacheFile();
+    /** @brief Key of what the catalogue depends on besides the folders: versions and locale. */
+    static QString versionKey();
+};
+
+#endif
@@ -20,10 +20,14 @@
 #include "kdenlivesettings.h"
 
 #include <QDebug>
+#include <QLocale>
 #include <klocalizedstring.h>
 
 
-EffectsList::EffectsList(bool indexRequired) : m_useIndex(indexRequired)
+EffectsList::EffectsList(bool indexRequired, bool hashed) :
+    m_useIndex(indexRequired)
+    , m_hashed(hashed)
+    , m_indexed(false)
 {
     m_baseElement = createElement(QStringLiteral("list"));
     appendChild(m_baseElement);
@@ -33,8 +37,63 @@ EffectsList::~EffectsList()
 {
 }
 
+void EffectsList::buildIndex() const
+{
+    m_byId.clear();
+    m_byTag.clear();
+    m_byName.clear();
+    m_schemas.clear();
+    for (QDomElement effect = m_baseElement.firstChildElement(); !effect.isNull(); effect = effect.nextSiblingElement()) {
+        const QString id = effect.attribute(QStringLiteral("id"));
+        const QString tag = effect.attribute(QStringLiteral("tag"));
+        if (!id.isEmpty() && !m_byId.contains(id)) m_byId.insert(id, effect);
+        if (!tag.isEmpty() && !m_byTag.contains(tag)) m_byTag.insert(tag, effect);
+        QDomElement namenode = effect.firstChildElement(QStringLiteral("name"));
+        if (!namenode.isNull()) {
+            const QString name = i18n(namenode.text().toUtf8().data());
+            if (!m_byName.contains(name)) m_byName.insert(name, effect);
+        }
+    }
+    m_indexed = true;
+}
+
+void EffectsList::invalidateIndex()
+{
+    m_indexed = false;
+}
+
+QDomElement EffectsList::indexedEffect(IndexTable table, const QString &key) const
+{
+    for (int pass = 0; pass < 2; ++pass) {
+        if (!m_indexed) buildIndex();
+        const QHash<QString, QDomElement> &hash = table == IdIndex ? m_byId : (table == TagIndex ? m_byTag : m_byName);
+        QDomElement effect = hash.value(key);
+        if (effect.isNull()) return effect;
+        // An element modified behind our back (removed, or its key changed) means the tables are stale
+        bool valid = effect.parentNode() == m_baseElement;
+        if (valid && table != NameIndex) {
+            valid = effect.attribute(table == IdIndex ? QStringLiteral("id") : QStringLiteral("tag")) == key;
+        }
+        if (valid) return effect;
+        m_indexed = false;
+    }
+    return QDomElement();
+}
+
 QDomElement EffectsList::getEffectByName(const QString & name) const
 {
+    if (m_hashed) {
+        QDomElement effect = indexedEffect(NameIndex, name);
+        if (!effect.isNull()) {
+            QDomNodeList params = effect.elementsByTagName(QStringLiteral("parameter"));
+            for (int i = 0; i < params.count(); ++i) {
+                QDomElement e = params.item(i).toElement();
+                if (!e.hasAttribute(QStringLiteral("value")))
+                    e.setAttribute(QStringLiteral("value"), e.attribute(QStringLiteral("default")));
+            }
+        }
+        return effect;
+    }
     QString effectName;
     QDomNodeList effects = m_baseElement.childNodes();
     for (int i = 0; i < effects.count(); ++i) {
@@ -70,6 +129,19 @@ void EffectsList::initEffect(const QDomElement &effect) const
 
 QDomElement EffectsList::getEffectByTag(const QString & tag, const QString & id) const
 {
+    if (m_hashed) {
+        if (id.isEmpty() && tag.isEmpty()) return QDomElement();
+        QDomElement effect = id.isEmpty() ? indexedEffect(TagIndex, tag) : indexedEffect(IdIndex, id);
+        if (effect.tagName() == QLatin1String("effectgroup")) {
+            QDomNodeList subeffects = effect.elementsByTagName(QStringLiteral("effect"));
+            for (int j = 0; j < subeffects.count(); ++j) {
+                initEffect(subeffects.at(j).toElement());
+            }
+        } else if (!effect.isNull()) {
+            initEffect(effect);
+        }
+        return effect;
+    }
     QDomNodeList effects = m_baseElement.childNodes();
     if (effects.isEmpty()) return QDomElement();
     for (int i = 0; i < effects.count(); ++i) {
@@ -99,6 +171,9 @@ QDomElement EffectsList::getEffectByTag(const QString & tag, const QString & id)
 
 QDomElement EffectsList::effectById(const QString & id) const
 {
+    if (m_hashed) {
+        return id.isEmpty() ? QDomElement() : indexedEffect(IdIndex, id);
+    }
     QDomNodeList effects = m_baseElement.childNodes();
     for (int i = 0; i < effects.count(); ++i) {
         QDomElement effect =  effects.at(i).toElement();
@@ -111,6 +186,9 @@ QDomElement EffectsList::effectById(const QString & id) const
 
 bool EffectsList::hasTransition(const QString & tag) const
 {
+    if (m_hashed) {
+        return !indexedEffect(TagIndex, tag).isNull();
+    }
     QDomNodeList trans = m_baseElement.childNodes();
     for (int i = 0; i < trans.count(); ++i) {
         QDomElement effect =  trans.at(i).toElement();
@@ -123,6 +201,11 @@ bool EffectsList::hasTransition(const QString & tag) const
 
 int EffectsList::hasEffect(const QString & tag, const QString & id) const
 {
+    if (m_hashed) {
+        if (id.isEmpty() && tag.isEmpty()) return -1;
+        QDomElement effect = id.isEmpty() ? indexedEffect(TagIndex, tag) : indexedEffect(IdIndex, id);
+        return effect.isNull() ? -1 : effect.attribute(QStringLiteral("kdenlive_ix")).toInt();
+    }
     QDomNodeList effects = m_baseElement.childNodes();
     for (int i = 0; i < effects.count(); ++i) {
         QDomElement effect =  effects.at(i).toElement();
@@ -205,6 +288,44 @@ QString EffectsList::getEffectInfo(const QDomElement &effect) const
     return info;
 }
 
+EffectSchema EffectsList::parameterSchema(const QDomElement &effect) const
+{
+    QString key;
+    if (m_hashed) {
+        if (!m_indexed) buildIndex();
+        key = effect.attribute(QStringLiteral("id")) + QLatin1Char('\n') + effect.attribute(QStringLiteral("tag"));
+        QHash<QString, EffectSchema>::const_iterator it = m_schemas.constFind(key);
+        if (it != m_schemas.constEnd()) return it.value();
+    }
+    EffectSchema schema;
+    QDomNodeList params = effect.elementsByTagName(QStringLiteral("parameter"));
+    schema.reserve(params.count());
+    for (int i = 0; i < params.count(); ++i) {
+        schema.append(parseParameter(params.item(i).toElement()));
+    }
+    if (m_hashed) m_schemas.insert(key, schema);
+    return schema;
+}
+
+// static
+EffectParameter EffectsList::parseParameter(const QDomElement &param)
+{
+    QLocale locale;
+    locale.setNumberOptions(QLocale::OmitGroupSeparator);
+    EffectParameter result;
+    result.name = param.attribute(QStringLiteral("name"));
+    result.type = param.attribute(QStringLiteral("type"));
+    result.offset = locale.toDouble(param.attribute(QStringLiteral("offset"), QStringLiteral("0")));
+    result.factor = 1;
+    QString factor = param.attribute(QStringLiteral("factor"), QStringLiteral("1"));
+    if (factor.contains('%')) {
+        result.factorExpression = factor;
+    } else {
+        result.factor = locale.toDouble(factor);
+    }
+    return result;
+}
+
 // static
 bool EffectsList::hasKeyFrames(const QDomElement &effect)
 {
@@ -220,10 +341,20 @@ void EffectsList::clone(const EffectsList &original)
 {
     setContent(original.toString());
     m_baseElement = documentElement();
+    invalidateIndex();
+}
+
+void EffectsList::setList(const QDomElement &list)
+{
+    clearList();
+    for (QDomNode effect = list.firstChild(); !effect.isNull(); effect = effect.nextSibling()) {
+        m_baseElement.appendChild(importNode(effect, true));
+    }
 }
 
 void EffectsList::clearList()
 {
+    invalidateIndex();
     while (!m_baseElement.firstChild().isNull())
         m_baseElement.removeChild(m_baseElement.firstChild());
 }
@@ -348,6 +479,7 @@ QDomElement EffectsList::append(QDomElement e)
     QDomElement result;
     if (!e.isNull()) {
         result = m_baseElement.appendChild(importNode(e, true)).toElement();
+        invalidateIndex();
         if (m_useIndex) {
             updateIndexes(m_baseElement.childNodes(), m_baseElement.childNodes().count() - 1);
         }
@@ -377,6 +509,7 @@ void EffectsList::removeAt(int ix)
     QDomNodeList effects = m_baseElement.childNodes();
     if (ix <= 0 || ix > effects.count()) return;
     m_baseElement.removeChild(effects.at(ix - 1));
+    invalidateIndex();
     if (m_useIndex) updateIndexes(effects, ix - 1);
 }
 
@@ -400,6 +533,7 @@ QDomElement EffectsList::insert(QDomElement effect)
         QDomElement listeffect =  effects.at(ix - 1).toElement();
         result = m_baseElement.insertBefore(importNode(effect, true), listeffect).toElement();
     }
+    invalidateIndex();
     if (m_useIndex && ix > 0)
         updateIndexes(effects, ix - 1);
     return result;
@@ -439,4 +573,5 @@ void EffectsList::updateEffect(const QDomElement &effect)
         m_baseElement.removeChild(current);
     }
     else m_baseElement.appendChild(importNode(effect, true));
+    invalidateIndex();
 }
@@ -27,16 +27,35 @@
 
 
 #include <QDomDocument>
+#include <QHash>
 #include <QSize>
+#include <QVector>
 
 namespace Kdenlive {
   enum EFFECTTYPE { simpleEffect, groupEffect };
 }
 
+/** @brief Attributes of an effect parameter needed to read its value from MLT, parsed once. */
+struct EffectParameter
+{
+    QString name;
+    QString type;
+    double offset;
+    /** @brief Scaling factor, only valid if factorExpression is empty. */
+    double factor;
+    /** @brief Factor depending on the profile (containing %), see EffectsController::getStringEval(). */
+    QString factorExpression;
+};
+/** @brief Parameters of an effect, in the order of its parameter elements. */
+typedef QVector<EffectParameter> EffectSchema;
+
 class EffectsList: public QDomDocument
 {
 public:
-    explicit EffectsList(bool indexRequired = false);
+    /** @param indexRequired maintain the kdenlive_ix attribute of the effects (clip and track effect lists)
+     *  @param hashed keep hash tables of the effects by id, tag and name for the lookups; used by the
+     *  global catalogues, which are only modified through this class */
+    explicit EffectsList(bool indexRequired = false, bool hashed = false);
     ~EffectsList();
     /** @brief Returns the XML element of an effect.
      * @param name name of the effect to be returned */
@@ -62,6 +81,8 @@ public:
     QString getInfoFromIndex(const int ix) const;
     QString getEffectInfo(const QDomElement &effect) const;
     void clone(const EffectsList &original);
+    /** @brief Replaces the effects with copies of the children of @param list, the root element of another list. */
+    void setList(const QDomElement &list);
     QDomElement append(QDomElement e);
     bool isEmpty() const;
     int count() const;
@@ -70,6 +91,11 @@ public:
     QDomElement itemFromIndex(int ix) const;
     QDomElement insert(QDomElement effect);
     void updateEffect(const QDomElement &effect);
+    /** @brief Returns the parsed parameters of @param effect, an element of this list.
+     *  Hashed lists parse each effect once. */
+    EffectSchema parameterSchema(const QDomElement &effect) const;
+    /** @brief Parses the attributes of a parameter element. */
+    static EffectParameter parseParameter(const QDomElement &param);
     static bool hasKeyFrames(const QDomElement &effect);
     static void setParameter(QDomElement effect, const QString &name, const QString &value);
     static QString parameter(const QDomElement &effect, const QString &name);
@@ -94,6 +120,21 @@ public:
 private:
     QDomElement m_baseElement;
     bool m_useIndex;
+    bool m_hashed;
+    /** @brief Lookup tables of hashed lists, built on first use and dropped when the list changes.
+     *  Only the first effect with a given key is stored, like the linear lookups find it. */
+    mutable bool m_indexed;
+    mutable QHash<QString, QDomElement> m_byId;
+    mutable QHash<QString, QDomElement> m_byTag;
+    mutable QHash<QString, QDomElement> m_byName;
+    mutable QHash<QString, EffectSchema> m_schemas;
+
+    enum IndexTable { IdIndex, TagIndex, NameIndex };
+
+    void buildIndex() const;
+    void invalidateIndex();
+    /** @brief Returns the first effect with @param key in an index of a hashed list. */
+    QDomElement indexedEffect(IndexTable table, const QString &key) const;
     
     /** @brief Init effect default parameter values. */
     void initEffect(const QDomElement &effect) const;
@@ -19,6 +19,7 @@
 
 #include "initeffects.h"
 #include "effectslist.h"
+#include "effectcatalogcache.h"
 
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
@@ -93,6 +94,12 @@ void initEffects::refreshLumas()
 
 // static
 QDomDocument initEffects::getUsedCustomEffects(const QMap <QString, QString>& effectids)
+{
+    return getUsedCustomEffects(effectids, MainWindow::customEffects);
+}
+
+//static
+QDomDocument initEffects::getUsedCustomEffects(const QMap <QString, QString>& effectids, const EffectsList &customEffects)
 {
     QMapIterator<QString, QString> i(effectids);
     QDomDocument doc;
@@ -100,9 +107,9 @@ QDomDocument initEffects::getUsedCustomEffects(const QMap <QString, QString>& ef
     doc.appendChild(list);
     while (i.hasNext()) {
         i.next();
-        int ix = MainWindow::customEffects.hasEffect(i.value(), i.key());
+        int ix = customEffects.hasEffect(i.value(), i.key());
         if (ix > -1) {
-            QDomElement e = MainWindow::customEffects.at(ix);
+            QDomElement e = customEffects.at(ix);
             list.appendChild(doc.importNode(e, true));
         }
     }
@@ -132,6 +139,14 @@ bool initEffects::parseEffectFiles(Mlt::Repository* repository, const QString &l
 #endif
     }
 
+    if (EffectCatalogCache::load(&movit)) {
+        return movit;
+    }
+    // Lists are rebuilt from scratch, so that removed effects do not stay in them
+    MainWindow::transitions.clearList();
+    MainWindow::audioEffects.clearList();
+    MainWindow::videoEffects.clearList();
+
     // Retrieve the list of MLT's available effects.
     Mlt::Properties *filters = repository->filters();
     QStringList filtersList;
@@ -384,7 +399,8 @@ bool initEffects::parseEffectFiles(Mlt::Repository* repository, const QString &l
     MainWindow::videoEffects.clearList();
     foreach(const QDomElement & effect, videoEffectsMap)
         MainWindow::videoEffects.append(effect);
-    
+
+    EffectCatalogCache::save(movit);
     return movit;
 }
 
@@ -41,11 +41,15 @@ public:
      *
      * It checks for all available effects and transitions, removes blacklisted
      * ones, calls fillTransitionsList() and parseEffectFile() to fill the lists
-     * (with sorted, unique items) and then fills the global lists. */
+     * (with sorted, unique items) and then fills the global lists.
+     * The lists are loaded from EffectCatalogCache instead when it is valid,
+     * and saved to it otherwise. */
     static bool parseEffectFiles(Mlt::Repository* repository, const QString &locale = QString());
     static void refreshLumas();
     static QDomDocument createDescriptionFromMlt(Mlt::Repository* repository, const QString& type, const QString& name);
     static QDomDocument getUsedCustomEffects(const QMap<QString, QString> &effectids);
+    /** @brief Same as above, looking for the effects in @param customEffects instead of the global list. */
+    static QDomDocument getUsedCustomEffects(const QMap<QString, QString> &effectids, const EffectsList &customEffects);
 
     /** @brief Fills the transitions list.
      * @param repository MLT repository
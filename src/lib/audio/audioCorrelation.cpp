@@ -14,12 +14,54 @@ the Free Software Foundation, either version 3 of the License, or
 #include "klocalizedstring.h"
 #include <QDebug>
 #include <QTime>
+#include <QtConcurrent>
 #include <cmath>
 #include <iostream>
 
 
+const int AudioCorrelation::coarseSize = 8192;
+
+// Number of coarse correlation peaks refined at frame resolution
+static const int coarseCandidates = 3;
+
+/** Sums blocks of @param factor entries of @param envelope. */
+static QVector<qint64> reduceEnvelope(const qint64 *envelope, int size, int factor)
+{
+    QVector<qint64> reduced((size + factor - 1) / factor, 0);
+    for (int i = 0; i < size; ++i) {
+        reduced[i / factor] += envelope[i];
+    }
+    return reduced;
+}
+
+/** Dot product of sub shifted by @param shift along main, see AudioCorrelation::correlate(). */
+static double shiftedProduct(const qint64 *envMain, int sizeMain, const qint64 *envSub, int sizeSub,
+                             int shift, double *squaresMain = NULL, double *squaresSub = NULL)
+{
+    const qint64 *left = shift <= 0 ? envSub - shift : envSub;
+    const qint64 *right = shift <= 0 ? envMain : envMain + shift;
+    const int size = shift <= 0 ? std::min(sizeSub + shift, sizeMain) : std::min(sizeSub, sizeMain - shift);
+    // Accumulated as double, the products of long envelopes overflow 64 bit integers
+    double sum = 0;
+    double sumLeft = 0;
+    double sumRight = 0;
+    for (int i = 0; i < size; ++i) {
+        sum += double(left[i]) * right[i];
+        if (squaresMain) {
+            sumLeft += double(left[i]) * left[i];
+            sumRight += double(right[i]) * right[i];
+        }
+    }
+    if (squaresMain) {
+        *squaresSub = sumLeft;
+        *squaresMain = sumRight;
+    }
+    return sum;
+}
+
 AudioCorrelation::AudioCorrelation(AudioEnvelope *mainTrackEnvelope) :
-    m_mainTrackEnvelope(mainTrackEnvelope)
+    m_mainTrackEnvelope(mainTrackEnvelope),
+    m_mainReady(false)
 {
     m_mainTrackEnvelope->normalizeEnvelope();
     connect(m_mainTrackEnvelope, SIGNAL(envelopeReady(AudioEnvelope*)), this, SLOT(slotAnnounceEnvelope()));
@@ -27,12 +69,24 @@ AudioCorrelation::AudioCorrelation(AudioEnvelope *mainTrackEnvelope) :
 
 AudioCorrelation::~AudioCorrelation()
 {
+    // Running alignments read the envelopes
+    QHashIterator<QFutureWatcher<AudioAlignment>*, AudioEnvelope*> i(m_running);
+    while (i.hasNext()) {
+        i.next();
+        i.key()->waitForFinished();
+        delete i.key()->result().info;
+        delete i.key();
+        delete i.value();
+    }
     delete m_mainTrackEnvelope;
     foreach (AudioEnvelope *envelope, m_children) {
         delete envelope;
     }
-    foreach (AudioCorrelationInfo *info, m_correlations) {
-        delete info;
+    foreach (AudioEnvelope *envelope, m_pending) {
+        delete envelope;
+    }
+    foreach (const AudioAlignment &alignment, m_alignments) {
+        delete alignment.info;
     }
 
     qDebug() << "Envelope deleted.";
@@ -40,7 +94,12 @@ AudioCorrelation::~AudioCorrelation()
 
 void AudioCorrelation::slotAnnounceEnvelope()
 {
+    m_mainReady = true;
     emit displayMessage(i18n("Audio analysis finished"), OperationCompletedMessage);
+    foreach (AudioEnvelope *envelope, m_pending) {
+        startAlignment(envelope);
+    }
+    m_pending.clear();
 }
 
 void AudioCorrelation::addChild(AudioEnvelope *envelope)
@@ -51,58 +110,139 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
 
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
 {
-    const int sizeMain = m_mainTrackEnvelope->envelopeSize();
-    const int sizeSub = envelope->envelopeSize();
-
-    AudioCorrelationInfo *info = new AudioCorrelationInfo(sizeMain, sizeSub);
-    qint64 *correlation = info->correlationVector();
+    if (!m_mainReady) {
+        m_pending.append(envelope);
+        return;
+    }
+    startAlignment(envelope);
+}
 
-    const qint64 *envMain = m_mainTrackEnvelope->envelope();
-    const qint64 *envSub = envelope->envelope();
-    qint64 max = 0;
+void AudioCorrelation::startAlignment(AudioEnvelope *envelope)
+{
+    QFutureWatcher<AudioAlignment> *watcher = new QFutureWatcher<AudioAlignment>(this);
+    m_running.insert(watcher, envelope);
+    connect(watcher, SIGNAL(finished()), this, SLOT(slotAlignmentFinished()));
+    watcher->setFuture(QtConcurrent::run(&AudioCorrelation::align,
+                                         m_mainTrackEnvelope->envelope(), m_mainTrackEnvelope->envelopeSize(),
+                                         envelope->envelope(), envelope->envelopeSize()));
+}
 
-    if (sizeSub > 200) {
-        FFTCorrelation::correlate(envMain, sizeMain,
-                                  envSub, sizeSub,
-                                  correlation);
-    } else {
-        correlate(envMain, sizeMain,
-                  envSub, sizeSub,
-                  correlation,
-                  &max);
-        info->setMax(max);
+void AudioCorrelation::slotAlignmentFinished()
+{
+    QFutureWatcher<AudioAlignment> *watcher = static_cast<QFutureWatcher<AudioAlignment>*>(sender());
+    if (!m_running.contains(watcher)) {
+        return;
     }
-
+    AudioEnvelope *envelope = m_running.take(watcher);
+    const AudioAlignment alignment = watcher->result();
+    watcher->deleteLater();
 
     m_children.append(envelope);
-    m_correlations.append(info);
-
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    emit gotAudioAlignData(envelope->track(), envelope->startPos(), shift);
+    m_alignments.append(alignment);
+    Q_ASSERT(m_alignments.size() == m_children.size());
+    emit gotAudioAlignData(envelope->track(), envelope->startPos(), alignment.shift, alignment.confidence);
 }
 
 int AudioCorrelation::getShift(int childIndex) const
 {
     Q_ASSERT(childIndex >= 0);
-    Q_ASSERT(childIndex < m_correlations.size());
+    Q_ASSERT(childIndex < m_alignments.size());
+
+    return m_alignments.at(childIndex).shift;
+}
 
-    int indexOffset = m_correlations.at(childIndex)->maxIndex();
-    indexOffset -= m_children.at(childIndex)->envelopeSize();
+double AudioCorrelation::confidence(int childIndex) const
+{
+    Q_ASSERT(childIndex >= 0);
+    Q_ASSERT(childIndex < m_alignments.size());
 
-    return indexOffset;
+    return m_alignments.at(childIndex).confidence;
 }
 
 AudioCorrelationInfo const* AudioCorrelation::info(int childIndex) const
 {
     Q_ASSERT(childIndex >= 0);
-    Q_ASSERT(childIndex < m_correlations.size());
+    Q_ASSERT(childIndex < m_alignments.size());
 
-    return m_correlations.at(childIndex);
+    return m_alignments.at(childIndex).info;
 }
 
+//static
+AudioAlignment AudioCorrelation::align(const qint64 *envMain, int sizeMain,
+                                       const qint64 *envSub, int sizeSub)
+{
+    QTime t;
+    t.start();
+
+    // Coarse pass on envelopes of at most coarseSize entries
+    const int factor = qMax(1, (qMax(sizeMain, sizeSub) + coarseSize - 1) / coarseSize);
+    const QVector<qint64> coarseMain = reduceEnvelope(envMain, sizeMain, factor);
+    const QVector<qint64> coarseSub = reduceEnvelope(envSub, sizeSub, factor);
+    const int coarseTotal = coarseMain.size() + coarseSub.size() + 1;
+    QVector<float> coarse(coarseTotal);
+    FFTCorrelation::correlate(coarseMain.constData(), coarseMain.size(),
+                              coarseSub.constData(), coarseSub.size(),
+                              coarse.data());
+
+    AudioAlignment result;
+    result.shift = 0;
+    result.confidence = 0;
+    result.info = new AudioCorrelationInfo(coarseMain.size(), coarseSub.size());
+    qint64 *correlation = result.info->correlationVector();
+    for (int i = 0; i < coarseTotal; ++i) {
+        // Entries are at most the vector size, keep some fractional precision
+        correlation[i] = qAbs(coarse.at(i)) * 1024;
+    }
+
+    // Highest local maxima of the coarse correlation
+    QList<int> candidates;
+    for (int i = 0; i < coarseTotal; ++i) {
+        const float value = coarse.at(i);
+        if ((i > 0 && coarse.at(i - 1) > value) || (i < coarseTotal - 1 && coarse.at(i + 1) > value)) {
+            continue;
+        }
+        int pos = candidates.size();
+        while (pos > 0 && coarse.at(candidates.at(pos - 1)) < value) {
+            --pos;
+        }
+        if (pos < coarseCandidates) {
+            candidates.insert(pos, i);
+            if (candidates.size() > coarseCandidates) {
+                candidates.removeLast();
+            }
+        }
+    }
+
+    // Refine around each candidate at frame resolution
+    double best = 0;
+    bool found = false;
+    foreach (int index, candidates) {
+        const int center = (index - coarseSub.size()) * factor;
+        const int first = qMax(-sizeSub, center - 2 * factor);
+        const int last = qMin(sizeMain, center + 2 * factor);
+        for (int shift = first; shift <= last; ++shift) {
+            const double sum = shiftedProduct(envMain, sizeMain, envSub, sizeSub, shift);
+            if (!found || sum > best) {
+                best = sum;
+                result.shift = shift;
+                found = true;
+            }
+        }
+    }
+    if (found) {
+        double squaresMain = 0;
+        double squaresSub = 0;
+        const double sum = shiftedProduct(envMain, sizeMain, envSub, sizeSub, result.shift, &squaresMain, &squaresSub);
+        if (squaresMain > 0 && squaresSub > 0) {
+            result.confidence = qBound(0.0, sum / std::sqrt(squaresMain * squaresSub), 1.0);
+        }
+    }
+    qDebug() << "Alignment (coarse factor" << factor << ") computed in " << t.elapsed() << " ms, shift" << result.shift
+             << "confidence" << result.confidence;
+    return result;
+}
 
+//static
 void AudioCorrelation::correlate(const qint64 *envMain, int sizeMain,
                                  const qint64 *envSub, int sizeSub,
                                  qint64 *correlation,
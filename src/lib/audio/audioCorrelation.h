@@ -14,8 +14,20 @@
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include <QFutureWatcher>
+#include <QHash>
 #include <QList>
 
+/** Result of the alignment of a clip on the main track */
+struct AudioAlignment {
+    /** Frames to shift the clip by, see AudioCorrelation::getShift() */
+    int shift;
+    /** Normalized correlation of the envelopes at the shift, from 0 (no match) to 1 */
+    double confidence;
+    /** Correlation of the coarse envelopes */
+    AudioCorrelationInfo *info;
+};
+
 
 /**
   This class does the correlation between two tracks
@@ -23,6 +35,11 @@
 
   It uses one main track (used in the initializer); further tracks will be
   aligned relative to this main track.
+
+  Envelopes are computed in parallel as children are added. Each child is
+  then aligned in a worker thread, first on envelopes reduced to at most
+  coarseSize entries with an FFT correlation, then around the best coarse
+  candidates at frame resolution.
   */
 class AudioCorrelation : public QObject
 {
@@ -39,6 +56,15 @@ public:
 
     const AudioCorrelationInfo *info(int childIndex) const;
     int getShift(int childIndex) const;
+    /** @brief Confidence of the alignment of a child, see AudioAlignment. */
+    double confidence(int childIndex) const;
+
+    /**
+      Finds the shift of envSub on envMain, coarse to fine.
+      The caller takes ownership of the returned correlation info.
+      */
+    static AudioAlignment align(const qint64 *envMain, int sizeMain,
+                                const qint64 *envSub, int sizeSub);
 
     /**
       Correlates the two vectors envMain and envSub.
@@ -48,18 +74,30 @@ public:
                           const qint64 *envSub, int sizeSub,
                           qint64 *correlation,
                           qint64 *out_max = NULL);
+    /** @brief Maximum size of the envelopes correlated in the coarse pass. */
+    static const int coarseSize;
+
 private:
     AudioEnvelope *m_mainTrackEnvelope;
+    bool m_mainReady;
 
     QList<AudioEnvelope*> m_children;
-    QList<AudioCorrelationInfo*> m_correlations;
+    QList<AudioAlignment> m_alignments;
+    /** @brief Children whose envelope is ready before the main one. */
+    QList<AudioEnvelope*> m_pending;
+    /** @brief Alignments running in the thread pool. */
+    QHash<QFutureWatcher<AudioAlignment>*, AudioEnvelope*> m_running;
+
+    void startAlignment(AudioEnvelope *envelope);
 
 private slots:    
     void slotProcessChild(AudioEnvelope *envelope);
     void slotAnnounceEnvelope();
+    void slotAlignmentFinished();
     
 signals:
-    void gotAudioAlignData(int, int, int);
+    /** @brief Emitted for each child with its track, start position, shift and confidence. */
+    void gotAudioAlignData(int, int, int, double);
     void displayMessage(const QString &, MessageType);
 };
 
@@ -13,10 +13,16 @@
 #include "audioStreamInfo.h"
 #include <QDebug>
 #include <QImage>
+#include <QThread>
 #include <QTime>
 #include <QtConcurrent>
 #include <cmath>
 
+const int AudioEnvelope::envelopeRate = 8000;
+
+// Clips shorter than this (in frames) are not split for decoding
+static const int minSegmentLength = 1500;
+
 AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int offset, int length, int track, int startPos) :
     m_envelope(NULL),
     m_offset(offset),
@@ -31,13 +37,13 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
     m_envelopeIsNormalized(false)
 {
     // make a copy of the producer to avoid audio playback issues
-    QString path = QString::fromUtf8(producer->get("resource"));
-    if (path == QLatin1String("<playlist>") || path == QLatin1String("<tractor>") || path ==QLatin1String( "<producer>"))
-	path = url;
-    m_producer = new Mlt::Producer(*(producer->profile()), path.toUtf8().constData());
+    m_path = QString::fromUtf8(producer->get("resource"));
+    if (m_path == QLatin1String("<playlist>") || m_path == QLatin1String("<tractor>") || m_path ==QLatin1String( "<producer>"))
+	m_path = url;
+    m_producer = new Mlt::Producer(*(producer->profile()), m_path.toUtf8().constData());
     connect(&m_watcher, SIGNAL(finished()), this, SLOT(slotProcessEnveloppe()));
     if (!m_producer || !m_producer->is_valid()) {
-	qDebug()<<"// Cannot create envelope for producer: "<<path;
+	qDebug()<<"// Cannot create envelope for producer: "<<m_path;
     }
     m_info = new AudioInfo(m_producer);
 
@@ -50,6 +56,8 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
 
 AudioEnvelope::~AudioEnvelope()
 {
+    // The envelope may still be computed in a worker thread
+    m_future.waitForFinished();
     if (m_envelope != NULL) {
         delete[] m_envelope;
     }
@@ -77,50 +85,72 @@ void AudioEnvelope::loadEnvelope()
 
     qDebug() << "Loading envelope ...";
 
-    int samplingRate = m_info->info(0)->samplingRate();
-    mlt_audio_format format_s16 = mlt_audio_s16;
-    int channels = 1;
-
     m_envelope = new qint64[m_envelopeSize];
     m_envelopeMax = 0;
     m_envelopeMean = 0;
 
     QTime t;
     t.start();
-    int count = 0;
-    m_producer->seek(m_offset);
-    m_producer->set_speed(1.0); // This is necessary, otherwise we don't get any new frames in the 2nd run.
-    for (int i = 0; i < m_envelopeSize; ++i) {
-        Mlt::Frame *frame = m_producer->get_frame(i);
-        qint64 position = mlt_frame_get_position(frame->get_frame());
-        int samples = mlt_sample_calculator(m_producer->get_fps(), samplingRate, position);
-
-        qint16 *data = static_cast<qint16*>(frame->get_audio(format_s16, samplingRate, channels, samples));
-
-        qint64 sum = 0;
-        for (int k = 0; k < samples; ++k) {
-            sum += abs(data[k]);
-        }
-        m_envelope[i] = sum;
+    const int segments = qBound(1, m_envelopeSize / minSegmentLength, QThread::idealThreadCount());
+    QList <QPair<int, int> > ranges;
+    for (int i = 0; i < segments; ++i) {
+        ranges << QPair<int, int>(i * m_envelopeSize / segments, (i + 1) * m_envelopeSize / segments);
+    }
+    QtConcurrent::blockingMap(ranges, [this](const QPair<int, int> &range) {
+        loadSegment(range.first, range.second);
+    });
 
-        m_envelopeMean += sum;
-        if (sum > m_envelopeMax) {
-            m_envelopeMax = sum;
+    for (int i = 0; i < m_envelopeSize; ++i) {
+        m_envelopeMean += m_envelope[i];
+        if (m_envelope[i] > m_envelopeMax) {
+            m_envelopeMax = m_envelope[i];
         }
+    }
+    if (m_envelopeSize > 0) {
+        m_envelopeMean /= m_envelopeSize;
+    }
+    qDebug() << "Calculating the envelope (" << m_envelopeSize << " frames, " << segments << " segments) took "
+              << t.elapsed() << " ms.";
+}
 
-//        qDebug() << position << '|' << m_producer->get_playtime()
-//                  << '-' << m_producer->get_in() << '+' << m_producer->get_out() << ' ';
-
-        delete frame;
-
-        count++;
-        if (m_length > 0 && count > m_length) {
+void AudioEnvelope::loadSegment(int first, int end)
+{
+    std::fill(m_envelope + first, m_envelope + end, 0);
+    // Producers cannot be shared between threads, create one like m_producer
+    Mlt::Producer producer(*(m_producer->profile()), m_path.toUtf8().constData());
+    if (!producer.is_valid()) {
+        return;
+    }
+    // Only the audio is needed, do not decode the video
+    producer.set("video_index", -1);
+    producer.seek(m_offset + first);
+    producer.set_speed(1.0);
+
+    const int samplingRate = m_info->size() > 0 ? m_info->info(0)->samplingRate() : 48000;
+    for (int i = first; i < end; ++i) {
+        mlt_frame frame = NULL;
+        if (mlt_service_get_frame(producer.get_service(), &frame, 0) != 0 || frame == NULL) {
             break;
         }
+        mlt_audio_format format = mlt_audio_s16;
+        int frequency = samplingRate;
+        int channels = 1;
+        int samples = mlt_sample_calculator(producer.get_fps(), frequency, mlt_frame_get_position(frame));
+        void *buffer = NULL;
+        if (mlt_frame_get_audio(frame, &buffer, &format, &frequency, &channels, &samples) == 0 && buffer != NULL
+                && format == mlt_audio_s16 && channels > 0) {
+            // The producer may not honour the requested channel count, read the first channel only
+            const qint16 *data = static_cast<const qint16*>(buffer);
+            const int step = qMax(1, frequency / envelopeRate);
+            qint64 sum = 0;
+            for (int k = 0; k < samples; k += step) {
+                sum += abs(data[k * channels]);
+            }
+            // Keep the scale of an envelope summing all samples
+            m_envelope[i] = sum * step;
+        }
+        mlt_frame_close(frame);
     }
-    m_envelopeMean /= m_envelopeSize;
-    qDebug() << "Calculating the envelope (" << m_envelopeSize << " frames) took "
-              << t.elapsed() << " ms.";
 }
 
 int AudioEnvelope::track() const
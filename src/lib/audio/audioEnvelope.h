@@ -24,6 +24,11 @@ class QImage;
   with frame resolution. One entry is calculated by the sum
   of the absolute values of all samples in the current frame.
 
+  Only every n-th sample is summed so that the envelope is computed at
+  roughly envelopeRate Hz, which is plenty for alignment. Long clips are
+  split into segments that are decoded in parallel, each with its own
+  producer.
+
   See also: http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
   */
 class AudioEnvelope : public QObject
@@ -48,9 +53,14 @@ public:
     int track() const;
     int startPos() const;
 
+    /** @brief Sampling rate the envelope is computed at, in Hz. */
+    static const int envelopeRate;
+
 private:
     qint64 *m_envelope;
     Mlt::Producer *m_producer;
+    /** @brief Resource m_producer was created from, also used for the producers of each segment. */
+    QString m_path;
     AudioInfo *m_info;
     QFutureWatcher<void> m_watcher;
     QFuture<void> m_future;
@@ -67,6 +77,9 @@ private:
 
     bool m_envelopeStdDevCalculated;
     bool m_envelopeIsNormalized;
+
+    /** @brief Computes the envelope entries [first, end[ with a producer of its own. */
+    void loadSegment(int first, int end);
     
 private slots:
     void slotProcessEnveloppe();
@@ -0,0 +1,282 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "audioPeaks.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+// Bump the version whenever the layout of AudioPeak or of the file changes
+static const char peakFileMagic[4] = {'K', 'P', 'K', 'S'};
+static const quint32 peakFileVersion = 1;
+
+/**
+  Header of a peak file, followed by all levels as laid out in memory.
+  Values are stored in native byte order, a file written on a machine
+  with another endianness fails the version check and is regenerated.
+  */
+struct AudioPeaksHeader
+{
+    char magic[4];
+    quint32 version;
+    qint32 streamIndex;
+    quint32 channels;
+    quint32 frames;
+    quint32 dataSize;
+    quint32 reserved[2];
+};
+
+AudioPeaks::AudioPeaks() :
+    m_channels(0),
+    m_frames(0)
+{
+}
+
+AudioPeaks::AudioPeaks(int channels, int framesHint) :
+    m_channels(qMax(channels, 1)),
+    m_frames(0)
+{
+    if (framesHint > 0) {
+        // Level 0 plus all reduced levels take less than twice the size of level 0
+        m_data.reserve(2 * framesHint * m_channels * (int) sizeof(AudioPeak));
+    }
+}
+
+bool AudioPeaks::isEmpty() const
+{
+    return m_frames == 0 || m_levelOffsets.isEmpty();
+}
+
+void AudioPeaks::clear()
+{
+    m_frames = 0;
+    m_data.clear();
+    m_levelOffsets.clear();
+    m_file.clear();
+}
+
+int AudioPeaks::channels() const
+{
+    return m_channels;
+}
+
+int AudioPeaks::frameCount() const
+{
+    return m_frames;
+}
+
+int AudioPeaks::levelCount() const
+{
+    return m_levelOffsets.count();
+}
+
+void AudioPeaks::appendFrame(const AudioPeak *peaks)
+{
+    if (!m_levelOffsets.isEmpty()) {
+        // Drop the reduced levels, they will be rebuilt by finalize()
+        m_data.truncate(m_frames * m_channels * (int) sizeof(AudioPeak));
+        m_levelOffsets.clear();
+    }
+    m_data.append((const char *) peaks, m_channels * (int) sizeof(AudioPeak));
+    m_frames++;
+}
+
+QVector <int> AudioPeaks::levelOffsets(int frames, int channels)
+{
+    QVector <int> offsets;
+    if (frames <= 0) return offsets;
+    int size = frames;
+    int offset = 0;
+    offsets << 0;
+    while (size > 1) {
+        offset += size * channels;
+        size = (size + 1) / 2;
+        offsets << offset;
+    }
+    return offsets;
+}
+
+void AudioPeaks::finalize()
+{
+    m_levelOffsets = levelOffsets(m_frames, m_channels);
+    if (m_levelOffsets.isEmpty()) return;
+    int size = m_frames;
+    int total = m_levelOffsets.last() + m_channels;
+    m_data.resize(total * (int) sizeof(AudioPeak));
+    AudioPeak *data = (AudioPeak *) m_data.data();
+    for (int level = 1; level < m_levelOffsets.count(); ++level) {
+        const AudioPeak *source = data + m_levelOffsets.at(level - 1);
+        AudioPeak *dest = data + m_levelOffsets.at(level);
+        int reducedSize = (size + 1) / 2;
+        for (int i = 0; i < reducedSize; ++i) {
+            for (int c = 0; c < m_channels; ++c) {
+                const AudioPeak &a = source[2 * i * m_channels + c];
+                AudioPeak &p = dest[i * m_channels + c];
+                if (2 * i + 1 < size) {
+                    const AudioPeak &b = source[(2 * i + 1) * m_channels + c];
+                    p.min = qMin(a.min, b.min);
+                    p.max = qMax(a.max, b.max);
+                    p.rms = (quint8) qRound(sqrt((a.rms * a.rms + b.rms * b.rms) / 2.0));
+                    p.reserved = 0;
+                } else {
+                    p = a;
+                }
+            }
+        }
+        size = reducedSize;
+    }
+}
+
+bool AudioPeaks::load(const QString &path, int streamIndex)
+{
+    clear();
+    QSharedPointer <QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) return false;
+    qint64 fileSize = file->size();
+    if (fileSize < (qint64) sizeof(AudioPeaksHeader)) {
+        qDebug() << "// Truncated audio peak file: " << path;
+        return false;
+    }
+    uchar *mapped = file->map(0, fileSize);
+    if (mapped == NULL) return false;
+    const AudioPeaksHeader *header = (const AudioPeaksHeader *) mapped;
+    if (memcmp(header->magic, peakFileMagic, 4) != 0 || header->version != peakFileVersion || header->streamIndex != streamIndex || header->channels == 0 || header->frames == 0) {
+        return false;
+    }
+    QVector <int> offsets = levelOffsets((int) header->frames, (int) header->channels);
+    qint64 expected = (qint64) (offsets.last() + (int) header->channels) * (qint64) sizeof(AudioPeak);
+    if ((qint64) header->dataSize != expected || fileSize != (qint64) sizeof(AudioPeaksHeader) + expected) {
+        // Half written or corrupted file
+        qDebug() << "// Invalid audio peak file size: " << path;
+        return false;
+    }
+    m_channels = (int) header->channels;
+    m_frames = (int) header->frames;
+    m_levelOffsets = offsets;
+    // Point to the mapped data, nothing is copied unless the peaks are modified
+    m_data = QByteArray::fromRawData((const char *) mapped + sizeof(AudioPeaksHeader), (int) expected);
+    m_file = file;
+    return true;
+}
+
+bool AudioPeaks::save(const QString &path, int streamIndex) const
+{
+    if (isEmpty()) return false;
+    AudioPeaksHeader header;
+    memset(&header, 0, sizeof(AudioPeaksHeader));
+    memcpy(header.magic, peakFileMagic, 4);
+    header.version = peakFileVersion;
+    header.streamIndex = streamIndex;
+    header.channels = (quint32) m_channels;
+    header.frames = (quint32) m_frames;
+    header.dataSize = (quint32) m_data.size();
+    // QSaveFile only replaces the existing file once everything was written
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    if (file.write((const char *) &header, sizeof(AudioPeaksHeader)) != (qint64) sizeof(AudioPeaksHeader) || file.write(m_data) != m_data.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+bool AudioPeaks::isMapped() const
+{
+    return !m_file.isNull();
+}
+
+const AudioPeak *AudioPeaks::levelData(int level) const
+{
+    if (level < 0 || level >= m_levelOffsets.count()) return NULL;
+    return (const AudioPeak *) m_data.constData() + m_levelOffsets.at(level);
+}
+
+int AudioPeaks::levelSize(int level) const
+{
+    if (level < 0 || level >= m_levelOffsets.count()) return 0;
+    // Each level has ceil(frames / 2^level) buckets
+    return (m_frames + (1 << level) - 1) >> level;
+}
+
+AudioPeak AudioPeaks::peak(int channel, int start, int end) const
+{
+    AudioPeak result = {0, 0, 0, 0};
+    start = qMax(start, 0);
+    end = qMin(end, m_frames);
+    if (start >= end || channel < 0 || channel >= m_channels || m_levelOffsets.isEmpty()) {
+        return result;
+    }
+    const AudioPeak *data = (const AudioPeak *) m_data.constData();
+    const int levels = m_levelOffsets.count();
+    qint64 squares = 0;
+    bool first = true;
+    int pos = start;
+    while (pos < end) {
+        // Use the largest bucket aligned on pos that does not go past end
+        int level = 0;
+        while (level + 1 < levels && (pos & ((2 << level) - 1)) == 0 && pos + (2 << level) <= end) {
+            ++level;
+        }
+        const AudioPeak &p = data[m_levelOffsets.at(level) + (pos >> level) * m_channels + channel];
+        if (first) {
+            result.min = p.min;
+            result.max = p.max;
+            first = false;
+        } else {
+            result.min = qMin(result.min, p.min);
+            result.max = qMax(result.max, p.max);
+        }
+        squares += ((qint64) p.rms * p.rms) << level;
+        pos += 1 << level;
+    }
+    result.rms = (quint8) qMin(255, qRound(sqrt((double) squares / (end - start))));
+    return result;
+}
+
+AudioPeak AudioPeaks::peak(int start, int end) const
+{
+    AudioPeak result = peak(0, start, end);
+    for (int c = 1; c < m_channels; ++c) {
+        AudioPeak p = peak(c, start, end);
+        result.min = qMin(result.min, p.min);
+        result.max = qMax(result.max, p.max);
+        result.rms = qMax(result.rms, p.rms);
+    }
+    return result;
+}
+
+double AudioPeaks::amplitude(const AudioPeak &peak)
+{
+    return qMax((int) peak.max, - (int) peak.min) / 127.0;
+}
+
+AudioPeak AudioPeaks::fromLevel(double level)
+{
+    AudioPeak p;
+    qint8 value = (qint8) qBound(0, qRound(level * 127), 127);
+    p.min = -value;
+    p.max = value;
+    p.rms = (quint8) value;
+    p.reserved = 0;
+    return p;
+}
+
+AudioPeak AudioPeaks::fromSamples(qint16 min, qint16 max, double rms)
+{
+    AudioPeak p;
+    p.min = (qint8) qBound(-127, (int) min * 127 / 32767, 127);
+    p.max = (qint8) qBound(-127, (int) max * 127 / 32767, 127);
+    p.rms = (quint8) qBound(0, qRound(rms * 127 / 32767), 127);
+    p.reserved = 0;
+    return p;
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef AUDIOPEAKS_H
+#define AUDIOPEAKS_H
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class QFile;
+
+/**
+  Peak values of one audio channel over one frame (or over a bucket of
+  frames in the reduced levels). Sample values are scaled to [-127, 127],
+  so the struct is 4 bytes and can be stored or mapped as is.
+  */
+struct AudioPeak
+{
+    qint8 min;
+    qint8 max;
+    quint8 rms;
+    quint8 reserved;
+};
+
+/**
+  Compact store for audio thumbnails.
+
+  Level 0 holds one AudioPeak per frame and channel (interleaved by
+  channel). Each following level halves the resolution by merging two
+  buckets of the previous one, until a level holds a single bucket.
+  Queries over a frame range are answered by combining the largest
+  aligned buckets that fit in the range, so drawing a pixel never
+  has to walk every frame it covers and never skips a frame either.
+
+  The class is implicitly shared: copies only share the underlying buffer.
+  Peaks can be saved to a versioned binary file and mapped back in memory
+  without decoding (see save() and load()).
+  */
+class AudioPeaks
+{
+public:
+    AudioPeaks();
+    explicit AudioPeaks(int channels, int framesHint = 0);
+
+    bool isEmpty() const;
+    void clear();
+    int channels() const;
+    /** @brief Number of frames in level 0. */
+    int frameCount() const;
+    /** @brief Number of reduction levels, level 0 included (0 until finalize() was called). */
+    int levelCount() const;
+
+    /** @brief Append the peaks of one frame, @param peaks must hold one entry per channel. */
+    void appendFrame(const AudioPeak *peaks);
+    /** @brief Build the reduced levels once all frames were appended. */
+    void finalize();
+
+    /** @brief Maps a peak file written by save().
+     *  @param path the peak file
+     *  @param streamIndex the audio stream the peaks must have been computed for
+     *  @return false if the file is missing, truncated or was written by another version */
+    bool load(const QString &path, int streamIndex);
+    /** @brief Atomically writes the finalized peaks to @param path. */
+    bool save(const QString &path, int streamIndex) const;
+    /** @brief Returns true if the peaks are read from a mapped file. */
+    bool isMapped() const;
+
+    /** @brief Returns the combined peak of @param channel over frames [start, end). */
+    AudioPeak peak(int channel, int start, int end) const;
+    /** @brief Returns the combined peak of all channels over frames [start, end). */
+    AudioPeak peak(int start, int end) const;
+
+    /** @brief Returns the raw buckets of a level and its bucket count. */
+    const AudioPeak *levelData(int level) const;
+    int levelSize(int level) const;
+
+    /** @brief Returns the highest absolute value of a peak, in the [0, 1] range. */
+    static double amplitude(const AudioPeak &peak);
+    /** @brief Builds a symmetric peak from a level in the [0, 1] range. */
+    static AudioPeak fromLevel(double level);
+    /** @brief Builds a peak from the min / max / rms of 16 bit samples. */
+    static AudioPeak fromSamples(qint16 min, qint16 max, double rms);
+
+private:
+    int m_channels;
+    int m_frames;
+    /** @brief Buffer holding all levels, one after another. */
+    QByteArray m_data;
+    /** @brief Offset (in AudioPeak units) of each level in m_data. */
+    QVector <int> m_levelOffsets;
+    /** @brief The peak file m_data points to when loaded from disk, keeps the mapping alive. */
+    QSharedPointer <QFile> m_file;
+    /** @brief Returns the offset of each level in a buffer for @param frames and @param channels. */
+    static QVector <int> levelOffsets(int frames, int channels);
+};
+
+#endif
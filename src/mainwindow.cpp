@@ -30,6 +30,7 @@
 #include "dialogs/kdenlivesettingsdialog.h"
 #include "dialogs/clipcreationdialog.h"
 #include "effectslist/initeffects.h"
+#include "effectslist/effectcatalogcache.h"
 #include "project/dialogs/projectsettings.h"
 #include "project/clipmanager.h"
 #include "monitor/monitor.h"
@@ -102,10 +103,13 @@
 
 #include <stdlib.h>
 #include <QStandardPaths>
+#include <QtConcurrent>
 #include <KConfigGroup>
 #include <QDialogButtonBox>
 #include <QPushButton>
 #include <QVBoxLayout>
+#include <QLabel>
+#include <KIO/Global>
 
 static const char version[] = KDENLIVE_VERSION;
 namespace Mlt
@@ -113,10 +117,10 @@ namespace Mlt
 class Producer;
 };
 
-EffectsList MainWindow::videoEffects;
-EffectsList MainWindow::audioEffects;
-EffectsList MainWindow::customEffects;
-EffectsList MainWindow::transitions;
+EffectsList MainWindow::videoEffects(false, true);
+EffectsList MainWindow::audioEffects(false, true);
+EffectsList MainWindow::customEffects(false, true);
+EffectsList MainWindow::transitions(false, true);
 
 QMap <QString,QImage> MainWindow::m_lumacache;
 
@@ -318,7 +322,13 @@ MainWindow::MainWindow(const QString &MltPath, const QUrl &Url, const QString &
     m_undoView->setCleanIcon(KoIconUtils::themedIcon(QStringLiteral("edit-clear")));
     m_undoView->setEmptyLabel(i18n("Clean"));
     m_undoView->setGroup(m_commandStack);
-    m_undoViewDock = addDock(i18n("Undo History"), QStringLiteral("undo_history"), m_undoView);
+    QWidget *undoWidget = new QWidget;
+    QVBoxLayout *undoLayout = new QVBoxLayout(undoWidget);
+    undoLayout->setContentsMargins(0, 0, 0, 0);
+    undoLayout->addWidget(m_undoView);
+    m_undoMemoryLabel = new QLabel(undoWidget);
+    undoLayout->addWidget(m_undoMemoryLabel);
+    m_undoViewDock = addDock(i18n("Undo History"), QStringLiteral("undo_history"), undoWidget);
 
 
     setupActions();
@@ -370,6 +380,11 @@ MainWindow::MainWindow(const QString &MltPath, const QUrl &Url, const QString &
     m_transitionsMenu = new QMenu(i18n("Add Transition"), this);
     m_transitionActions = new KActionCategory(i18n("Transitions"), actionCollection());
     m_transitionList->reloadEffectList(m_transitionsMenu, m_transitionActions);
+    if (EffectCatalogCache::isLoaded()) {
+        // Effects were loaded from the cache, check that their folders did not change without delaying startup
+        connect(&m_catalogCheck, SIGNAL(finished()), this, SLOT(slotCheckEffectCatalog()));
+        m_catalogCheck.setFuture(QtConcurrent::run(&EffectCatalogCache::folderFingerprint));
+    }
 
     ScopeManager *scmanager = new ScopeManager(this);
 
@@ -759,6 +774,18 @@ void MainWindow::slotReloadEffects()
     m_effectList->reloadEffectList(m_effectsMenu, m_effectActions);
 }
 
+void MainWindow::slotCheckEffectCatalog()
+{
+    if (EffectCatalogCache::matches(m_catalogCheck.result())) {
+        return;
+    }
+    qDebug() << "// Effect folders changed, rebuilding the effect catalogue";
+    EffectCatalogCache::invalidate();
+    initEffects::parseEffectFiles(pCore->binController()->mltRepository());
+    m_effectList->reloadEffectList(m_effectsMenu, m_effectActions);
+    m_transitionList->reloadEffectList(m_transitionsMenu, m_transitionActions);
+}
+
 void MainWindow::configureNotifications()
 {
     KNotifyConfigWidget::configure(this);
@@ -1351,6 +1378,10 @@ void MainWindow::setupActions()
     disableEffects->setCheckable(true);
     disableEffects->setChecked(false);
 
+    QAction *autoPreview = addAction(QStringLiteral("auto_timeline_preview"), i18n("Automatic Timeline Preview"), this, SLOT(slotAutoTimelinePreview(bool)), KoIconUtils::themedIcon(QStringLiteral("media-record")));
+    autoPreview->setCheckable(true);
+    autoPreview->setChecked(KdenliveSettings::autopreview());
+
     QAction *duplicateClip = addAction(QStringLiteral("duplicate_clip"), i18n("Duplicate Clip"), pCore->bin(), SLOT(slotDuplicateClip()), KoIconUtils::themedIcon(QStringLiteral("edit-copy")));
     duplicateClip->setData("duplicate_clip");
     duplicateClip->setEnabled(false);
@@ -1613,6 +1644,11 @@ void MainWindow::slotUpdateProjectDuration(int pos)
     }
 }
 
+void MainWindow::slotUpdateUndoMemory(qint64 bytes)
+{
+    m_undoMemoryLabel->setText(i18n("Memory used: %1", KIO::convertSize(bytes)));
+}
+
 void MainWindow::slotUpdateDocumentState(bool modified)
 {
     setWindowTitle(pCore->projectManager()->current()->description());
@@ -1705,6 +1741,8 @@ void MainWindow::connectDocument()
     }
     m_zoomSlider->setValue(project->zoom().x());
     m_commandStack->setActiveStack(project->commandStack());
+    connect(project, &KdenliveDoc::undoMemoryChanged, this, &MainWindow::slotUpdateUndoMemory);
+    slotUpdateUndoMemory(project->undoMemory());
     KdenliveSettings::setProject_display_ratio(project->dar());
 
     setWindowTitle(project->description());
@@ -1849,6 +1887,14 @@ void MainWindow::slotSwitchSplitAudio()
     m_buttonAutomaticSplitAudio->setChecked(KdenliveSettings::splitaudio());
 }
 
+void MainWindow::slotAutoTimelinePreview(bool enable)
+{
+    KdenliveSettings::setAutopreview(enable);
+    if (pCore->projectManager()->currentTimeline()) {
+        pCore->projectManager()->currentTimeline()->setAutoPreview(enable);
+    }
+}
+
 void MainWindow::slotSwitchVideoThumbs()
 {
     KdenliveSettings::setVideothumbnails(!KdenliveSettings::videothumbnails());
@@ -3306,7 +3352,7 @@ void MainWindow::slotArchiveProject()
 {
     QList <ClipController*> list = pCore->binController()->getControllerList();
     pCore->binController()->saveDocumentProperties(pCore->projectManager()->current()->documentProperties(), pCore->projectManager()->currentTimeline()->projectView()->guidesData());
-    QDomDocument doc = pCore->projectManager()->current()->xmlSceneList(m_projectMonitor->sceneList());
+    QDomDocument doc = pCore->projectManager()->current()->xmlSceneList(pCore->projectManager()->projectSceneList());
     QPointer<ArchiveWidget> d = new ArchiveWidget(pCore->projectManager()->current()->url().fileName(), doc, list, pCore->projectManager()->currentTimeline()->projectView()->extractTransitionsLumas(), this);
     if (d->exec()) {
         m_messageLabel->setMessage(i18n("Archiving project"), OperationCompletedMessage);
@@ -26,6 +26,7 @@
 #include <QProgressBar>
 #include <QEvent>
 #include <QShortcut>
+#include <QFutureWatcher>
 #include <QMap>
 #include <QString>
 #include <QImage>
@@ -57,6 +58,7 @@ class RenderWidget;
 class Render;
 class Transition;
 class KIconLoader;
+class QLabel;
 
 #define EXIT_RESTART (42)
 
@@ -139,6 +141,8 @@ protected:
 
 private:
     QProgressBar *m_statusProgressBar;
+    /** @brief Fingerprint of the effect folders, computed in the background when the catalogue came from the cache. */
+    QFutureWatcher<QByteArray> m_catalogCheck;
 
     /** @brief Sets up all the actions and attaches them to the collection. */
     void setupActions();
@@ -165,6 +169,8 @@ private:
     AudioGraphSpectrum *m_audioSpectrum;
 
     QDockWidget *m_undoViewDock;
+    /** @brief Shows the memory used by the undo history below the undo view. */
+    QLabel *m_undoMemoryLabel;
 
     KSelectAction *m_timeFormatButton;
 
@@ -254,6 +260,8 @@ public slots:
     Q_SCRIPTABLE void setRenderingFinished(const QString &url, int status, const QString &error);
 
     void slotSwitchVideoThumbs();
+    /** @brief Dis/enable background rendering of the timeline zone. */
+    void slotAutoTimelinePreview(bool enable);
     void slotSwitchAudioThumbs();
 
     void slotPreferences(int page = -1, int option = -1);
@@ -263,6 +271,8 @@ public slots:
     void slotRefreshProfiles();
 
 private slots:
+    /** @brief Rebuilds the effect catalogue if the effect folders changed since it was cached. */
+    void slotCheckEffectCatalog();
     /** @brief Shows the shortcut dialog. */
     void slotEditKeys();
     void loadDockActions();
@@ -272,6 +282,7 @@ private slots:
     void slotUpdateClip(const QString &id, bool reload);
     void slotUpdateMousePosition(int pos);
     void slotUpdateProjectDuration(int pos);
+    void slotUpdateUndoMemory(qint64 bytes);
     void slotAddEffect(const QDomElement &effect);
     void slotEditProjectSettings();
 
@@ -31,8 +31,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include <QPixmap>
 #include <QFileInfo>
+#include <QAtomicInt>
 #include <KLocalizedString>
 
+// Shared by all clips, see markersRevision()
+static QAtomicInt markersRevisionCounter;
+
 
 ClipController::ClipController(BinController *bincontroller, Mlt::Producer& producer) : QObject()
     , selectedEffectIndex(1)
@@ -468,6 +472,12 @@ QList < GenTime > ClipController::snapMarkers() const
     return markers;
 }
 
+//static
+int ClipController::markersRevision()
+{
+    return markersRevisionCounter.load();
+}
+
 QList < CommentedTime > ClipController::commentedSnapMarkers() const
 {
     return m_snapMarkers;
@@ -483,6 +493,7 @@ void ClipController::loadSnapMarker(const QString &seconds, const QString &hash)
     }
     m_snapMarkers.append(marker);
     qSort(m_snapMarkers);
+    markersRevisionCounter.ref();
 }
 
 void ClipController::addSnapMarker(const CommentedTime &marker)
@@ -495,6 +506,7 @@ void ClipController::addSnapMarker(const CommentedTime &marker)
     QString markerId = clipId() + ":" + locale.toString(marker.time().seconds());
     m_binController->storeMarker(markerId, marker.hash());
     qSort(m_snapMarkers);
+    markersRevisionCounter.ref();
 }
 
 void ClipController::editSnapMarker(const GenTime & time, const QString &comment)
@@ -521,6 +533,7 @@ QString ClipController::deleteSnapMarker(const GenTime & time)
     }
     QString result = m_snapMarkers.at(ix).comment();
     m_snapMarkers.removeAt(ix);
+    markersRevisionCounter.ref();
     QLocale locale;
     QString markerId = clipId() + ":" + locale.toString(time.seconds());
     m_binController->storeMarker(markerId, QString());
@@ -650,16 +663,17 @@ EffectsList ClipController::xmlEffectList(Mlt::Profile *profile, Mlt::Service &s
     EffectsList effList(true);
     for (int ix = 0; ix < service.filter_count(); ++ix) {
         Mlt::Filter *effect = service.filter(ix);
-        QDomElement clipeffect = Timeline::getEffectByTag(effect->get("tag"), effect->get("kdenlive_id"));
+        EffectSchema schema;
+        QDomElement clipeffect = Timeline::getEffectByTag(effect->get("tag"), effect->get("kdenlive_id"), &schema);
         QDomElement currenteffect = clipeffect.cloneNode().toElement();
 	// recover effect parameters
         QDomNodeList params = currenteffect.elementsByTagName(QStringLiteral("parameter"));
 	if (effect->get_int("disable") == 1) {
 	    currenteffect.setAttribute(QStringLiteral("disable"), 1);
 	}
-        for (int i = 0; i < params.count(); ++i) {
+        for (int i = 0; i < params.count() && i < schema.count(); ++i) {
             QDomElement param = params.item(i).toElement();
-            Timeline::setParam(profileinfo, param, effect->get(param.attribute(QStringLiteral("name")).toUtf8().constData()));
+            Timeline::setParam(profileinfo, param, schema.at(i), effect->get(schema.at(i).name.toUtf8().constData()));
         }
         effList.append(currenteffect);
     }
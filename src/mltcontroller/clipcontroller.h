@@ -160,6 +160,8 @@ public:
     void addSnapMarker(const CommentedTime &marker);
     void loadSnapMarker(const QString &seconds, const QString &hash);
     QList < GenTime > snapMarkers() const;
+    /** @brief Incremented each time a marker is added or removed in any clip, so that cached snap points can be refreshed. */
+    static int markersRevision();
     QString markerComment(const GenTime &t) const;
     QStringList markerComments(const GenTime &start, const GenTime &end) const;
     CommentedTime markerAt(const GenTime &t) const;
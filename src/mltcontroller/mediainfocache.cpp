@@ -0,0 +1,205 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mediainfocache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+#include <algorithm>
+
+// Bump the version whenever the content of an entry changes
+static const quint32 indexMagic = 0x4b4d4943; // "KMIC"
+static const quint32 indexVersion = 1;
+// Least recently used entries are dropped above this count
+static const int maxEntries = 20000;
+
+MediaInfoCache::MediaInfoCache(const QString &indexFile) :
+    m_indexFile(indexFile)
+    , m_loaded(false)
+    , m_modified(false)
+{
+}
+
+MediaInfoCache::~MediaInfoCache()
+{
+    save();
+}
+
+void MediaInfoCache::load()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+    QFile file(m_indexFile);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (magic != indexMagic || version != indexVersion) {
+        qDebug() << "// Ignoring media info index from another version: " << m_indexFile;
+        return;
+    }
+    qint32 count;
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        MediaInfo info;
+        stream >> path >> info.size >> info.modified >> info.lastUse >> info.hash >> info.properties;
+        if (stream.status() == QDataStream::Ok) m_entries.insert(path, info);
+    }
+}
+
+void MediaInfoCache::save()
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_modified) return;
+    if (m_entries.count() > maxEntries) {
+        QList <QPair <qint64, QString> > order;
+        QHash <QString, MediaInfo>::const_iterator it = m_entries.constBegin();
+        for (; it != m_entries.constEnd(); ++it) {
+            order << qMakePair(it->lastUse, it.key());
+        }
+        std::sort(order.begin(), order.end());
+        for (int i = 0; i < order.count() - maxEntries; ++i) {
+            m_entries.remove(order.at(i).second);
+        }
+    }
+    QDir().mkpath(QFileInfo(m_indexFile).absolutePath());
+    QSaveFile file(m_indexFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "// Cannot write media info index: " << m_indexFile;
+        return;
+    }
+    QDataStream stream(&file);
+    stream << indexMagic << indexVersion << (qint32) m_entries.count();
+    QHash <QString, MediaInfo>::const_iterator it = m_entries.constBegin();
+    for (; it != m_entries.constEnd(); ++it) {
+        stream << it.key() << it->size << it->modified << it->lastUse << it->hash << it->properties;
+    }
+    if (file.commit()) m_modified = false;
+}
+
+MediaInfoCache::MediaInfo *MediaInfoCache::validEntry(const QString &path, qint64 size, qint64 modified)
+{
+    load();
+    QHash <QString, MediaInfo>::iterator it = m_entries.find(path);
+    if (it == m_entries.end()) return NULL;
+    if (it->size != size || it->modified != modified) {
+        // File was modified, forget everything about it
+        m_entries.erase(it);
+        m_modified = true;
+        return NULL;
+    }
+    it->lastUse = QDateTime::currentMSecsSinceEpoch() / 1000;
+    return &it.value();
+}
+
+QString MediaInfoCache::fileHash(const QString &path, qint64 *fileSize)
+{
+    QFileInfo info(path);
+    if (!info.isFile()) return QString();
+    const qint64 size = info.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if (fileSize) *fileSize = size;
+    m_mutex.lock();
+    MediaInfo *entry = validEntry(path, size, modified);
+    if (entry && !entry->hash.isEmpty()) {
+        QString hash = entry->hash;
+        m_mutex.unlock();
+        return hash;
+    }
+    m_mutex.unlock();
+
+    // Read the file outside of the lock, this is slow on network storage
+    QString hash = computeHash(path);
+    if (hash.isEmpty()) return hash;
+    QMutexLocker lock(&m_mutex);
+    entry = validEntry(path, size, modified);
+    if (entry) {
+        entry->hash = hash;
+    } else {
+        MediaInfo newEntry;
+        newEntry.size = size;
+        newEntry.modified = modified;
+        newEntry.lastUse = QDateTime::currentMSecsSinceEpoch() / 1000;
+        newEntry.hash = hash;
+        m_entries.insert(path, newEntry);
+    }
+    m_modified = true;
+    return hash;
+}
+
+stringMap MediaInfoCache::properties(const QString &path)
+{
+    QFileInfo info(path);
+    if (!info.isFile()) return stringMap();
+    QMutexLocker lock(&m_mutex);
+    MediaInfo *entry = validEntry(path, info.size(), info.lastModified().toMSecsSinceEpoch());
+    return entry ? entry->properties : stringMap();
+}
+
+void MediaInfoCache::setProperties(const QString &path, const stringMap &properties)
+{
+    QFileInfo info(path);
+    if (!info.isFile()) return;
+    const qint64 size = info.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    QMutexLocker lock(&m_mutex);
+    MediaInfo *entry = validEntry(path, size, modified);
+    if (entry) {
+        entry->properties = properties;
+    } else {
+        MediaInfo newEntry;
+        newEntry.size = size;
+        newEntry.modified = modified;
+        newEntry.lastUse = QDateTime::currentMSecsSinceEpoch() / 1000;
+        newEntry.properties = properties;
+        m_entries.insert(path, newEntry);
+    }
+    m_modified = true;
+}
+
+//static
+QString MediaInfoCache::computeHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return QString();
+    QByteArray fileData;
+    /*
+     * 1 MB = 1 second per 450 files (or faster)
+     * 10 MB = 9 seconds per 450 files (or faster)
+     */
+    if (file.size() > 2000000) {
+        fileData = file.read(1000000);
+        if (file.seek(file.size() - 1000000))
+            fileData.append(file.readAll());
+    } else
+        fileData = file.readAll();
+    file.close();
+    return QCryptographicHash::hash(fileData, QCryptographicHash::Md5).toHex();
+}
@@ -0,0 +1,83 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEDIAINFOCACHE_H
+#define MEDIAINFOCACHE_H
+
+#include "definitions.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @class MediaInfoCache
+ * @brief Persistent index of what we know about media files, shared by all projects.
+ *
+ * Entries are keyed by path and are only valid as long as the size and
+ * modification time of the file match. They store the file hash (so that
+ * large files on slow storage are not read again) and the properties found
+ * when probing the file (durations, stream layout, audio info).
+ * All methods are thread safe.
+ */
+
+class MediaInfoCache
+{
+
+public:
+    /** @param indexFile the file the index is loaded from and saved to */
+    explicit MediaInfoCache(const QString &indexFile);
+    ~MediaInfoCache();
+
+    /** @brief Returns the hash of a file, only reading the file if it is not in the index or was modified.
+     *  @param fileSize if not NULL, set to the size of the file */
+    QString fileHash(const QString &path, qint64 *fileSize = NULL);
+    /** @brief Returns the probed properties of a file, empty if unknown or modified since probed. */
+    stringMap properties(const QString &path);
+    /** @brief Store the probed properties of a file. */
+    void setProperties(const QString &path, const stringMap &properties);
+    /** @brief Write the index to disk if it was modified. */
+    void save();
+
+    /** @brief Hash of a file's content, only the first and last MB are used for large files. */
+    static QString computeHash(const QString &path);
+
+private:
+    struct MediaInfo
+    {
+        qint64 size;
+        qint64 modified;
+        /** @brief Last time the entry was used, in seconds since epoch. */
+        qint64 lastUse;
+        QString hash;
+        stringMap properties;
+    };
+    QMutex m_mutex;
+    QString m_indexFile;
+    QHash <QString, MediaInfo> m_entries;
+    bool m_loaded;
+    bool m_modified;
+    void load();
+    /** @brief Returns the entry for path if it matches the file on disk, NULL otherwise. */
+    MediaInfo *validEntry(const QString &path, qint64 size, qint64 modified);
+};
+
+#endif
@@ -27,6 +27,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QMutex>
 #include <QFuture>
+#include <QFutureSynchronizer>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QHash>
 
 class ClipController;
 class BinController;
@@ -54,23 +58,53 @@ public:
 
     /** @brief Returns the number of clips to process (When requesting clip info). */
     int processingItems();
-    /** @brief Force processing of clip with selected id. */
+    /** @brief Force processing of clip with selected id, returns once its producer is ready. */
     void forceProcessing(const QString &id);
+    /** @brief Process these clips (for example the ones displayed in the bin) before the other queued clips. */
+    void prioritize(const QStringList &ids);
     /** @brief Are we currently processing clip with selected id. */
     bool isProcessing(const QString &id);
     /** @brief Make sure to close running threads before closing document */
     void abortOperations();
 
 private:
+    enum RequestPriority {
+        NormalPriority = 0,
+        VisiblePriority = 1,
+        ForcedPriority = 2
+    };
     QMutex m_infoMutex;
+    /** @brief Signaled each time a request is processed. */
+    QWaitCondition m_infoCondition;
     QList <requestClipInfo> m_requestList;
+    /** @brief Priority of queued clips, by id (NormalPriority if not listed). */
+    QHash <QString, int> m_priorities;
     /** @brief The ids of the clips that are currently being loaded for info query */
     QStringList m_processingClipId;
-    QFuture <void> m_infoThread;
+    /** @brief Number of running workers, see KdenliveSettings::producerthreads(). */
+    int m_infoWorkers;
+    QFutureSynchronizer <void> m_infoThreads;
+    /** @brief Throughput of the current batch of requests. */
+    QElapsedTimer m_elapsed;
+    int m_processedCount;
+    int m_failedCount;
+    qint64 m_processingTime;
+    /** @brief Makes sure only one worker at a time passes its producer to the bin. */
+    QMutex m_publishMutex;
     BinController *m_binController;
     ClipType getTypeForService(const QString &id, const QString &path) const;
     /** @brief Pass xml values to an MLT producer at build time */
     void processProducerProperties(Mlt::Producer *prod, QDomElement xml);
+    /** @brief Start workers for the queued requests, m_infoMutex must be locked. */
+    void startWorkers();
+    /** @brief Remove the request with highest priority from the queue, m_infoMutex must be locked. */
+    requestClipInfo takeRequest();
+    /** @brief Returns true if the clip has a pending request, m_infoMutex must be locked. */
+    bool isQueued(const QString &id) const;
+    /** @brief Build the producer of a clip and read its properties, returns false if the clip is invalid. */
+    bool processRequest(requestClipInfo info);
+    /** @brief Create the bin thumbnail for an existing producer. */
+    bool processThumbnailRequest(const requestClipInfo &info);
 
 public slots:
       /** @brief Requests the file properties for the specified URL (will be put in a queue list)
@@ -84,7 +118,7 @@ public slots:
     void slotProcessingDone(const QString &id);
 
 private slots:
-    /** @brief Process the clip info requests (in a separate thread). */
+    /** @brief Worker processing the clip info requests (in a separate thread). */
     void processFileProperties();
     /** @brief A clip with multiple video streams was found, ask what to do. */
     void slotMultiStreamProducerFound(const QString &path, QList<int> audio_list, QList<int> video_list, stringMap data);
@@ -24,6 +24,22 @@
 #include "kdenlivesettings.h"
 
 
+#include <string.h>
+
+void AbstractRender::sendAudioSamples(const qint16 *data, int freq, int num_channels, int samples)
+{
+    audioShortVector &sampleVector = m_audioBuffers[m_audioBufferIndex];
+    m_audioBufferIndex = (m_audioBufferIndex + 1) % 3;
+    if (!sampleVector.isDetached()) {
+        // A receiver still holds this buffer, leave it the data
+        sampleVector = audioShortVector();
+    }
+    // Data format: [ c00 c10 c01 c11 c02 c12 c03 c13 ... c0{samples-1} c1{samples-1} for 2 channels.
+    // So the vector is of size samples*channels.
+    sampleVector.resize(samples * num_channels);
+    memcpy(sampleVector.data(), data, samples * num_channels * sizeof(qint16));
+    emit audioSamplesSignal(sampleVector, freq, num_channels, samples);
+}
 
 AbstractMonitor::AbstractMonitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *parent): 
     QWidget(parent),
@@ -44,7 +44,8 @@ Q_OBJECT public:
         : QObject(parent),
           sendFrameForAnalysis(false),
           analyseAudio(false),
-          m_id(name)
+          m_id(name),
+          m_audioBufferIndex(0)
     {
     }
 
@@ -62,8 +63,15 @@ Q_OBJECT public:
     /** @brief Someone needs us to send again a frame. */
     virtual void sendFrameUpdate() = 0;
 
+protected:
+    /** @brief Emits audioSamplesSignal with a copy of @param samples samples of @param num_channels interleaved channels.
+     *  The copy goes to one of a few buffers reused in turn, a buffer is only reallocated while a receiver still holds it. */
+    void sendAudioSamples(const qint16 *data, int freq, int num_channels, int samples);
+
 private:
     Kdenlive::MonitorId m_id;
+    audioShortVector m_audioBuffers[3];
+    int m_audioBufferIndex;
     
 signals:
     /** @brief The renderer refreshed the current frame. */
@@ -1424,40 +1424,35 @@ void FrameRenderer::cleanup()
     }
 }
 
-void GLWidget::setAudioThumb(int channels, QVariantList audioCache)
+void GLWidget::setAudioThumb(const AudioPeaks &audioCache)
 {
     if (rootObject()) {
         QmlAudioThumb *audioThumbDisplay = rootObject()->findChild<QmlAudioThumb *>("audiothumb");
         if (audioThumbDisplay) {
             QImage img(width(), height() / 6, QImage::Format_ARGB32_Premultiplied);
             img.fill(Qt::transparent);
-            if (!audioCache.isEmpty() && channels > 0) {
-                int audioLevelCount = audioCache.count() - 1;
+            if (!audioCache.isEmpty()) {
+                int frames = audioCache.frameCount();
                 // simplified audio
                 QPainter painter(&img);
                 QRectF mappedRect(0, 0, img.width(), img.height());
                 int channelHeight = mappedRect.height();
                 double value;
-                double scale = (double) width() / (audioLevelCount / channels);
+                double scale = (double) width() / frames;
                 if (scale < 1) {
-                    // 
+                    // Several frames per pixel, draw the peak of each pixel's frame range
                     painter.setPen(QColor(80, 80, 150, 200));
                     for (int i = 0; i < img.width(); i++) {
                         int framePos = i / scale;
-                        value = audioCache.at(qMin(framePos * channels, audioLevelCount)).toDouble() / 256;
-                        for (int channel = 1; channel < channels; channel ++) {
-                            value = qMax(value, audioCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256);
-                        }
+                        int frameEnd = qMax(framePos + 1, (int) ((i + 1) / scale));
+                        value = AudioPeaks::amplitude(audioCache.peak(framePos, frameEnd));
                         painter.drawLine(i, mappedRect.bottom() - (value * channelHeight), i, mappedRect.bottom());
                     }
                 } else {
                     QPainterPath positiveChannelPath;
                     positiveChannelPath.moveTo(0, mappedRect.bottom());
-                    for (int i = 0; i < audioLevelCount / channels; i++) {
-                        value = audioCache.at(qMin(i * channels, audioLevelCount)).toDouble() / 256;
-                        for (int channel = 1; channel < channels; channel ++) {
-                            value = qMax(value, audioCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256);
-                        }
+                    for (int i = 0; i < frames; i++) {
+                        value = AudioPeaks::amplitude(audioCache.peak(i, i + 1));
                         positiveChannelPath.lineTo(i * scale, mappedRect.bottom() - (value * channelHeight));
                     }
                     positiveChannelPath.lineTo(mappedRect.right(), mappedRect.bottom());
@@ -32,6 +32,7 @@
 
 #include "scopes/sharedframe.h"
 #include "definitions.h"
+#include "lib/audio/audioPeaks.h"
 
 class QOpenGLFunctions_3_2_Core;
 //class QmlFilter;
@@ -92,7 +93,7 @@ public:
     void lockMonitor();
     void releaseMonitor();
     int realTime() const;
-    void setAudioThumb(int channels = 0, QVariantList audioCache = QList<QVariant>());
+    void setAudioThumb(const AudioPeaks &audioCache = AudioPeaks());
     int droppedFrames() const;
     void resetDrops();
 
@@ -1943,9 +1943,9 @@ void Monitor::slotEditInlineMarker()
     }
 }
 
-void Monitor::prepareAudioThumb(int channels, QVariantList &audioCache)
+void Monitor::prepareAudioThumb(const AudioPeaks &audioCache)
 {
-    m_glMonitor->setAudioThumb(channels, audioCache);
+    m_glMonitor->setAudioThumb(audioCache);
 }
 
 void Monitor::slotUpdateQmlTimecode(const QString &tc)
@@ -27,6 +27,7 @@
 #include "timecodedisplay.h"
 #include "scopes/sharedframe.h"
 #include "effectslist/effectslist.h"
+#include "lib/audio/audioPeaks.h"
 
 #include <QLabel>
 #include <QDomElement>
@@ -144,7 +145,7 @@ public:
     QAction *recAction();
     void refreshIcons();
     /** @brief Send audio thumb data to qml for on monitor display */
-    void prepareAudioThumb(int channels, QVariantList &audioCache);
+    void prepareAudioThumb(const AudioPeaks &audioCache);
     void refreshMonitorIfActive();
     void connectAudioSpectrum(bool activate);
     /** @brief Set a property on the Qml scene **/
@@ -313,8 +313,9 @@ void AudioGraphSpectrum::refreshPixmap()
 void AudioGraphSpectrum::refreshScope(const QSize& /*size*/, bool /*full*/)
 {
     SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
+    // Every frame goes through the filter, but only the last spectrum is drawn
+    bool processed = false;
+    while (m_queue.pop(sFrame)) {
         if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
             mlt_audio_format format = mlt_audio_s16;
             int channels = sFrame.get_audio_channels();
@@ -327,9 +328,12 @@ void AudioGraphSpectrum::refreshScope(const QSize& /*size*/, bool /*full*/)
                 // There was an error processing audio from frame
                 continue;
             }
-            processSpectrum();
+            processed = true;
         }
     }
+    if (processed) {
+        processSpectrum();
+    }
 }
 
 void AudioGraphSpectrum::processSpectrum()
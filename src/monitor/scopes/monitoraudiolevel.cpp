@@ -61,8 +61,9 @@ MonitorAudioLevel::~MonitorAudioLevel()
 void MonitorAudioLevel::refreshScope(const QSize& /*size*/, bool /*full*/)
 {
     SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
+    // Keep the loudest level of the frames received since last refresh, and send it once
+    QVector<int> levels;
+    while (m_queue.pop(sFrame)) {
         if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
             mlt_audio_format format = mlt_audio_s16;
             int channels = sFrame.get_audio_channels();
@@ -75,19 +76,21 @@ void MonitorAudioLevel::refreshScope(const QSize& /*size*/, bool /*full*/)
                 // There was an error processing audio from frame
                 continue;
             }
-            QVector<int> levels;
+            if (levels.isEmpty()) {
+                levels.fill(-100, audioChannels);
+            }
             for (int i = 0; i < audioChannels; i++) {
                 QString s = QString("meta.media.audio_level.%1").arg(i);
                 double audioLevel = mFrame.get_double(s.toLatin1().constData());
-                if (audioLevel == 0.0) {
-                    levels << -100;
-                } else {
-                    levels << (int) levelToDB(audioLevel);
+                if (audioLevel != 0.0) {
+                    levels[i] = qMax(levels.at(i), (int) levelToDB(audioLevel));
                 }
             }
-            QMetaObject::invokeMethod(this, "setAudioValues", Qt::QueuedConnection, Q_ARG(const QVector<int>&, levels));
         }
     }
+    if (!levels.isEmpty()) {
+        QMetaObject::invokeMethod(this, "setAudioValues", Qt::QueuedConnection, Q_ARG(const QVector<int>&, levels));
+    }
 }
 
 void MonitorAudioLevel::resizeEvent ( QResizeEvent * event )
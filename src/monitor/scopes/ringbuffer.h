@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+  \brief Lock-free queue between one producer thread and one consumer thread
+
+  The slots are allocated once, when the buffer is created, and reused. The
+  producer only writes the head index and the consumer only writes the tail
+  index, each publishing its slot with release semantics, so neither side
+  ever blocks. Indexes wrap at twice the capacity, which tells a full buffer
+  from an empty one without overflowing. When the buffer is full push() drops
+  the new item, the producer cannot discard the oldest one without racing the
+  consumer. The consumer is expected to drain the buffer on each wake up, with
+  popLatest() if only the newest item matters.
+
+  Only one thread may push and only one thread may pop at a time. A side can
+  move to another thread provided the move is synchronised, like a job
+  started with QtConcurrent::run() after the previous one finished.
+  */
+template <class T>
+class RingBuffer
+{
+public:
+    /** @brief Creates a buffer holding up to @param size items, rounded up to a power of two. */
+    explicit RingBuffer(int size);
+
+    /** @brief Appends @param item, returns false if the buffer was full and the item dropped. Producer only. */
+    bool push(const T &item);
+
+    /** @brief Takes the oldest item into @param item, returns false if the buffer is empty. Consumer only. */
+    bool pop(T &item);
+
+    /** @brief Takes the newest item into @param item, discarding the older ones. Consumer only. */
+    bool popLatest(T &item);
+
+    /** @brief Discards all items. Consumer only. */
+    void clear();
+
+    /** @brief Returns the number of items waiting, only a hint when called from another thread. */
+    int count() const;
+
+    /** @brief Returns the maximum number of items. */
+    int capacity() const;
+
+private:
+    /** @brief Number of items between @param tail and @param head. */
+    int distance(int head, int tail) const;
+    /** @brief Index following @param index. */
+    int next(int index) const;
+
+    QVector<T> m_slots;
+    T *m_data;
+    int m_mask;
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+};
+
+template <class T>
+RingBuffer<T>::RingBuffer(int size)
+    : m_data(NULL)
+    , m_mask(0)
+    , m_head(0)
+    , m_tail(0)
+{
+    int slots = 1;
+    while (slots < size) {
+        slots <<= 1;
+    }
+    m_slots.resize(slots);
+    m_data = m_slots.data();
+    m_mask = slots - 1;
+}
+
+template <class T>
+bool RingBuffer<T>::push(const T &item)
+{
+    const int head = m_head.load();
+    if (distance(head, m_tail.loadAcquire()) > m_mask) {
+        return false;
+    }
+    m_data[head & m_mask] = item;
+    m_head.storeRelease(next(head));
+    return true;
+}
+
+template <class T>
+bool RingBuffer<T>::pop(T &item)
+{
+    const int tail = m_tail.load();
+    if (m_head.loadAcquire() == tail) {
+        return false;
+    }
+    T &slot = m_data[tail & m_mask];
+    item = slot;
+    // Release our reference now, the slot may not be reused for a while
+    slot = T();
+    m_tail.storeRelease(next(tail));
+    return true;
+}
+
+template <class T>
+bool RingBuffer<T>::popLatest(T &item)
+{
+    bool found = false;
+    while (pop(item)) {
+        found = true;
+    }
+    return found;
+}
+
+template <class T>
+void RingBuffer<T>::clear()
+{
+    T item;
+    while (pop(item)) {}
+}
+
+template <class T>
+int RingBuffer<T>::count() const
+{
+    return distance(m_head.loadAcquire(), m_tail.loadAcquire());
+}
+
+template <class T>
+int RingBuffer<T>::capacity() const
+{
+    return m_mask + 1;
+}
+
+template <class T>
+int RingBuffer<T>::distance(int head, int tail) const
+{
+    return (head - tail) & (2 * m_mask + 1);
+}
+
+template <class T>
+int RingBuffer<T>::next(int index) const
+{
+    return (index + 1) & (2 * m_mask + 1);
+}
+
+#endif
@@ -22,7 +22,7 @@
 
 ScopeWidget::ScopeWidget(QWidget *parent)
   : QWidget(parent)
-  , m_queue(3, DataQueue<SharedFrame>::OverflowModeDiscardOldest)
+  , m_queue(4)
   , m_future()
   , m_refreshPending(false)
   , m_mutex(QMutex::NonRecursive)
@@ -55,6 +55,8 @@ void ScopeWidget::requestRefresh()
 void ScopeWidget::refreshInThread()
 {
     if (m_size.isEmpty()) {
+        // Hidden scope, drop the frames so that the newest ones are kept when it is shown
+        m_queue.clear();
         return;
     }
 
@@ -26,7 +26,7 @@
 #include <QFuture>
 #include <QMutex>
 #include "sharedframe.h"
-#include "dataqueue.h"
+#include "ringbuffer.h"
 
 /*!
   \class ScopeWidget
@@ -38,8 +38,10 @@
   is the ability to trigger the "heavy lifting" to be done in a worker thread.
 
   Frames are received by the onNewFrame() slot. The ScopeWidget automatically
-  places new frames in the DataQueue (m_queue). Subclasses shall implement the
-  refreshScope() function and can check for new frames in m_queue.
+  places new frames in the RingBuffer (m_queue). Subclasses shall implement the
+  refreshScope() function and shall pop all new frames from m_queue, it is only
+  emptied there. When the queue is full, new frames are dropped until the worker
+  thread catches up.
 
   refreshScope() is run from a separate thread. Therefore, any members that are
   accessed by both the worker thread (refreshScope) and the GUI thread
@@ -106,10 +108,12 @@ protected:
     /*!
       Stores frames received by onNewFrame().
 
-      Subclasses should check this queue for new frames in the refreshScope()
-      implementation.
+      Subclasses should pop the new frames from this queue in the refreshScope()
+      implementation. It is lock-free: the GUI thread is its only producer and
+      the refresh thread its only consumer. Frames arriving while it is full
+      are dropped.
     */
-    DataQueue<SharedFrame> m_queue;
+    RingBuffer<SharedFrame> m_queue;
 
     void resizeEvent(QResizeEvent*) Q_DECL_OVERRIDE;
     void changeEvent(QEvent*) Q_DECL_OVERRIDE;
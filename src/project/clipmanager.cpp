@@ -22,6 +22,7 @@
 #include "mltcontroller/clipcontroller.h"
 #include "kdenlivesettings.h"
 #include "doc/kthumb.h"
+#include "doc/thumbnailcache.h"
 #include "doc/doccommands.h"
 #include "doc/kdenlivedoc.h"
 #include "project/projectmanager.h"
@@ -65,9 +66,7 @@ ClipManager::ClipManager(KdenliveDoc *doc) :
     m_closing(false),
     m_abortAudioThumb(false)
 {
-    KImageCache::deleteCache(QStringLiteral("kdenlive-thumbs"));
-    pixmapCache = new KImageCache(QStringLiteral("kdenlive-thumbs"), 10000000);
-    pixmapCache->setEvictionPolicy(KSharedDataCache::EvictOldest);
+    m_thumbnailCache = new ThumbnailCache;
 }
 
 ClipManager::~ClipManager()
@@ -82,7 +81,7 @@ ClipManager::~ClipManager()
     m_audioThumbsQueue.clear();
     m_thumbsMutex.unlock();
 
-    delete pixmapCache;
+    delete m_thumbnailCache;
 }
 
 void ClipManager::clear()
@@ -99,12 +98,23 @@ void ClipManager::clear()
     m_abortAudioThumb = false;
     m_folderList.clear();
     m_modifiedClips.clear();
-    pixmapCache->clear();
+    m_thumbnailCache->clear();
 }
 
 void ClipManager::clearCache()
 {
-    pixmapCache->clear();
+    m_thumbnailCache->clear();
+}
+
+ThumbnailCache *ClipManager::thumbnailCache()
+{
+    return m_thumbnailCache;
+}
+
+void ClipManager::updateThumbnailFolder()
+{
+    // The cache saves the state of the previous folder when switching
+    m_thumbnailCache->setFolder(projectFolder() + "/thumbs/cache/");
 }
 
 void ClipManager::slotRequestThumbs(const QString &id, const QList <int>& frames)
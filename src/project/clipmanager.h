@@ -29,7 +29,6 @@
 
 #include <QUrl>
 #include <KIO/CopyJob>
-#include <kimagecache.h>
 
 
 #include "gentime.h"
@@ -38,6 +37,7 @@
 
 class KdenliveDoc;
 class AbstractGroupItem;
+class ThumbnailCache;
 class QUndoCommand;
 
 class SolidVolumeInfo
@@ -88,7 +88,10 @@ Q_OBJECT public:
     /** @brief remove a clip id from the queue list. */
     void stopThumbs(const QString &id);
     void projectTreeThumbReady(const QString &id, int frame, const QImage &img, int type);
-    KImageCache* pixmapCache;
+    /** @brief Returns the persistent video thumbnail store of the project. */
+    ThumbnailCache *thumbnailCache();
+    /** @brief Points the thumbnail store to the current project folder, called when the folder is set. */
+    void updateThumbnailFolder();
 
 public slots:
     /** @brief Request creation of a clip thumbnail for specified frames. */
@@ -128,6 +131,8 @@ private:   // Private attributes
     QVector <SolidVolumeInfo> m_removableVolumes;
 
     QPoint m_projectTreeThumbSize;
+    /** @brief Video thumbnails stored in the project cache folder. */
+    ThumbnailCache *m_thumbnailCache;
 
     /** @brief Get a list of drives, to check if we have files on removable media. */
     void listRemovableVolumes();
@@ -30,10 +30,13 @@ AbstractClipJob::AbstractClipJob(JOBTYPE type, ClipType cType, const QString &id
         clipType(cType),
         jobType(type),
         replaceClip(false),
+        priority(0),
+        cost(0),
         m_jobStatus(NoJob),
         m_clipId(id),
         m_addClipToProject(false),
-        m_jobProcess(NULL)
+        m_jobProcess(NULL),
+        m_wallTime(0)
 {
 }
 
@@ -52,6 +55,16 @@ void AbstractClipJob::setAddClipToProject(bool add)
     m_addClipToProject = add;
 }
 
+qint64 AbstractClipJob::wallTime() const
+{
+    return m_wallTime;
+}
+
+void AbstractClipJob::setWallTime(qint64 time)
+{
+    m_wallTime = time;
+}
+
 void AbstractClipJob::setStatus(ClipJobStatus status)
 {
     m_jobStatus = status;
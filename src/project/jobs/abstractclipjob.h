@@ -53,6 +53,10 @@ public:
     JOBTYPE jobType;
     QString description;
     bool replaceClip;
+    /** @brief Scheduling priority, jobs with a higher priority are started first. */
+    int priority;
+    /** @brief Estimated processing cost, used to start short jobs first. */
+    double cost;
     const QString clipId() const;
     const QString errorMessage() const;
     const QString logDetails() const;
@@ -67,6 +71,9 @@ public:
     virtual bool isExclusive();
     bool addClipToProject() const;
     void setAddClipToProject(bool add);
+    /** @brief Returns the time spent processing the job, in milliseconds. */
+    qint64 wallTime() const;
+    void setWallTime(qint64 time);
     
 protected:
     ClipJobStatus m_jobStatus;
@@ -75,6 +82,7 @@ protected:
     QString m_logDetails;
     bool m_addClipToProject;
     QProcess *m_jobProcess;
+    qint64 m_wallTime;
     
 signals:
     void jobProgress(const QString&, int, int);
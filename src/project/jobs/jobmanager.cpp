@@ -36,6 +36,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDialog>
 #include <QDebug>
 #include <QtConcurrent>
+#include <QThread>
+#include <QElapsedTimer>
 
 #include <KMessageWidget>
 #include <klocalizedstring.h>
@@ -44,6 +46,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 JobManager::JobManager(Bin *bin): QObject()
   , m_bin(bin)
+  , m_workers(0)
   , m_abortAllJobs(false)
 {
     connect(this, SIGNAL(processLog(QString,int,int,QString)), this, SLOT(slotProcessLog(QString,int,int,QString)));
@@ -60,6 +63,7 @@ JobManager::~JobManager()
     m_jobThreads.clearFutures();
     if (!m_jobList.isEmpty()) qDeleteAll(m_jobList);
     m_jobList.clear();
+    m_queues.clear();
 }
 
 void JobManager::slotProcessLog(const QString &id, int progress, int type, const QString &message)
@@ -116,94 +120,203 @@ void JobManager::slotCheckJobProcess()
                 m_jobThreads.addFuture(futures.at(i));
             }
     }
+    QMutexLocker lock(&m_jobMutex);
     if (m_jobList.isEmpty()) return;
-
-    m_jobMutex.lock();
-    int count = 0;
     for (int i = 0; i < m_jobList.count(); ++i) {
-        if (m_jobList.at(i)->status() == JobWorking || m_jobList.at(i)->status() == JobWaiting)
-            count ++;
-        else {
+        if (m_jobList.at(i)->status() != JobWorking && m_jobList.at(i)->status() != JobWaiting && !m_processingJobs.contains(m_jobList.at(i))) {
             // remove finished jobs
             AbstractClipJob *job = m_jobList.takeAt(i);
+            m_queues[job->jobType].removeAll(job);
             job->deleteLater();
             --i;
         }
     }
-    emit jobCount(count);
-    m_jobMutex.unlock();
-    if (m_jobThreads.futures().isEmpty() || m_jobThreads.futures().count() < KdenliveSettings::proxythreads()) m_jobThreads.addFuture(QtConcurrent::run(this, &JobManager::slotProcessJobs));
+    emit jobCount(pendingJobs());
+    startWorkers();
 }
 
+int JobManager::maxWorkers() const
+{
+    return qBound(1, KdenliveSettings::proxythreads(), qMax(1, QThread::idealThreadCount()));
+}
 
-void JobManager::slotProcessJobs()
+void JobManager::startWorkers()
 {
-    while (!m_jobList.isEmpty() && !m_abortAllJobs) {
-        AbstractClipJob *job = NULL;
-        int count = 0;
-        m_jobMutex.lock();
-        for (int i = 0; i < m_jobList.count(); ++i) {
-            if (m_jobList.at(i)->status() == JobWaiting) {
-                if (job == NULL) {
-                    m_jobList.at(i)->setStatus(JobWorking);
-                    job = m_jobList.at(i);
-                }
-                count++;
+    if (m_abortAllJobs) return;
+    int waiting = 0;
+    QHash <int, QList <AbstractClipJob *> >::const_iterator it = m_queues.constBegin();
+    for (; it != m_queues.constEnd(); ++it) {
+        waiting += it->count();
+    }
+    int wanted = qMin(maxWorkers(), waiting);
+    while (m_workers < wanted) {
+        m_workers++;
+        m_jobThreads.addFuture(QtConcurrent::run(this, &JobManager::slotProcessJobs));
+    }
+}
+
+int JobManager::pendingJobs() const
+{
+    int count = 0;
+    for (int i = 0; i < m_jobList.count(); ++i) {
+        if (m_jobList.at(i)->status() == JobWorking || m_jobList.at(i)->status() == JobWaiting)
+            count ++;
+    }
+    return count;
+}
+
+double JobManager::typeWeight(AbstractClipJob::JOBTYPE type)
+{
+    switch (type) {
+      case AbstractClipJob::CUTJOB:
+          // Stream copy, mostly limited by disk speed
+          return 0.2;
+      case AbstractClipJob::PROXYJOB:
+      case AbstractClipJob::TRANSCODEJOB:
+          return 1;
+      case AbstractClipJob::ANALYSECLIPJOB:
+          return 0.5;
+      case AbstractClipJob::MLTJOB:
+      case AbstractClipJob::FILTERCLIPJOB:
+          // Stabilization and motion tracking analyse every frame
+          return 4;
+      default:
+          return 1;
+    }
+}
+
+int JobManager::jobPriority(AbstractClipJob *job)
+{
+    if (job->jobType == AbstractClipJob::PROXYJOB) {
+        // Clip may have been added to the timeline since the job was queued
+        ProjectClip *clip = m_bin->getBinClip(job->clipId());
+        if (clip && clip->refCount() > 0) return qMax(job->priority, (int) TimelinePriority);
+    }
+    return job->priority;
+}
+
+AbstractClipJob *JobManager::takeJob()
+{
+    const int workers = maxWorkers();
+    AbstractClipJob *best = NULL;
+    bool bestSaturated = true;
+    int bestPriority = 0;
+    QHash <int, QList <AbstractClipJob *> >::iterator it = m_queues.begin();
+    for (; it != m_queues.end(); ++it) {
+        QList <AbstractClipJob *> &queue = it.value();
+        // Find the best job of this type
+        AbstractClipJob *candidate = NULL;
+        int candidatePriority = 0;
+        for (int i = 0; i < queue.count(); ++i) {
+            AbstractClipJob *job = queue.at(i);
+            if (job->status() != JobWaiting) {
+                // Discarded job
+                queue.removeAt(i);
+                --i;
+                continue;
+            }
+            int priority = jobPriority(job);
+            if (candidate == NULL || priority > candidatePriority || (priority == candidatePriority && job->cost < candidate->cost)) {
+                candidate = job;
+                candidatePriority = priority;
             }
-            else if (m_jobList.at(i)->status() == JobWorking)
-                count ++;
         }
-        // Set jobs count
-        emit jobCount(count);
-        m_jobMutex.unlock();
+        if (candidate == NULL) continue;
+        // Keep a worker for the other job types
+        bool saturated = workers > 1 && m_runningJobs.value(it.key()) >= workers - 1;
+        if (best == NULL || (bestSaturated && !saturated) || (saturated == bestSaturated && (candidatePriority > bestPriority || (candidatePriority == bestPriority && candidate->cost < best->cost)))) {
+            best = candidate;
+            bestSaturated = saturated;
+            bestPriority = candidatePriority;
+        }
+    }
+    if (best) {
+        m_queues[best->jobType].removeOne(best);
+        best->setStatus(JobWorking);
+    }
+    return best;
+}
 
+void JobManager::slotProcessJobs()
+{
+    QElapsedTimer timer;
+    forever {
+        m_jobMutex.lock();
+        AbstractClipJob *job = m_abortAllJobs ? NULL : takeJob();
         if (job == NULL) {
+            m_workers--;
+            m_jobMutex.unlock();
             break;
         }
-        QString destination = job->destination();
-        // Check if the clip is still here
-        ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
-        //ProjectItem *processingItem = getItemById(job->clipId());
-        if (currentClip == NULL) {
-            job->setStatus(JobDone);
-            continue;
-        }
-        // Set clip status to started
-        currentClip->setJobStatus(job->jobType, job->status());
-
-        // Make sure destination path is writable
-        if (!destination.isEmpty()) {
-            QFile file(destination);
-            if (!file.open(QIODevice::WriteOnly)) {
-                emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
-                job->setStatus(JobCrashed);
-                continue;
-            }
-            file.close();
-            QFile::remove(destination);
+        m_runningJobs[job->jobType]++;
+        // The job publishes its own status, keep it alive until we are done with it
+        m_processingJobs.insert(job);
+        emit jobCount(pendingJobs());
+        m_jobMutex.unlock();
+
+        timer.start();
+        processJob(job);
+        const qint64 elapsed = timer.elapsed();
+
+        m_jobMutex.lock();
+        job->setWallTime(elapsed);
+        m_runningJobs[job->jobType]--;
+        JobStats &stats = m_jobStats[job->jobType];
+        stats.count++;
+        stats.wallTime += job->wallTime();
+        stats.cost += job->cost;
+        qDebug() << "// Job" << job->description << "on clip" << job->clipId() << "took" << job->wallTime() << "ms, estimated cost" << job->cost
+                 << "- type" << job->jobType << "average" << stats.wallTime / stats.count << "ms per job," << (stats.cost > 0 ? stats.wallTime / stats.cost : 0) << "ms per cost unit";
+        m_processingJobs.remove(job);
+        m_jobMutex.unlock();
+    }
+    // Thread finished, cleanup & update count
+    QTimer::singleShot(200, this, SIGNAL(checkJobProcess()));
+}
+
+void JobManager::processJob(AbstractClipJob *job)
+{
+    QString destination = job->destination();
+    // Check if the clip is still here
+    ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
+    //ProjectItem *processingItem = getItemById(job->clipId());
+    if (currentClip == NULL) {
+        job->setStatus(JobDone);
+        return;
+    }
+    // Set clip status to started
+    currentClip->setJobStatus(job->jobType, job->status());
+
+    // Make sure destination path is writable
+    if (!destination.isEmpty()) {
+        QFile file(destination);
+        if (!file.open(QIODevice::WriteOnly)) {
+            emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
+            job->setStatus(JobCrashed);
+            return;
         }
-        connect(job, SIGNAL(jobProgress(QString,int,int)), this, SIGNAL(processLog(QString,int,int)));
-        connect(job, SIGNAL(cancelRunningJob(QString,QMap<QString, QString>)), m_bin, SLOT(slotCancelRunningJob(QString,QMap<QString, QString>)));
+        file.close();
+        QFile::remove(destination);
+    }
+    connect(job, SIGNAL(jobProgress(QString,int,int)), this, SIGNAL(processLog(QString,int,int)));
+    connect(job, SIGNAL(cancelRunningJob(QString,QMap<QString, QString>)), m_bin, SLOT(slotCancelRunningJob(QString,QMap<QString, QString>)));
 
-        if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
-            connect(job, SIGNAL(gotFilterJobResults(QString,int,int,stringMap,stringMap)), this, SIGNAL(gotFilterJobResults(QString,int,int,stringMap,stringMap)));
+    if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
+        connect(job, SIGNAL(gotFilterJobResults(QString,int,int,stringMap,stringMap)), this, SIGNAL(gotFilterJobResults(QString,int,int,stringMap,stringMap)));
+    }
+    job->startJob();
+    if (job->status() == JobDone) {
+        emit updateJobStatus(job->clipId(), job->jobType, JobDone);
+        //TODO: replace with more generic clip replacement framework
+        if (job->jobType == AbstractClipJob::PROXYJOB) {
+            m_bin->gotProxy(job->clipId());
         }
-        job->startJob();
-        if (job->status() == JobDone) {
-            emit updateJobStatus(job->clipId(), job->jobType, JobDone);
-            //TODO: replace with more generic clip replacement framework
-            if (job->jobType == AbstractClipJob::PROXYJOB) {
-                m_bin->gotProxy(job->clipId());
-            }
-            if (job->addClipToProject()) {
-                emit addClip(destination);
-            }
-        } else if (job->status() == JobCrashed || job->status() == JobAborted) {
-            emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
+        if (job->addClipToProject()) {
+            emit addClip(destination);
         }
+    } else if (job->status() == JobCrashed || job->status() == JobAborted) {
+        emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
     }
-    // Thread finished, cleanup & update count
-    QTimer::singleShot(200, this, SIGNAL(checkJobProcess()));
 }
 
 QList <ProjectClip *> JobManager::filterClips(QList <ProjectClip *>clips, AbstractClipJob::JOBTYPE jobType, const QStringList &params)
@@ -266,7 +379,11 @@ void JobManager::launchJob(ProjectClip *clip, AbstractClipJob *job, bool runQueu
         return;
     }
 
+    job->cost = clip->duration().seconds() * typeWeight(job->jobType);
+    m_jobMutex.lock();
     m_jobList.append(job);
+    m_queues[job->jobType].append(job);
+    m_jobMutex.unlock();
     clip->setJobStatus(job->jobType, JobWaiting, 0, job->statusMessage());
     if (runQueue) slotCheckJobProcess();
 }
@@ -314,6 +431,9 @@ void JobManager::slotCancelJobs()
     */
     if (!m_jobList.isEmpty()) qDeleteAll(m_jobList);
     m_jobList.clear();
+    m_queues.clear();
+    m_runningJobs.clear();
+    m_processingJobs.clear();
     m_abortAllJobs = false;
     emit jobCount(0);
 }
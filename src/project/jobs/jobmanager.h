@@ -27,6 +27,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QMutex>
+#include <QHash>
+#include <QSet>
 #include <QFutureSynchronizer>
 
 class AbstractClipJob;
@@ -37,6 +39,11 @@ class ProjectClip;
  * @class JobManager
  * @brief This class is responsible for clip jobs management.
  *
+ * Waiting jobs are kept in one queue per job type. Each worker takes the job
+ * with the highest priority, then the cheapest one (cost is estimated from
+ * the clip duration). A job type cannot use all workers while jobs of another
+ * type are waiting, so that a long stabilization does not block short cut jobs.
+ * Proxy jobs for clips used in the timeline are started first.
  */
 
 class JobManager : public QObject
@@ -44,6 +51,11 @@ class JobManager : public QObject
     Q_OBJECT
 
 public:
+    enum JobPriority {
+        NormalPriority = 0,
+        /** @brief Proxy for a clip that is used in the timeline. */
+        TimelinePriority = 10
+    };
     explicit JobManager(Bin *bin);
     virtual ~JobManager();
 
@@ -111,12 +123,41 @@ private:
     QMutex m_jobMutex;
     /** @brief Holds a list of active jobs. */
     QList <AbstractClipJob *> m_jobList;
+    /** @brief Waiting jobs, by job type. */
+    QHash <int, QList <AbstractClipJob *> > m_queues;
+    /** @brief Number of running jobs, by job type. */
+    QHash <int, int> m_runningJobs;
+    /** @brief Jobs still used by a worker, they are not deleted even once their status says finished. */
+    QSet <AbstractClipJob *> m_processingJobs;
+    /** @brief Job count, total wall time (ms) and total estimated cost of finished jobs, by job type. */
+    struct JobStats {
+        int count;
+        qint64 wallTime;
+        double cost;
+    };
+    QHash <int, JobStats> m_jobStats;
+    /** @brief Number of workers processing the queues. */
+    int m_workers;
     /** @brief Holds the threads running a job. */
     QFutureSynchronizer<void> m_jobThreads;
     /** @brief Set to true to trigger abortion of all jobs. */
     bool m_abortAllJobs;
     /** @brief Create a proxy for a clip. */
     void createProxy(const QString &id);
+    /** @brief Maximum number of jobs running at the same time. */
+    int maxWorkers() const;
+    /** @brief Start workers for the waiting jobs, m_jobMutex must be locked. */
+    void startWorkers();
+    /** @brief Remove the next job to process from the queues, m_jobMutex must be locked. */
+    AbstractClipJob *takeJob();
+    /** @brief Returns the priority of a job, taking into account the clip's timeline usage. */
+    int jobPriority(AbstractClipJob *job);
+    /** @brief Number of waiting and running jobs, m_jobMutex must be locked. */
+    int pendingJobs() const;
+    /** @brief Runs a job in the current thread. */
+    void processJob(AbstractClipJob *job);
+    /** @brief Relative cost of processing one second of clip for a job type. */
+    static double typeWeight(AbstractClipJob::JOBTYPE type);
 
 signals:
     void addClip(const QString);
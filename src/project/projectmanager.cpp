@@ -610,6 +610,10 @@ void ProjectManager::slotStartAutoSave()
 
 void ProjectManager::slotAutoSave()
 {
+    if (!m_project->autoSaveNeeded()) {
+        // Nothing changed since last autosave
+        return;
+    }
     prepareSave();
     bool multitrackEnabled = m_trackView->multitrackView;
     if (multitrackEnabled) {
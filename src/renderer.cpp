@@ -32,6 +32,7 @@
 #include "mltcontroller/bincontroller.h"
 #include "bin/projectclip.h"
 #include "timeline/clip.h"
+#include "timeline/managers/previewmanager.h"
 #include "monitor/glwidget.h"
 #include "mltcontroller/clipcontroller.h"
 #include <mlt++/Mlt.h>
@@ -45,6 +46,7 @@
 #include <QApplication>
 #include <QProcess>
 #include <QtConcurrent>
+#include <QElapsedTimer>
 
 #include <cstdlib>
 #include <cstdarg>
@@ -413,25 +415,41 @@ void Render::startConsumer() {
 
 int Render::setSceneList(const QDomDocument &list, int position)
 {
-    return setSceneList(list.toString(), position);
+    QElapsedTimer timer;
+    timer.start();
+    // MLT must keep our profile, serialize the document without it.
+    // The element is put back so that the caller's document is unchanged
+    QDomElement root = list.documentElement();
+    QDomElement profile = root.firstChildElement(QStringLiteral("profile"));
+    QDomNode next;
+    if (!profile.isNull()) {
+        next = profile.nextSibling();
+        root.removeChild(profile);
+    }
+    QByteArray playlist = list.toByteArray();
+    if (!profile.isNull()) {
+        if (next.isNull()) root.appendChild(profile);
+        else root.insertBefore(profile, next);
+    }
+    qDebug() << "// Scene list serialized in" << timer.elapsed() << "ms," << playlist.size() / 1024 << "kB";
+    return loadSceneList(playlist, position, timer);
 }
 
 int Render::setSceneList(QString playlist, int position)
+{
+    QDomDocument doc;
+    doc.setContent(playlist);
+    return setSceneList(doc, position);
+}
+
+int Render::loadSceneList(const QByteArray &playlist, int position, QElapsedTimer &timer)
 {
     requestedSeekPosition = SEEK_INACTIVE;
     m_refreshTimer.stop();
     QMutexLocker locker(&m_mutex);
     //if (m_winid == -1) return -1;
     int error = 0;
-
-    //qDebug() << "//////  RENDER, SET SCENE LIST:\n" << playlist <<"\n..........:::.";
-
-    // Remove previous profile info
-    QDomDocument doc;
-    doc.setContent(playlist);
-    QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
-    doc.documentElement().removeChild(profile);
-    playlist = doc.toString();
+    qint64 phaseStart = timer.elapsed();
 
     if (m_mltConsumer) {
         if (!m_mltConsumer->is_stopped()) {
@@ -455,11 +473,15 @@ int Render::setSceneList(QString playlist, int position)
     blockSignals(true);
     m_locale = QLocale();
     m_locale.setNumberOptions(QLocale::OmitGroupSeparator);
-    m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-string", playlist.toUtf8().constData());
+    qDebug() << "// Previous scene closed in" << timer.elapsed() - phaseStart << "ms";
+    phaseStart = timer.elapsed();
+    m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-string", playlist.constData());
     //qDebug()<<" + + +PLAYLIST: "<<playlist;
-    //m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-nogl-string", playlist.toUtf8().constData());
+    //m_mltProducer = new Mlt::Producer(*m_qmlView->profile(), "xml-nogl-string", playlist.constData());
+    qDebug() << "// MLT playlist loaded in" << timer.elapsed() - phaseStart << "ms";
+    phaseStart = timer.elapsed();
     if (!m_mltProducer || !m_mltProducer->is_valid()) {
-        qDebug() << " WARNING - - - - -INVALID PLAYLIST: " << playlist.toUtf8().constData();
+        qDebug() << " WARNING - - - - -INVALID PLAYLIST: " << playlist.constData();
         m_mltProducer = m_blackClip->cut(0, 1);
         error = -1;
     }
@@ -503,6 +525,8 @@ int Render::setSceneList(QString playlist, int position)
     m_mltProducer->set_speed(0);
     fillSlowMotionProducers();
     emit durationChanged(m_mltProducer->get_playtime() - 1);
+    qDebug() << "// Bin and consumer set up in" << timer.elapsed() - phaseStart << "ms";
+    phaseStart = timer.elapsed();
 
     // Fill bin
     QStringList ids = m_binController->getClipIds();
@@ -523,6 +547,7 @@ int Render::setSceneList(QString playlist, int position)
         //delete original;
     }
 
+    qDebug() << "// Bin clips sent in" << timer.elapsed() - phaseStart << "ms, scene list set in" << timer.elapsed() << "ms";
     ////qDebug()<<"// SETSCN LST, POS: "<<position;
     if (position != 0) emit rendererPosition(position);
     return error;
@@ -532,9 +557,9 @@ void Render::checkMaxThreads()
 {
     // Make sure we don't use too much threads, MLT avformat does not cope with too much threads
     // Currently, Kdenlive uses the following avformat threads:
-    // One thread to get info when adding a clip
+    // KdenliveSettings::producerthreads() threads to get info when adding clips,
+    // the audio thumbnail workers are bounded by the same count
     // One thread to create the timeline video thumbnails
-    // One thread to create the audio thumbnails
     Mlt::Service service(m_mltProducer->parent().get_service());
     if (service.type() != tractor_type) {
         qWarning() << "// TRACTOR PROBLEM"<<m_mltProducer->parent().get("mlt_service");
@@ -542,7 +567,7 @@ void Render::checkMaxThreads()
     }
     Mlt::Tractor tractor(service);
     int mltMaxThreads = mlt_service_cache_get_size(service.get_service(), "producer_avformat");
-    int requestedThreads = tractor.count() + m_qmlView->realTime() + 2;
+    int requestedThreads = tractor.count() + m_qmlView->realTime() + 1 + KdenliveSettings::producerthreads();
     if (requestedThreads > mltMaxThreads) {
         mlt_service_cache_set_size(service.get_service(), "producer_avformat", requestedThreads);
         //qDebug()<<"// MLT threads updated to: "<<mlt_service_cache_get_size(service.get_service(), "producer_avformat");
@@ -1021,13 +1046,8 @@ void Render::showAudio(Mlt::Frame& frame)
         return;
     }
 
-    // Data format: [ c00 c10 c01 c11 c02 c12 c03 c13 ... c0{samples-1} c1{samples-1} for 2 channels.
-    // So the vector is of size samples*channels.
-    audioShortVector sampleVector(samples*num_channels);
-    memcpy(sampleVector.data(), data, samples*num_channels*sizeof(qint16));
-
     if (samples > 0) {
-        emit audioSamplesSignal(sampleVector, freq, num_channels, samples);
+        sendAudioSamples(data, freq, num_channels, samples);
     }
 }
 
@@ -1049,9 +1069,10 @@ void Render::mltCheckLength(Mlt::Tractor *tractor)
     }
     while (trackNb > 1) {
         QScopedPointer<Mlt::Producer> trackProducer(tractor->track(trackNb - 1));
+        trackNb--;
+        if (PreviewManager::isPreviewTrack(*trackProducer)) continue;
         int trackDuration = trackProducer->get_playtime() - 1;
         if (trackDuration > duration) duration = trackDuration;
-        trackNb--;
     }
     QScopedPointer<Mlt::Producer> blackTrackProducer(tractor->track(0));
 
@@ -1244,6 +1265,7 @@ void Render::mltInsertSpace(QMap <int, int> trackClipStartList, QMap <int, int>
     } else {
         for (int trackNb = tractor.count() - 1; trackNb >= 1; --trackNb) {
             Mlt::Producer trackProducer(tractor.track(trackNb));
+            if (PreviewManager::isPreviewTrack(trackProducer)) continue;
             Mlt::Playlist trackPlaylist((mlt_playlist) trackProducer.get_service());
 
             //int clipNb = trackPlaylist.count();
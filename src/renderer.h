@@ -56,6 +56,7 @@ class KComboBox;
 class BinController;
 class ClipController;
 class GLWidget;
+class QElapsedTimer;
 
 namespace Mlt
 {
@@ -113,8 +114,9 @@ class Render: public AbstractRender
     void seekToFrameDiff(int diff);
 
     /** @brief Sets the current MLT producer playlist.
-     * @param list The xml describing the playlist
-     * @param position (optional) time to seek to */
+     * @param list The xml describing the playlist, serialized once for MLT without its profile
+     * @param position (optional) time to seek to
+     * @return 0 when it has success, different from 0 otherwise */
     int setSceneList(const QDomDocument &list, int position = 0);
 
     /** @brief Sets the current MLT producer playlist.
@@ -122,7 +124,7 @@ class Render: public AbstractRender
      * @param position (optional) time to seek to
      * @return 0 when it has success, different from 0 otherwise
      *
-     * Creates the producer from the text playlist. */
+     * Creates the producer from the text playlist. Parses the playlist, prefer the QDomDocument version. */
     int setSceneList(QString playlist, int position = 0);
     bool updateProducer(Mlt::Producer *producer);
     bool setProducer(Mlt::Producer *producer, int position, bool isActive);
@@ -347,6 +349,9 @@ private:
     void fillSlowMotionProducers();
     /** @brief Make sure we inform MLT if we need a lot of threads for avformat producer */
     void checkMaxThreads();
+    /** @brief Creates the producer from a playlist without profile, see setSceneList().
+     *  @param timer started when the load began, used to report phase timings */
+    int loadSceneList(const QByteArray &playlist, int position, QElapsedTimer &timer);
     /** @brief Clone serialisable properties only */
     void cloneProperties(Mlt::Properties &dest, Mlt::Properties &source);
     /** @brief Get a track producer from a clip's id */
@@ -21,16 +21,28 @@
 #endif
 
 AbstractGfxScopeWidget::AbstractGfxScopeWidget(bool trackMouse, QWidget *parent) :
-        AbstractScopeWidget(trackMouse, parent)
+        AbstractScopeWidget(trackMouse, parent),
+        m_analysis(new FrameAnalysis())
 {
 }
 
 AbstractGfxScopeWidget::~AbstractGfxScopeWidget() { }
 
+float AbstractGfxScopeWidget::requiredChromaZoom() const
+{
+    return 1;
+}
+
 QImage AbstractGfxScopeWidget::renderScope(uint accelerationFactor)
 {
     QMutexLocker lock(&m_mutex);
-    return renderGfxScope(accelerationFactor, m_scopeImage);
+    const FrameAnalysis::Parts parts = requiredAnalysis();
+    const bool chroma = parts & (FrameAnalysis::ChromaYUV | FrameAnalysis::ChromaYPbPr);
+    if ((!m_analysis->contains(parts) || (chroma && m_analysis->chromaZoom != qMax(1.f, requiredChromaZoom()))) && m_analysis->width > 0) {
+        // Settings changed since the frame was analysed, ask for a new analysis
+        emit signalFrameRequest(widgetName());
+    }
+    return renderGfxScope(accelerationFactor, *m_analysis);
 }
 
 void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -43,10 +55,10 @@ void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
 ///// Slots /////
 
 
-void AbstractGfxScopeWidget::slotRenderZoneUpdated(const QImage &frame)
+void AbstractGfxScopeWidget::slotRenderZoneUpdated(const FrameAnalysisPtr &analysis)
 {
     QMutexLocker lock(&m_mutex);
-    m_scopeImage = frame;
+    m_analysis = analysis;
     AbstractScopeWidget::slotRenderZoneUpdated();
 }
 
@@ -16,6 +16,7 @@
 #include <QWidget>
 
 #include "../abstractscopewidget.h"
+#include "frameanalysis.h"
 
 
 
@@ -30,27 +31,31 @@ public:
     explicit AbstractGfxScopeWidget(bool trackMouse = false, QWidget *parent = 0);
     virtual ~AbstractGfxScopeWidget(); // Must be virtual because of inheritance, to avoid memory leaks
 
+    /** @brief Parts of the frame analysis the scope renders from with its current settings. */
+    virtual FrameAnalysis::Parts requiredAnalysis() const = 0;
+    /** @brief Zoom of the chroma grid the scope needs, see FrameAnalysis::chromaRange(). */
+    virtual float requiredChromaZoom() const;
+
 protected:
     ///// Variables /////
 
     /** @brief Scope renderer. Must emit signalScopeRenderingFinished()
         when calculation has finished, to allow multi-threading.
         accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
-    virtual QImage renderGfxScope(uint accelerationFactor, const QImage &) = 0;
+    virtual QImage renderGfxScope(uint accelerationFactor, const FrameAnalysis &) = 0;
 
     virtual QImage renderScope(uint accelerationFactor);
 
     void mouseReleaseEvent(QMouseEvent *);
 
 private:
-    QImage m_scopeImage;
+    FrameAnalysisPtr m_analysis;
     QMutex m_mutex;
 
 public slots:
-    /** @brief Must be called when the active monitor has shown a new frame.
-      This slot must be connected in the implementing class, it is *not*
-      done in this abstract class. */
-    void slotRenderZoneUpdated(const QImage &);
+    /** @brief Must be called when the active monitor has shown a new frame,
+      with the analysis of the frame shared by all scopes. This is done by the ScopeManager. */
+    void slotRenderZoneUpdated(const FrameAnalysisPtr &analysis);
 
 protected slots:
     virtual void slotAutoRefreshToggled(bool autoRefresh);
@@ -0,0 +1,259 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "frameanalysis.h"
+
+#include <string.h>
+
+const int FrameAnalysis::maxColumns = 1024;
+const int FrameAnalysis::chromaSize = 512;
+
+// Conversion from RGB (0-255) to U and V, indexed by ChromaSpace. See VectorscopeGenerator.
+static const float chromaU[2][3] = { { -0.0005781, -0.001135,  0.001713 },
+                                     { -0.0006671, -0.001299,  0.0019608 } };
+static const float chromaV[2][3] = { {  0.002411,  -0.002019, -0.0003921 },
+                                     {  0.001961,  -0.001642, -0.0003189 } };
+// Saturated red and cyan reach V = ±0.615 in YUV, Pb and Pr stay within ±0.5
+static const float chromaExtents[2] = { 0.62, 0.5 };
+
+/** What a band of columns counts in its own bins, merged when all bands are done. */
+struct BandStats {
+    uint histogram[3][256];
+    uint luma[2][256];
+    QRgb minimum;
+    QRgb maximum;
+    QVector <uint> chroma[2];
+    QVector <QRgb> colors[2];
+};
+
+FrameAnalysis::FrameAnalysis() :
+    parts(NoPart),
+    width(0),
+    height(0),
+    pixelCount(0),
+    columns(0),
+    chromaZoom(1),
+    minimum(qRgb(255, 255, 255)),
+    maximum(qRgb(0, 0, 0))
+{
+}
+
+//static
+FrameAnalysis::Part FrameAnalysis::lumaPart(ScopeKernels::Rec rec)
+{
+    return rec == ScopeKernels::Rec_601 ? Luma601 : Luma709;
+}
+
+//static
+FrameAnalysis::Part FrameAnalysis::chromaPart(ChromaSpace space)
+{
+    return space == Chroma_YUV ? ChromaYUV : ChromaYPbPr;
+}
+
+//static
+float FrameAnalysis::chromaExtent(ChromaSpace space)
+{
+    return chromaExtents[space];
+}
+
+bool FrameAnalysis::contains(Parts wanted) const
+{
+    return (parts & wanted) == wanted;
+}
+
+float FrameAnalysis::chromaRange(ChromaSpace space) const
+{
+    return chromaExtents[space] / chromaZoom;
+}
+
+//static
+FrameAnalysisPtr FrameAnalysis::analyse(const QImage &frame, Parts wanted, float chromaZoom)
+{
+    FrameAnalysis *analysis = new FrameAnalysis();
+    FrameAnalysisPtr result(analysis);
+    if (frame.width() <= 0 || frame.height() <= 0 || wanted == NoPart) {
+        return result;
+    }
+    const QImage source = ScopeKernels::rgb32(frame);
+    const int iw = source.width();
+    const int ih = source.height();
+    analysis->parts = wanted;
+    analysis->width = iw;
+    analysis->height = ih;
+    analysis->pixelCount = iw * ih;
+    analysis->columns = qMin(iw, maxColumns);
+    analysis->chromaZoom = qMax(1.f, chromaZoom);
+    const int columns = analysis->columns;
+
+    const bool doHistograms = wanted.testFlag(Histograms);
+    const bool doWaveform = wanted.testFlag(Waveform);
+    const bool doParade = wanted.testFlag(Parade);
+    const bool doColors = wanted.testFlag(ChromaColors);
+    bool doLuma[2];
+    bool doChroma[2];
+    for (int i = 0; i < 2; ++i) {
+        doLuma[i] = (doHistograms || doWaveform) && wanted.testFlag(lumaPart((ScopeKernels::Rec) i));
+        doChroma[i] = wanted.testFlag(chromaPart((ChromaSpace) i));
+        if (doLuma[i] && doHistograms) analysis->lumaHistogram[i].fill(0, 256);
+        if (doLuma[i] && doWaveform) analysis->waveform[i].fill(0, columns*256);
+        if (doChroma[i]) analysis->chroma[i].fill(0, chromaSize*chromaSize);
+        if (doChroma[i] && doColors) analysis->chromaColors[i].resize(chromaSize*chromaSize);
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (doHistograms) analysis->histogram[i].fill(0, 256);
+        if (doParade) analysis->parade[i].fill(0, columns*256);
+    }
+
+    // Chroma grid position as an affine function of r, g, b, rounded when truncated
+    const float scale = chromaSize - 1;
+    const float center = scale/2 + .5;
+    float coefficients[2][8];
+    for (int i = 0; i < 2; ++i) {
+        coefficients[i][0] = center;
+        coefficients[i][4] = center;
+        // The grid spans twice the chroma range
+        const float cellsPerUnit = scale / (2 * analysis->chromaRange((ChromaSpace) i));
+        for (int k = 0; k < 3; ++k) {
+            coefficients[i][1 + k] = cellsPerUnit * chromaU[i][k];
+            coefficients[i][5 + k] = cellsPerUnit * chromaV[i][k];
+        }
+    }
+
+    // Offset of each image column in the column data, and first image column of each data column.
+    // Bands are made of whole data columns so that they can write their column data directly.
+    QVector <int> columnOffset(iw);
+    for (int x = 0; x < iw; ++x) {
+        columnOffset[x] = (x * columns / iw) * 256;
+    }
+    QVector <int> firstPixel(columns + 1);
+    for (int c = 0; c <= columns; ++c) {
+        firstPixel[c] = (c * iw + columns - 1) / columns;
+    }
+
+    const int bands = ScopeKernels::bandCount(columns);
+    QVector <BandStats> bandStats(bands);
+    ScopeKernels::forEachBand(columns, bands, [&](int band, int firstColumn, int endColumn) {
+        BandStats &stats = bandStats[band];
+        memset(stats.histogram, 0, sizeof(stats.histogram));
+        memset(stats.luma, 0, sizeof(stats.luma));
+        stats.minimum = qRgb(255, 255, 255);
+        stats.maximum = qRgb(0, 0, 0);
+        const int x0 = firstPixel.at(firstColumn);
+        const int count = firstPixel.at(endColumn) - x0;
+        const int *offsets = columnOffset.constData() + x0;
+        for (int i = 0; i < 2; ++i) {
+            if (doChroma[i]) stats.chroma[i].fill(0, chromaSize*chromaSize);
+            if (doChroma[i] && doColors) stats.colors[i].resize(chromaSize*chromaSize);
+        }
+        uint *parade[3];
+        for (int i = 0; i < 3; ++i) {
+            parade[i] = doParade ? analysis->parade[i].data() : NULL;
+        }
+        QVector <uchar> luma(count);
+        QVector <int> xs(count);
+        QVector <int> ys(count);
+
+        for (int y = 0; y < ih; ++y) {
+            const QRgb *line = (const QRgb *) source.constScanLine(y) + x0;
+            if (doHistograms || doParade) {
+                for (int x = 0; x < count; ++x) {
+                    const QRgb col = line[x];
+                    const int r = qRed(col);
+                    const int g = qGreen(col);
+                    const int b = qBlue(col);
+                    if (doHistograms) {
+                        stats.histogram[0][r]++;
+                        stats.histogram[1][g]++;
+                        stats.histogram[2][b]++;
+                    }
+                    if (doParade) {
+                        parade[0][offsets[x] + r]++;
+                        parade[1][offsets[x] + g]++;
+                        parade[2][offsets[x] + b]++;
+                    }
+                }
+            }
+            if (doParade) {
+                ScopeKernels::minMax(line, count, stats.minimum, stats.maximum);
+            }
+            for (int i = 0; i < 2; ++i) {
+                if (!doLuma[i]) continue;
+                ScopeKernels::luma(line, count, (ScopeKernels::Rec) i, luma.data());
+                if (doHistograms) {
+                    for (int x = 0; x < count; ++x) {
+                        stats.luma[i][luma.at(x)]++;
+                    }
+                }
+                if (doWaveform) {
+                    uint *wave = analysis->waveform[i].data();
+                    for (int x = 0; x < count; ++x) {
+                        wave[offsets[x] + luma.at(x)]++;
+                    }
+                }
+            }
+            for (int i = 0; i < 2; ++i) {
+                if (!doChroma[i]) continue;
+                ScopeKernels::chromaPoints(line, count, coefficients[i], xs.data(), ys.data());
+                uint *hits = stats.chroma[i].data();
+                QRgb *colors = doColors ? stats.colors[i].data() : NULL;
+                for (int x = 0; x < count; ++x) {
+                    const int u = xs.at(x);
+                    const int v = ys.at(x);
+                    if (u < 0 || u >= chromaSize || v < 0 || v >= chromaSize) {
+                        // Outside of the zoomed range
+                        continue;
+                    }
+                    const int cell = v * chromaSize + u;
+                    hits[cell]++;
+                    if (colors) colors[cell] = line[x];
+                }
+            }
+        }
+    });
+
+    for (int band = 0; band < bands; ++band) {
+        const BandStats &stats = bandStats.at(band);
+        if (doHistograms) {
+            for (int i = 0; i < 3; ++i) {
+                uint *histogram = analysis->histogram[i].data();
+                for (int k = 0; k < 256; ++k) {
+                    histogram[k] += stats.histogram[i][k];
+                }
+            }
+            for (int i = 0; i < 2; ++i) {
+                if (!doLuma[i]) continue;
+                uint *histogram = analysis->lumaHistogram[i].data();
+                for (int k = 0; k < 256; ++k) {
+                    histogram[k] += stats.luma[i][k];
+                }
+            }
+        }
+        if (doParade) {
+            const QRgb low = analysis->minimum;
+            const QRgb high = analysis->maximum;
+            analysis->minimum = qRgb(qMin(qRed(low), qRed(stats.minimum)), qMin(qGreen(low), qGreen(stats.minimum)),
+                                     qMin(qBlue(low), qBlue(stats.minimum)));
+            analysis->maximum = qRgb(qMax(qRed(high), qRed(stats.maximum)), qMax(qGreen(high), qGreen(stats.maximum)),
+                                     qMax(qBlue(high), qBlue(stats.maximum)));
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (!doChroma[i]) continue;
+            uint *hits = analysis->chroma[i].data();
+            QRgb *colors = doColors ? analysis->chromaColors[i].data() : NULL;
+            const uint *bandHits = stats.chroma[i].constData();
+            for (int k = 0; k < chromaSize*chromaSize; ++k) {
+                if (bandHits[k] == 0) continue;
+                hits[k] += bandHits[k];
+                if (colors) colors[k] = stats.colors[i].at(k);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef FRAMEANALYSIS_H
+#define FRAMEANALYSIS_H
+
+#include "scopekernels.h"
+
+#include <QFlags>
+#include <QImage>
+#include <QSharedPointer>
+#include <QVector>
+
+class FrameAnalysis;
+typedef QSharedPointer<const FrameAnalysis> FrameAnalysisPtr;
+
+/**
+  \brief Statistics of a frame, shared by all colour scopes
+
+  The scope manager analyses each frame once, walking its pixels in a single
+  pass, and hands the result to every colour scope that is shown. Scopes tell
+  which parts they need with AbstractGfxScopeWidget::requiredAnalysis(), the
+  parts nobody asked for are not computed.
+
+  Column data is counted for at most maxColumns columns, scopes resample it
+  to their own width. Chroma is counted on a chromaSize x chromaSize grid
+  covering U and V (or Pb and Pr) from -chromaRange() to chromaRange(),
+  V growing with the row. The range is the extent of the colour space divided
+  by the zoom the vectorscope asked for, colours outside of it are not counted.
+  */
+class FrameAnalysis
+{
+public:
+    enum Part {
+        NoPart       = 0,
+        Histograms   = 1 << 0, ///< R, G, B histograms, and luma for the requested recommendations
+        Waveform     = 1 << 1, ///< Luma levels of each column for the requested recommendations
+        Parade       = 1 << 2, ///< R, G, B levels of each column and their extrema
+        ChromaYUV    = 1 << 3, ///< U/V grid
+        ChromaYPbPr  = 1 << 4, ///< Pb/Pr grid
+        ChromaColors = 1 << 5, ///< Colour of the last pixel that hit each chroma cell
+        Luma601      = 1 << 6,
+        Luma709      = 1 << 7
+    };
+    Q_DECLARE_FLAGS(Parts, Part)
+
+    enum ChromaSpace { Chroma_YUV, Chroma_YPbPr };
+
+    static const int maxColumns;
+    static const int chromaSize;
+
+    /** @brief Creates an empty analysis, with no part computed. */
+    FrameAnalysis();
+
+    /** @brief Analyses @param frame in one pass over its pixels, computing @param parts.
+     *  @param chromaZoom divides the U/V range covered by the chroma grid, for a finer grid when zoomed in */
+    static FrameAnalysisPtr analyse(const QImage &frame, Parts parts, float chromaZoom = 1);
+
+    /** @brief Returns the luma part for @param rec. */
+    static Part lumaPart(ScopeKernels::Rec rec);
+    /** @brief Returns the chroma part for @param space. */
+    static Part chromaPart(ChromaSpace space);
+    /** @brief Returns the largest U or V value of an RGB colour in @param space, which the chroma grid covers. */
+    static float chromaExtent(ChromaSpace space);
+
+    /** @brief Returns true if all of @param parts were computed. */
+    bool contains(Parts parts) const;
+    /** @brief Returns the largest U or V value counted on the chroma grid of @param space. */
+    float chromaRange(ChromaSpace space) const;
+
+    Parts parts;
+    int width;
+    int height;
+    /** @brief Number of image pixels counted in each histogram. */
+    int pixelCount;
+    /** @brief Number of columns of the waveform and parade data. */
+    int columns;
+    /** @brief Zoom of the chroma grid, see chromaRange(). */
+    float chromaZoom;
+
+    /** @brief Histograms of the R, G, B components, 256 values each. */
+    QVector <uint> histogram[3];
+    /** @brief Luma histograms, indexed by ScopeKernels::Rec. */
+    QVector <uint> lumaHistogram[2];
+    /** @brief Luma levels, waveform[rec][column*256 + luma]. */
+    QVector <uint> waveform[2];
+    /** @brief Component levels, parade[component][column*256 + value] with R, G, B components. */
+    QVector <uint> parade[3];
+    QRgb minimum;
+    QRgb maximum;
+    /** @brief Chroma hits, chroma[space][v*chromaSize + u]. */
+    QVector <uint> chroma[2];
+    QVector <QRgb> chromaColors[2];
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(FrameAnalysis::Parts)
+
+#endif
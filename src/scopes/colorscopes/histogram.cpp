@@ -97,6 +97,15 @@ QString Histogram::widgetName() const
     return QStringLiteral("Histogram");
 }
 
+FrameAnalysis::Parts Histogram::requiredAnalysis() const
+{
+    FrameAnalysis::Parts parts = FrameAnalysis::Histograms;
+    if (ui->cbY->isChecked()) {
+        parts |= FrameAnalysis::lumaPart(m_aRec601->isChecked() ? ScopeKernels::Rec_601 : ScopeKernels::Rec_709);
+    }
+    return parts;
+}
+
 bool Histogram::isHUDDependingOnInput() const { return false; }
 bool Histogram::isScopeDependingOnInput() const { return true; }
 bool Histogram::isBackgroundDependingOnInput() const { return false; }
@@ -113,7 +122,7 @@ QImage Histogram::renderHUD(uint)
     emit signalHUDRenderingFinished(0, 1);
     return QImage();
 }
-QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Histogram::renderGfxScope(uint accelFactor, const FrameAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     start.start();
@@ -125,8 +134,8 @@ QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
 
     HistogramGenerator::Rec rec = m_aRec601->isChecked() ? HistogramGenerator::Rec_601 : HistogramGenerator::Rec_709;
 
-    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), qimage, componentFlags,
-                                                                rec, m_aUnscaled->isChecked(), accelFactor);
+    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), analysis, componentFlags,
+                                                                rec, m_aUnscaled->isChecked());
 
     emit signalScopeRenderingFinished(start.elapsed(), accelFactor);
     return histogram;
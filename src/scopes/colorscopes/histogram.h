@@ -26,6 +26,7 @@ public:
     explicit Histogram(QWidget *parent = 0);
     ~Histogram();
     QString widgetName() const;
+    FrameAnalysis::Parts requiredAnalysis() const;
 
 protected:
     virtual void readConfig();
@@ -43,7 +44,7 @@ private:
     bool isScopeDependingOnInput() const;
     bool isBackgroundDependingOnInput() const;
     QImage renderHUD(uint accelerationFactor);
-    QImage renderGfxScope(uint accelerationFactor, const QImage &);
+    QImage renderGfxScope(uint accelerationFactor, const FrameAnalysis &analysis);
     QImage renderBackground(uint accelerationFactor);
     Ui::Histogram_UI *ui;
 
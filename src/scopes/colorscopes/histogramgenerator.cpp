@@ -9,25 +9,29 @@
  ***************************************************************************/
 
 #include "histogramgenerator.h"
+#include "frameanalysis.h"
 
 #include <algorithm>
 #include <math.h>
 #include <QImage>
 #include <QPainter>
+#include <QVector>
 #include "klocalizedstring.h"
 
 HistogramGenerator::HistogramGenerator()
 {
 }
 
-QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components,
-                                              HistogramGenerator::Rec rec, bool unscaled, uint accelFactor) const
+QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const FrameAnalysis &analysis, const int &components,
+                                              HistogramGenerator::Rec rec, bool unscaled) const
 {
-    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    const ScopeKernels::Rec lumaRec = rec == HistogramGenerator::Rec_601 ? ScopeKernels::Rec_601 : ScopeKernels::Rec_709;
+    const QVector <uint> &luma = analysis.lumaHistogram[lumaRec];
+    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || analysis.histogram[0].isEmpty()) {
         return QImage();
     }
 
-    bool drawY = (components & HistogramGenerator::ComponentY) != 0;
+    bool drawY = (components & HistogramGenerator::ComponentY) != 0 && !luma.isEmpty();
     bool drawR = (components & HistogramGenerator::ComponentR) != 0;
     bool drawG = (components & HistogramGenerator::ComponentG) != 0;
     bool drawB = (components & HistogramGenerator::ComponentB) != 0;
@@ -35,39 +39,24 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QIm
 
     int r[256], g[256], b[256], y[256], s[766];
     // Initialize the values to zero
-    std::fill(r, r+256, 0);
-    std::fill(g, g+256, 0);
-    std::fill(b, b+256, 0);
     std::fill(y, y+256, 0);
     std::fill(s, s+766, 0);
 
-    const uint iw = image.bytesPerLine();
-    const uint ih = image.height();
     const uint ww = paradeSize.width();
     const uint wh = paradeSize.height();
-    const uint byteCount = iw*ih;
-
-    // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += accelFactor) {
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
-            if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == HistogramGenerator::Rec_601) {
-                    y[(int)floor(.299*qRed(col) + .587*qGreen(col) + .114*qBlue(col))]++;
-                } else {
-                    y[(int)floor(.2125*qRed(col) + .7154*qGreen(col) + .0721*qBlue(col))]++;
-                }
-            }
-            if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
-            }
+    const uint byteCount = analysis.pixelCount*4;
+
+    // Read the stats from the frame analysis
+    for (int i = 0; i < 256; ++i) {
+        r[i] = analysis.histogram[0].at(i);
+        g[i] = analysis.histogram[1].at(i);
+        b[i] = analysis.histogram[2].at(i);
+        if (drawY) y[i] = luma.at(i);
+    }
+    if (drawSum) {
+        // Each component value is counted once per channel
+        for (int i = 0; i < 256; ++i) {
+            s[i] = r[i] + g[i] + b[i];
         }
     }
 
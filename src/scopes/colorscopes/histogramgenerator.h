@@ -13,6 +13,7 @@
 
 #include <QObject>
 
+class FrameAnalysis;
 class QColor;
 class QImage;
 class QPainter;
@@ -30,11 +31,11 @@ public:
     enum Rec { Rec_601, Rec_709 };
 
     /**
-        Calculates a histogram display from the input image.
+        Calculates a histogram display from the frame analysis.
         components are OR-ed HistogramGenerator::Components flags and decide with components (Y, R, G, B) to paint.
         unscaled = true leaves the width at 256 if the widget is wider (to avoid scaling). */
-    QImage calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components, const HistogramGenerator::Rec rec,
-                              bool unscaled, uint accelFactor = 1) const;
+    QImage calculateHistogram(const QSize &paradeSize, const FrameAnalysis &analysis, const int &components, const HistogramGenerator::Rec rec,
+                              bool unscaled) const;
 
     QImage drawComponent(const int *y, const QSize &size, const float &scaling, const QColor &color, bool unscaled, uint max) const;
 
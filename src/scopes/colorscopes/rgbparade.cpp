@@ -79,6 +79,7 @@ void RGBParade::writeConfig()
 
 
 QString RGBParade::widgetName() const { return QStringLiteral("RGB Parade"); }
+FrameAnalysis::Parts RGBParade::requiredAnalysis() const { return FrameAnalysis::Parade; }
 
 QRect RGBParade::scopeRect()
 {
@@ -124,14 +125,14 @@ QImage RGBParade::renderHUD(uint)
     return hud;
 }
 
-QImage RGBParade::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage RGBParade::renderGfxScope(uint accelerationFactor, const FrameAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     int paintmode = ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
-    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), qimage, (RGBParadeGenerator::PaintMode) paintmode,
-                                                    m_aAxis->isChecked(), m_aGradRef->isChecked(), accelerationFactor);
+    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), analysis, (RGBParadeGenerator::PaintMode) paintmode,
+                                                    m_aAxis->isChecked(), m_aGradRef->isChecked());
     emit signalScopeRenderingFinished(start.elapsed(), accelerationFactor);
     return parade;
 }
@@ -28,6 +28,7 @@ public:
     explicit RGBParade(QWidget *parent = 0);
     ~RGBParade();
     QString widgetName() const;
+    FrameAnalysis::Parts requiredAnalysis() const;
 
 protected:
     virtual void readConfig();
@@ -46,7 +47,7 @@ private:
     bool isBackgroundDependingOnInput() const;
 
     QImage renderHUD(uint accelerationFactor);
-    QImage renderGfxScope(uint accelerationFactor, const QImage &);
+    QImage renderGfxScope(uint accelerationFactor, const FrameAnalysis &analysis);
     QImage renderBackground(uint accelerationFactor);
 };
 
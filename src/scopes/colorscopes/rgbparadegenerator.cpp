@@ -9,9 +9,11 @@
  ***************************************************************************/
 
 #include "rgbparadegenerator.h"
+#include "frameanalysis.h"
 #include "klocalizedstring.h"
 #include <QColor>
 #include <QPainter>
+#include <QVector>
 
 #define CHOP255(a) ((255) < (a) ? (255) : (a))
 #define CHOP1255(a) ((a) < (1) ? (1) : ((a) > (255) ? (255) : (a)))
@@ -34,13 +36,12 @@ RGBParadeGenerator::RGBParadeGenerator()
 {
 }
 
-QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QImage &image,
+QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const FrameAnalysis &analysis,
                                               const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
-                                              bool drawGradientRef, uint accelFactor)
+                                              bool drawGradientRef)
 {
-    Q_ASSERT(accelFactor >= 1);
-
-    if (paradeSize.width() <= 0 || paradeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    const uchar offset = 10;
+    if (paradeSize.width() <= 2*offset + distRight + 3 || paradeSize.height() <= distBottom || analysis.parade[0].isEmpty()) {
         return QImage();
 
     } else {
@@ -51,88 +52,59 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
 
         const uint ww = paradeSize.width();
         const uint wh = paradeSize.height();
-        const uint iw = image.bytesPerLine();
-        const uint ih = image.height();
-        const uint byteCount = iw*ih;   // Note that 1 px = 4 B
+        const uint columns = analysis.columns;
 
-        const uchar offset = 10;
         const uint partW = (ww - 2*offset - distRight) / 3;
         const uint partH = wh - distBottom;
 
-        // Statistics
-        uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0, r, g, b;
-
-
-        // Number of input pixels that will fall on one scope pixel.
-        // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-        const float pixelDepth = (float)((byteCount>>2) / accelFactor)/(partW*255);
-        const float gain = 255/(8*pixelDepth);
-//        qDebug() << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
-
         QImage unscaled(ww-distRight, 256, QImage::Format_ARGB32);
         unscaled.fill(qRgba(0, 0, 0, 0));
 
-        const float wPrediv = (float)(partW-1)/(iw-1);
-
-        StructRGB paradeVals[partW][256];
+        // Resample the analysed columns to the part width, paradeVals[x][v] is at x*256 + v.
+        // If the part is wider than the analysis, columns are repeated.
+        StructRGB zero = { 0, 0, 0 };
+        QVector <StructRGB> paradeVals(partW*256, zero);
+        quint64 total = 0;
         for (uint i = 0; i < partW; ++i) {
-            for (uint j = 0; j < 256; ++j) {
-                paradeVals[i][j].r = 0;
-                paradeVals[i][j].g = 0;
-                paradeVals[i][j].b = 0;
+            const uint first = (quint64) i*columns/partW;
+            const uint end = qMax(first + 1, (uint) ((quint64) (i+1)*columns/partW));
+            StructRGB *vals = paradeVals.data() + i*256;
+            for (uint c = first; c < end; ++c) {
+                const uint *r = analysis.parade[0].constData() + c*256;
+                const uint *g = analysis.parade[1].constData() + c*256;
+                const uint *b = analysis.parade[2].constData() + c*256;
+                for (int v = 0; v < 256; ++v) {
+                    vals[v].r += r[v];
+                    vals[v].g += g[v];
+                    vals[v].b += b[v];
+                    total += r[v];
+                }
             }
         }
 
-        const uchar *bits = image.bits();
-        const uint stepsize = image.depth() / 8 *accelFactor;
-
-        for (uint i = 0, x = 0; i < byteCount; i += stepsize) {
-            QRgb *col = (QRgb *)bits;
-            r = qRed(*col);
-            g = qGreen(*col);
-            b = qBlue(*col);
-
-            double dx = x*wPrediv;
-
-            paradeVals[(int)dx][r].r++;
-            paradeVals[(int)dx][g].g++;
-            paradeVals[(int)dx][b].b++;
-
-
-            if (r < minR) { minR = r; }
-            if (g < minG) { minG = g; }
-            if (b < minB) { minB = b; }
-            if (r > maxR) { maxR = r; }
-            if (g > maxG) { maxG = g; }
-            if (b > maxB) { maxB = b; }
-
-            bits += stepsize;
-            x += stepsize;
-            x %= iw; // Modulo image width, to represent the current x position in the image
-        }
+        // Number of input pixels that will fall on one scope pixel.
+        // Must be a float because it can be <1 expected px per px.
+        const float pixelDepth = qMax((float) total/(partW*255), (float) 1e-3);
+        const float gain = 255/(8*pixelDepth);
+//        qDebug() << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain;
 
+        // Statistics
+        const uchar minR = qRed(analysis.minimum), minG = qGreen(analysis.minimum), minB = qBlue(analysis.minimum);
+        const uchar maxR = qRed(analysis.maximum), maxG = qGreen(analysis.maximum), maxB = qBlue(analysis.maximum);
 
         const uint offset1 = partW + offset;
         const uint offset2 = 2*partW + 2*offset;
-        switch(paintMode) {
-        case PaintMode_RGB:
+        const QRgb colR = paintMode == PaintMode_RGB ? qRgb(255,10,10) : qRgb(255,255,255);
+        const QRgb colG = paintMode == PaintMode_RGB ? qRgb(10,255,10) : qRgb(255,255,255);
+        const QRgb colB = paintMode == PaintMode_RGB ? qRgb(10,10,255) : qRgb(255,255,255);
+        for (uint j = 0; j < 256; ++j) {
+            QRgb *line = (QRgb *) unscaled.scanLine(j);
             for (uint i = 0; i < partW; ++i) {
-                for (uint j = 0; j < 256; ++j) {
-                    unscaled.setPixel(i,         j, qRgba(255,10,10, CHOP255(gain*paradeVals[i][j].r)));
-                    unscaled.setPixel(i+offset1, j, qRgba(10,255,10, CHOP255(gain*paradeVals[i][j].g)));
-                    unscaled.setPixel(i+offset2, j, qRgba(10,10,255, CHOP255(gain*paradeVals[i][j].b)));
-                }
-            }
-            break;
-        default:
-            for (uint i = 0; i < partW; ++i) {
-                for (uint j = 0; j < 256; ++j) {
-                    unscaled.setPixel(i,         j, qRgba(255,255,255, CHOP255(gain*paradeVals[i][j].r)));
-                    unscaled.setPixel(i+offset1, j, qRgba(255,255,255, CHOP255(gain*paradeVals[i][j].g)));
-                    unscaled.setPixel(i+offset2, j, qRgba(255,255,255, CHOP255(gain*paradeVals[i][j].b)));
-                }
+                const StructRGB &vals = paradeVals.at(i*256 + j);
+                line[i]         = (colR & RGB_MASK) | (CHOP255((uint)(gain*vals.r)) << 24);
+                line[i+offset1] = (colG & RGB_MASK) | (CHOP255((uint)(gain*vals.g)) << 24);
+                line[i+offset2] = (colB & RGB_MASK) | (CHOP255((uint)(gain*vals.b)) << 24);
             }
-            break;
         }
 
         // Scale the image to the target height. Scaling is not accomplished before because
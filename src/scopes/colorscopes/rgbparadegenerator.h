@@ -13,6 +13,7 @@
 
 #include <QObject>
 
+class FrameAnalysis;
 class QColor;
 class QImage;
 class QSize;
@@ -23,8 +24,8 @@ public:
     enum PaintMode { PaintMode_RGB, PaintMode_White };
 
     RGBParadeGenerator();
-    QImage calculateRGBParade(const QSize &paradeSize, const QImage &image, const RGBParadeGenerator::PaintMode paintMode,
-                              bool drawAxis, bool drawGradientRef, uint accelFactor = 1);
+    QImage calculateRGBParade(const QSize &paradeSize, const FrameAnalysis &analysis, const RGBParadeGenerator::PaintMode paintMode,
+                              bool drawAxis, bool drawGradientRef);
 
     static const QColor colHighlight;
     static const QColor colLight;
@@ -0,0 +1,293 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "scopekernels.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCOPEKERNELS_X86
+#include <immintrin.h>
+#define TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// Luma weights scaled to 2^15 (B, G, R), they sum to 32768 so that white gives 255
+static const short weights601[3] = { 3735, 19235, 9798 };
+static const short weights709[3] = { 2363, 23442, 6963 };
+// Rows below which splitting in bands costs more than it saves
+static const int minBandRows = 64;
+
+typedef void (*LumaFunction)(const QRgb *, int, const short *, uchar *);
+typedef void (*ChromaFunction)(const QRgb *, int, const float *, int *, int *);
+typedef void (*MinMaxFunction)(const QRgb *, int, QRgb &, QRgb &);
+
+static void lumaScalar(const QRgb *pixels, int count, const short *w, uchar *out)
+{
+    for (int i = 0; i < count; ++i) {
+        const QRgb px = pixels[i];
+        out[i] = (w[0] * qBlue(px) + w[1] * qGreen(px) + w[2] * qRed(px)) >> 15;
+    }
+}
+
+static void chromaScalar(const QRgb *pixels, int count, const float *c, int *x, int *y)
+{
+    for (int i = 0; i < count; ++i) {
+        const float r = qRed(pixels[i]);
+        const float g = qGreen(pixels[i]);
+        const float b = qBlue(pixels[i]);
+        x[i] = (int) (c[0] + c[1] * r + c[2] * g + c[3] * b);
+        y[i] = (int) (c[4] + c[5] * r + c[6] * g + c[7] * b);
+    }
+}
+
+static void minMaxScalar(const QRgb *pixels, int count, QRgb &minimum, QRgb &maximum)
+{
+    int minR = qRed(minimum), minG = qGreen(minimum), minB = qBlue(minimum);
+    int maxR = qRed(maximum), maxG = qGreen(maximum), maxB = qBlue(maximum);
+    for (int i = 0; i < count; ++i) {
+        const QRgb px = pixels[i];
+        minR = qMin(minR, qRed(px));
+        minG = qMin(minG, qGreen(px));
+        minB = qMin(minB, qBlue(px));
+        maxR = qMax(maxR, qRed(px));
+        maxG = qMax(maxG, qGreen(px));
+        maxB = qMax(maxB, qBlue(px));
+    }
+    minimum = qRgb(minR, minG, minB);
+    maximum = qRgb(maxR, maxG, maxB);
+}
+
+#ifdef SCOPEKERNELS_X86
+
+/** Luma of 4 pixels as 32 bit integers. */
+TARGET("sse2") static inline __m128i lumaSse2x4(__m128i px, __m128i weights, __m128i zero)
+{
+    // Pixels are stored B, G, R, A: madd gives (B*wb + G*wg, R*wr) for each pixel
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights);
+    lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+    hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+    lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 3, 2, 0));
+    hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 3, 2, 0));
+    return _mm_srli_epi32(_mm_unpacklo_epi64(lo, hi), 15);
+}
+
+TARGET("sse2") static void lumaSse2(const QRgb *pixels, int count, const short *w, uchar *out)
+{
+    const __m128i weights = _mm_setr_epi16(w[0], w[1], w[2], 0, w[0], w[1], w[2], 0);
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = lumaSse2x4(_mm_loadu_si128((const __m128i *) (pixels + i)), weights, zero);
+        const __m128i b = lumaSse2x4(_mm_loadu_si128((const __m128i *) (pixels + i + 4)), weights, zero);
+        const __m128i y16 = _mm_packs_epi32(a, b);
+        _mm_storel_epi64((__m128i *) (out + i), _mm_packus_epi16(y16, y16));
+    }
+    lumaScalar(pixels + i, count - i, w, out + i);
+}
+
+TARGET("avx2") static inline __m256i lumaAvx2x8(__m256i px, __m256i weights, __m256i zero)
+{
+    // Same as the SSE2 version in each 128 bit lane: pixels 0-3 and 4-7
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(px, zero), weights);
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(px, zero), weights);
+    lo = _mm256_add_epi32(lo, _mm256_srli_epi64(lo, 32));
+    hi = _mm256_add_epi32(hi, _mm256_srli_epi64(hi, 32));
+    lo = _mm256_shuffle_epi32(lo, _MM_SHUFFLE(3, 3, 2, 0));
+    hi = _mm256_shuffle_epi32(hi, _MM_SHUFFLE(3, 3, 2, 0));
+    return _mm256_srli_epi32(_mm256_unpacklo_epi64(lo, hi), 15);
+}
+
+TARGET("avx2") static void lumaAvx2(const QRgb *pixels, int count, const short *w, uchar *out)
+{
+    const __m256i weights = _mm256_setr_epi16(w[0], w[1], w[2], 0, w[0], w[1], w[2], 0,
+                                              w[0], w[1], w[2], 0, w[0], w[1], w[2], 0);
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = lumaAvx2x8(_mm256_loadu_si256((const __m256i *) (pixels + i)), weights, zero);
+        const __m256i b = lumaAvx2x8(_mm256_loadu_si256((const __m256i *) (pixels + i + 8)), weights, zero);
+        // Packing works per lane, reorder the 64 bit blocks after each step
+        const __m256i y16 = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256i y8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(y16, y16), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *) (out + i), _mm256_castsi256_si128(y8));
+    }
+    lumaSse2(pixels + i, count - i, w, out + i);
+}
+
+TARGET("sse2") static void chromaSse2(const QRgb *pixels, int count, const float *c, int *x, int *y)
+{
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128 x0 = _mm_set1_ps(c[0]), xr = _mm_set1_ps(c[1]), xg = _mm_set1_ps(c[2]), xb = _mm_set1_ps(c[3]);
+    const __m128 y0 = _mm_set1_ps(c[4]), yr = _mm_set1_ps(c[5]), yg = _mm_set1_ps(c[6]), yb = _mm_set1_ps(c[7]);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i px = _mm_loadu_si128((const __m128i *) (pixels + i));
+        const __m128 r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), mask));
+        const __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), mask));
+        const __m128 b = _mm_cvtepi32_ps(_mm_and_si128(px, mask));
+        const __m128 fx = _mm_add_ps(_mm_add_ps(x0, _mm_mul_ps(xr, r)), _mm_add_ps(_mm_mul_ps(xg, g), _mm_mul_ps(xb, b)));
+        const __m128 fy = _mm_add_ps(_mm_add_ps(y0, _mm_mul_ps(yr, r)), _mm_add_ps(_mm_mul_ps(yg, g), _mm_mul_ps(yb, b)));
+        _mm_storeu_si128((__m128i *) (x + i), _mm_cvttps_epi32(fx));
+        _mm_storeu_si128((__m128i *) (y + i), _mm_cvttps_epi32(fy));
+    }
+    chromaScalar(pixels + i, count - i, c, x + i, y + i);
+}
+
+TARGET("avx2") static void chromaAvx2(const QRgb *pixels, int count, const float *c, int *x, int *y)
+{
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    const __m256 x0 = _mm256_set1_ps(c[0]), xr = _mm256_set1_ps(c[1]), xg = _mm256_set1_ps(c[2]), xb = _mm256_set1_ps(c[3]);
+    const __m256 y0 = _mm256_set1_ps(c[4]), yr = _mm256_set1_ps(c[5]), yg = _mm256_set1_ps(c[6]), yb = _mm256_set1_ps(c[7]);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i px = _mm256_loadu_si256((const __m256i *) (pixels + i));
+        const __m256 r = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(px, 16), mask));
+        const __m256 g = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(px, 8), mask));
+        const __m256 b = _mm256_cvtepi32_ps(_mm256_and_si256(px, mask));
+        const __m256 fx = _mm256_add_ps(_mm256_add_ps(x0, _mm256_mul_ps(xr, r)), _mm256_add_ps(_mm256_mul_ps(xg, g), _mm256_mul_ps(xb, b)));
+        const __m256 fy = _mm256_add_ps(_mm256_add_ps(y0, _mm256_mul_ps(yr, r)), _mm256_add_ps(_mm256_mul_ps(yg, g), _mm256_mul_ps(yb, b)));
+        _mm256_storeu_si256((__m256i *) (x + i), _mm256_cvttps_epi32(fx));
+        _mm256_storeu_si256((__m256i *) (y + i), _mm256_cvttps_epi32(fy));
+    }
+    chromaSse2(pixels + i, count - i, c, x + i, y + i);
+}
+
+TARGET("sse2") static void minMaxSse2(const QRgb *pixels, int count, QRgb &minimum, QRgb &maximum)
+{
+    // Byte-wise min / max keeps each component separate
+    __m128i low = _mm_set1_epi32(minimum);
+    __m128i high = _mm_set1_epi32(maximum);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i px = _mm_loadu_si128((const __m128i *) (pixels + i));
+        low = _mm_min_epu8(low, px);
+        high = _mm_max_epu8(high, px);
+    }
+    QRgb lows[4];
+    QRgb highs[4];
+    _mm_storeu_si128((__m128i *) lows, low);
+    _mm_storeu_si128((__m128i *) highs, high);
+    minMaxScalar(lows, 4, minimum, maximum);
+    minMaxScalar(highs, 4, minimum, maximum);
+    minMaxScalar(pixels + i, count - i, minimum, maximum);
+}
+
+TARGET("avx2") static void minMaxAvx2(const QRgb *pixels, int count, QRgb &minimum, QRgb &maximum)
+{
+    __m256i low = _mm256_set1_epi32(minimum);
+    __m256i high = _mm256_set1_epi32(maximum);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i px = _mm256_loadu_si256((const __m256i *) (pixels + i));
+        low = _mm256_min_epu8(low, px);
+        high = _mm256_max_epu8(high, px);
+    }
+    QRgb lows[8];
+    QRgb highs[8];
+    _mm256_storeu_si256((__m256i *) lows, low);
+    _mm256_storeu_si256((__m256i *) highs, high);
+    minMaxScalar(lows, 8, minimum, maximum);
+    minMaxScalar(highs, 8, minimum, maximum);
+    minMaxScalar(pixels + i, count - i, minimum, maximum);
+}
+
+#endif
+
+struct Kernels
+{
+    LumaFunction luma;
+    ChromaFunction chroma;
+    MinMaxFunction minMax;
+    const char *name;
+};
+
+static Kernels selectKernels()
+{
+    Kernels kernels = { lumaScalar, chromaScalar, minMaxScalar, "scalar" };
+#ifdef SCOPEKERNELS_X86
+    const QByteArray forced = qgetenv("KDENLIVE_SCOPE_KERNELS");
+    __builtin_cpu_init();
+    if ((forced.isEmpty() || forced == "avx2") && __builtin_cpu_supports("avx2")) {
+        Kernels avx2 = { lumaAvx2, chromaAvx2, minMaxAvx2, "avx2" };
+        kernels = avx2;
+    } else if ((forced.isEmpty() || forced == "avx2" || forced == "sse2") && __builtin_cpu_supports("sse2")) {
+        Kernels sse2 = { lumaSse2, chromaSse2, minMaxSse2, "sse2" };
+        kernels = sse2;
+    }
+#endif
+    return kernels;
+}
+
+static const Kernels &kernels()
+{
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+QImage ScopeKernels::rgb32(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return image;
+    default:
+        return image.convertToFormat(QImage::Format_RGB32);
+    }
+}
+
+void ScopeKernels::luma(const QRgb *pixels, int count, Rec rec, uchar *out)
+{
+    kernels().luma(pixels, count, rec == Rec_601 ? weights601 : weights709, out);
+}
+
+void ScopeKernels::chromaPoints(const QRgb *pixels, int count, const float *c, int *x, int *y)
+{
+    kernels().chroma(pixels, count, c, x, y);
+}
+
+void ScopeKernels::minMax(const QRgb *pixels, int count, QRgb &minimum, QRgb &maximum)
+{
+    kernels().minMax(pixels, count, minimum, maximum);
+}
+
+int ScopeKernels::bandCount(int rows)
+{
+    return qBound(1, rows / minBandRows, qMax(1, QThread::idealThreadCount()));
+}
+
+void ScopeKernels::forEachBand(int rows, int bands, const std::function<void (int, int, int)> &fn)
+{
+    if (bands <= 1) {
+        fn(0, 0, rows);
+        return;
+    }
+    QVector <int> indexes(bands);
+    for (int i = 0; i < bands; ++i) {
+        indexes[i] = i;
+    }
+    // The calling thread takes part in the work, so this is safe from a pool thread
+    QtConcurrent::blockingMap(indexes, [&](int &band) {
+        fn(band, rows * band / bands, rows * (band + 1) / bands);
+    });
+}
+
+int ScopeKernels::firstRow(int first, int step)
+{
+    return first + (step - first % step) % step;
+}
+
+const char *ScopeKernels::instructionSet()
+{
+    return kernels().name;
+}
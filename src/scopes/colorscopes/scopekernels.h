@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef SCOPEKERNELS_H
+#define SCOPEKERNELS_H
+
+#include <QImage>
+#include <QRgb>
+
+#include <functional>
+
+/**
+  Building blocks shared by the colour scope generators.
+
+  The per pixel arithmetic is done by SIMD kernels, AVX2 or SSE2 depending
+  on the CPU, with a scalar fallback. The variant is chosen on first use
+  and can be forced with the KDENLIVE_SCOPE_KERNELS environment variable
+  (avx2, sse2 or scalar).
+
+  Images are processed in bands of rows run by the global thread pool,
+  each band accumulating into its own bins that are summed afterwards.
+  */
+namespace ScopeKernels
+{
+    /** Luma coefficients, see http://www.poynton.com/ColorFAQ.html */
+    enum Rec { Rec_601, Rec_709 };
+
+    /** @brief Returns @param image if its pixels can be read as QRgb, else a converted copy. */
+    QImage rgb32(const QImage &image);
+
+    /** @brief Computes the luma (0-255, rounded down) of @param count 32 bit pixels. */
+    void luma(const QRgb *pixels, int count, Rec rec, uchar *out);
+
+    /** @brief Computes two affine functions of the pixel components, truncated to int:
+     *  x = c[0] + c[1]*r + c[2]*g + c[3]*b and y = c[4] + c[5]*r + c[6]*g + c[7]*b.
+     *  Used to map pixels to vectorscope coordinates. */
+    void chromaPoints(const QRgb *pixels, int count, const float *c, int *x, int *y);
+
+    /** @brief Component-wise minimum and maximum of @param count pixels, merged into @param minimum and @param maximum. */
+    void minMax(const QRgb *pixels, int count, QRgb &minimum, QRgb &maximum);
+
+    /** @brief Number of bands to split @param rows rows into. */
+    int bandCount(int rows);
+
+    /** @brief Calls @param fn (band, firstRow, endRow) for each band in parallel, returns when all are done. */
+    void forEachBand(int rows, int bands, const std::function<void (int, int, int)> &fn);
+
+    /** @brief First row of [first, end[ to process when only one row every @param step is used. */
+    int firstRow(int first, int step);
+
+    /** @brief Name of the kernel variant in use: "avx2", "sse2" or "scalar". */
+    const char *instructionSet();
+}
+
+#endif
@@ -137,6 +137,23 @@ QString Vectorscope::widgetName() const
     return QStringLiteral("Vectorscope");
 }
 
+FrameAnalysis::Parts Vectorscope::requiredAnalysis() const
+{
+    FrameAnalysis::Parts parts = FrameAnalysis::chromaPart(m_aColorSpace_YPbPr->isChecked() ?
+                                                           FrameAnalysis::Chroma_YPbPr : FrameAnalysis::Chroma_YUV);
+    if (ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt() == VectorscopeGenerator::PaintMode_Original) {
+        parts |= FrameAnalysis::ChromaColors;
+    }
+    return parts;
+}
+
+float Vectorscope::requiredChromaZoom() const
+{
+    // The scope shows U and V up to 1/(scaling*gain), the grid only needs to cover that
+    const FrameAnalysis::ChromaSpace space = m_aColorSpace_YPbPr->isChecked() ? FrameAnalysis::Chroma_YPbPr : FrameAnalysis::Chroma_YUV;
+    return qMax(1.f, FrameAnalysis::chromaExtent(space)*VectorscopeGenerator::scaling*m_gain);
+}
+
 void Vectorscope::readConfig()
 {
     AbstractGfxScopeWidget::readConfig();
@@ -257,7 +274,7 @@ QImage Vectorscope::renderHUD(uint)
     return hud;
 }
 
-QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage Vectorscope::renderGfxScope(uint accelerationFactor, const FrameAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     QImage scope;
@@ -270,9 +287,9 @@ QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage
                                                       VectorscopeGenerator::ColorSpace_YPbPr : VectorscopeGenerator::ColorSpace_YUV;
         VectorscopeGenerator::PaintMode paintMode = (VectorscopeGenerator::PaintMode) ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
         scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size(),
-                                                             qimage,
+                                                             analysis,
                                                              m_gain, paintMode, colorSpace,
-                                                             m_aAxisEnabled->isChecked(), accelerationFactor);
+                                                             m_aAxisEnabled->isChecked());
 
     }
 
@@ -35,12 +35,14 @@ public:
     ~Vectorscope();
 
     QString widgetName() const;
+    FrameAnalysis::Parts requiredAnalysis() const;
+    float requiredChromaZoom() const;
 
 protected:
     ///// Implemented methods /////
     QRect scopeRect();
     QImage renderHUD(uint accelerationFactor);
-    QImage renderGfxScope(uint accelerationFactor, const QImage &);
+    QImage renderGfxScope(uint accelerationFactor, const FrameAnalysis &analysis);
     QImage renderBackground(uint accelerationFactor);
     bool isHUDDependingOnInput() const;
     bool isScopeDependingOnInput() const;
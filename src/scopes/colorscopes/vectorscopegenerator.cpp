@@ -70,8 +70,10 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "frameanalysis.h"
 #include <math.h>
 #include <QImage>
+#include <QVector>
 
 // The maximum distance from the center for any RGB color is 0.63, so
 // no need to make the circle bigger than required.
@@ -115,13 +117,19 @@ QPoint VectorscopeGenerator::mapToCircle(const QSize &targetSize, const QPointF
                    (targetSize.height()-1) * (1 - (point.y()+1)/2) );
 }
 
-QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain,
+QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const FrameAnalysis &analysis, const float &gain,
                                                   const VectorscopeGenerator::PaintMode &paintMode,
                                                   const VectorscopeGenerator::ColorSpace &colorSpace,
-                                                  bool, uint accelFactor) const
+                                                  bool) const
 {
-    if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
-        // Invalid size
+    const FrameAnalysis::ChromaSpace space = colorSpace == VectorscopeGenerator::ColorSpace_YUV ?
+                FrameAnalysis::Chroma_YUV : FrameAnalysis::Chroma_YPbPr;
+    const QVector <uint> &grid = analysis.chroma[space];
+    const QVector <QRgb> &gridColors = analysis.chromaColors[space];
+    const int gridSize = FrameAnalysis::chromaSize;
+
+    if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || grid.isEmpty()) {
+        // Invalid size, or no chroma data
         return QImage();
     }
 
@@ -130,48 +138,53 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     QImage scope = QImage(cw, cw, QImage::Format_ARGB32);
     scope.fill(qRgba(0,0,0,0));
 
-    const uchar *bits = image.bits();
-
-    double dy, dr, dg, db, dmax;
-    double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
-
-    const int stepsize = image.depth() / 8 * accelFactor;
-
     // Just an average for the number of image pixels per scope pixel.
-    // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see: http://doc.trolltech.org/4.6/qimage.html#bytesPerLine
-    double avgPxPerPx = (double) image.depth() / 8 *(image.bytesPerLine()*image.height())/scope.size().width()/scope.size().height()/accelFactor;
-
-    for (int i = 0; i < (image.bytesPerLine()*image.height()); i+= stepsize) {
-        QRgb *col = (QRgb *) bits;
-
-        int r = qRed(*col);
-        int g = qGreen(*col);
-        int b = qBlue(*col);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-//             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double) -0.0005781* r -0.001135 * g +0.001713 * b;
-            v = (double)  0.002411 * r -0.002019 * g -0.0003921* b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-//             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double) -0.0006671* r -0.001299 * g +0.0019608* b;
-            v = (double)  0.001961 * r -0.001642 * g -0.0003189* b;
-            break;
+    double avgPxPerPx = (double) 16*analysis.pixelCount/cw/cw;
+
+    // mapToCircle() of the chroma cells, see above
+    const double halfW = (double)(vectorscopeSize.width()-1)/2;
+    const double halfH = (double)(vectorscopeSize.height()-1)/2;
+    const double factor = SCALING*gain;
+    const double gridCenter = (double)(gridSize-1)/2;
+    // U or V value of one chroma cell
+    const double cellUnit = 2*analysis.chromaRange(space)/(gridSize-1);
+    // When zooming in, a chroma cell covers more than one scope pixel
+    const int cellPixels = qMax(1, (int) ceil(halfW*factor*cellUnit));
+
+    // Hits on each scope pixel, and the last chroma cell that hit it for the paint modes using its colour
+    QVector <uint> hits(cw*cw, 0);
+    QVector <int> cells(cw*cw, -1);
+    for (int v = 0; v < gridSize; ++v) {
+        const int y = halfH - halfH*factor*(v - gridCenter)*cellUnit;
+        for (int u = 0; u < gridSize; ++u) {
+            const uint count = grid.at(v*gridSize + u);
+            if (count == 0) continue;
+            const int x = halfW + halfW*factor*(u - gridCenter)*cellUnit;
+            for (int oy = y; oy < y + cellPixels; ++oy) {
+                for (int ox = x; ox < x + cellPixels; ++ox) {
+                    if (ox >= cw || ox < 0 || oy >= cw || oy < 0) {
+                        // Point lies outside (because of scaling), don't plot it
+                        continue;
+                    }
+                    hits[oy*cw + ox] += count;
+                    cells[oy*cw + ox] = v*gridSize + u;
+                }
+            }
         }
+    }
 
+    double dy, dr, dg, db, dmax;
+    double du, dv;
+    QRgb px;
 
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING*gain*u, SCALING*gain*v));
-
-        if (pt.x() >= scope.width() || pt.x() < 0
-            || pt.y() >= scope.height() || pt.y() < 0) {
-            // Point lies outside (because of scaling), don't plot it
-
-        } else {
+    for (int j = 0; j < cw; ++j) {
+        QRgb *line = (QRgb *) scope.scanLine(j);
+        for (int i = 0; i < cw; ++i) {
+            const uint count = hits.at(j*cw + i);
+            if (count == 0) continue;
+            const int cell = cells.at(j*cw + i);
+            du = (cell % gridSize - gridCenter)*cellUnit;
+            dv = (cell / gridSize - gridCenter)*cellUnit;
 
             // Draw the pixel using the chosen draw mode.
             switch (paintMode) {
@@ -182,15 +195,15 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 // Calculate the RGB values from YUV/YPbPr
                 switch (colorSpace) {
                 case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8*v;
-                    dg = dy - 100.6*u - 148*v;
-                    db = dy + 517.2*u;
+                    dr = dy + 290.8*dv;
+                    dg = dy - 100.6*du - 148*dv;
+                    db = dy + 517.2*du;
                     break;
                 case VectorscopeGenerator::ColorSpace_YPbPr:
                 default:
-                    dr = dy + 357.5*v;
-                    dg = dy - 87.75*u - 182*v;
-                    db = dy + 451.9*u;
+                    dr = dy + 357.5*dv;
+                    dg = dy - 87.75*du - 182*dv;
+                    db = dy + 451.9*du;
                     break;
                 }
 
@@ -202,7 +215,7 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 if (dg > 255) dg = 255;
                 if (db > 255) db = 255;
 
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
+                line[i] = qRgba(dr, dg, db, 255);
                 break;
 
             case PaintMode_Chroma:
@@ -211,15 +224,15 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 // Calculate the RGB values from YUV/YPbPr
                 switch (colorSpace) {
                 case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8*v;
-                    dg = dy - 100.6*u - 148*v;
-                    db = dy + 517.2*u;
+                    dr = dy + 290.8*dv;
+                    dg = dy - 100.6*du - 148*dv;
+                    db = dy + 517.2*du;
                     break;
                 case VectorscopeGenerator::ColorSpace_YPbPr:
                 default:
-                    dr = dy + 357.5*v;
-                    dg = dy - 87.75*u - 182*v;
-                    db = dy + 451.9*u;
+                    dr = dy + 357.5*dv;
+                    dg = dy - 87.75*du - 182*dv;
+                    db = dy + 451.9*du;
                     break;
                 }
 
@@ -233,29 +246,43 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 dg *= dmax;
                 db *= dmax;
 
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
+                line[i] = qRgba(dr, dg, db, 255);
                 break;
             case PaintMode_Original:
-                scope.setPixel(pt, *col);
+                line[i] = gridColors.isEmpty() ? qRgba(255, 255, 255, 255) : gridColors.at(cell);
                 break;
+            // The modes below brighten the pixel on each hit, stop once it does not change anymore
             case PaintMode_Green:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px)+(255-qRed(px))/(3*avgPxPerPx), qGreen(px)+20*(255-qGreen(px))/(avgPxPerPx),
-                                         qBlue(px)+(255-qBlue(px))/(avgPxPerPx), qAlpha(px)+(255-qAlpha(px))/(avgPxPerPx)));
+                px = line[i];
+                for (uint k = 0; k < count; ++k) {
+                    const QRgb next = qRgba(qRed(px)+(255-qRed(px))/(3*avgPxPerPx), qGreen(px)+20*(255-qGreen(px))/(avgPxPerPx),
+                                            qBlue(px)+(255-qBlue(px))/(avgPxPerPx), qAlpha(px)+(255-qAlpha(px))/(avgPxPerPx));
+                    if (next == px) break;
+                    px = next;
+                }
+                line[i] = px;
                 break;
             case PaintMode_Green2:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px)+ceil((255-(float)qRed(px))/(4*avgPxPerPx)), 255,
-                                         qBlue(px)+ceil((255-(float)qBlue(px))/(avgPxPerPx)), qAlpha(px)+ceil((255-(float)qAlpha(px))/(avgPxPerPx))));
+                px = line[i];
+                for (uint k = 0; k < count; ++k) {
+                    const QRgb next = qRgba(qRed(px)+ceil((255-(float)qRed(px))/(4*avgPxPerPx)), 255,
+                                            qBlue(px)+ceil((255-(float)qBlue(px))/(avgPxPerPx)), qAlpha(px)+ceil((255-(float)qAlpha(px))/(avgPxPerPx)));
+                    if (next == px) break;
+                    px = next;
+                }
+                line[i] = px;
                 break;
             case PaintMode_Black:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0,0,0, qAlpha(px)+(255-qAlpha(px))/20));
+                px = line[i];
+                for (uint k = 0; k < count; ++k) {
+                    const QRgb next = qRgba(0,0,0, qAlpha(px)+(255-qAlpha(px))/20);
+                    if (next == px) break;
+                    px = next;
+                }
+                line[i] = px;
                 break;
             }
         }
-
-        bits += stepsize;
     }
     return scope;
 }
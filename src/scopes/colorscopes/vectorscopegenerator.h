@@ -14,6 +14,7 @@
 #include <QObject>
 #include <QtGui/QImage>
 
+class FrameAnalysis;
 class QImage;
 class QPoint;
 class QPointF;
@@ -27,10 +28,10 @@ public:
     enum ColorSpace { ColorSpace_YUV, ColorSpace_YPbPr };
     enum PaintMode { PaintMode_Green, PaintMode_Green2, PaintMode_Original, PaintMode_Chroma, PaintMode_YUV, PaintMode_Black };
 
-    QImage calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain,
+    QImage calculateVectorscope(const QSize &vectorscopeSize, const FrameAnalysis &analysis, const float &gain,
                                 const VectorscopeGenerator::PaintMode &paintMode,
                                 const VectorscopeGenerator::ColorSpace &colorSpace,
-                                bool, uint accelFactor = 1) const;
+                                bool) const;
 
     QPoint mapToCircle(const QSize &targetSize, const QPointF &point) const;
     static const float scaling;
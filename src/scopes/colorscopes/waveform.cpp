@@ -100,6 +100,10 @@ QRect Waveform::scopeRect()
 ///// Implemented methods /////
 
 QString Waveform::widgetName() const { return QStringLiteral("Waveform"); }
+FrameAnalysis::Parts Waveform::requiredAnalysis() const
+{
+    return FrameAnalysis::Waveform | FrameAnalysis::lumaPart(m_aRec601->isChecked() ? ScopeKernels::Rec_601 : ScopeKernels::Rec_709);
+}
 bool Waveform::isHUDDependingOnInput() const { return false; }
 bool Waveform::isScopeDependingOnInput() const { return true; }
 bool Waveform::isBackgroundDependingOnInput() const { return false; }
@@ -166,15 +170,15 @@ QImage Waveform::renderHUD(uint)
     return hud;
 }
 
-QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Waveform::renderGfxScope(uint, const FrameAnalysis &analysis)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     const int paintmode = ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
     WaveformGenerator::Rec rec = m_aRec601->isChecked() ? WaveformGenerator::Rec_601 : WaveformGenerator::Rec_709;
-    QImage wave = m_waveformGenerator->calculateWaveform(scopeRect().size() - m_textWidth - QSize(0,m_paddingBottom), qimage,
-                                                         (WaveformGenerator::PaintMode) paintmode, true, rec, accelFactor);
+    QImage wave = m_waveformGenerator->calculateWaveform(scopeRect().size() - m_textWidth - QSize(0,m_paddingBottom), analysis,
+                                                         (WaveformGenerator::PaintMode) paintmode, true, rec);
 
     emit signalScopeRenderingFinished(start.elapsed(), 1);
     return wave;
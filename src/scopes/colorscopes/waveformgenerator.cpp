@@ -9,6 +9,7 @@
  ***************************************************************************/
 
 #include "waveformgenerator.h"
+#include "frameanalysis.h"
 
 #include <cmath>
 
@@ -16,6 +17,7 @@
 #include <QPainter>
 #include <QSize>
 #include <QTime>
+#include <QVector>
 
 #define CHOP255(a) ((255) < (a) ? (255) : (a))
 
@@ -27,17 +29,17 @@ WaveformGenerator::~WaveformGenerator()
 {
 }
 
-QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode,
-                                            bool drawAxis, WaveformGenerator::Rec rec, uint accelFactor)
+QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const FrameAnalysis &analysis, WaveformGenerator::PaintMode paintMode,
+                                            bool drawAxis, WaveformGenerator::Rec rec)
 {
-    Q_ASSERT(accelFactor >= 1);
-
     //QTime time;
     //time.start();
 
     QImage wave(waveformSize, QImage::Format_ARGB32);
+    const ScopeKernels::Rec lumaRec = rec == WaveformGenerator::Rec_601 ? ScopeKernels::Rec_601 : ScopeKernels::Rec_709;
+    const QVector <uint> &levels = analysis.waveform[lumaRec];
 
-    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || levels.isEmpty()) {
         return QImage();
 
     } else {
@@ -47,86 +49,66 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
 
         const uint ww = waveformSize.width();
         const uint wh = waveformSize.height();
-        const uint iw = image.bytesPerLine();
-        const uint ih = image.height();
-        const uint byteCount = iw*ih;
-
-        uint waveValues[waveformSize.width()][waveformSize.height()];
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                waveValues[i][j] = 0;
-            }
-        }
-
-        // Number of input pixels that will fall on one scope pixel.
-        // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-        const float pixelDepth = (float)((byteCount>>2) / accelFactor)/(ww*wh);
-        const float gain = 255/(8*pixelDepth);
-        //qDebug() << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
+        const uint columns = analysis.columns;
 
-
-        // Subtract 1 from sizes because we start counting from 0.
+        // Subtract 1 from the height because we start counting from 0.
         // Not doing it would result in attempts to paint outside of the image.
         const float hPrediv = (float)(wh-1)/255;
-        const float wPrediv = (float)(ww-1)/(iw-1);
-
-        const uchar *bits = image.bits();
-	const int bpp = image.depth() / 8;
-
-        for (uint i = 0, x = 0; i < byteCount; i += bpp) {
-
-            Q_ASSERT(bits < image.bits() + byteCount);
-
-            double dY, dx, dy;
-            QRgb *col = (QRgb *)bits;
+        uint rows[256];
+        for (int i = 0; i < 256; ++i) {
+            rows[i] = i*hPrediv;
+        }
 
-            if (rec == WaveformGenerator::Rec_601) {
-                // CIE 601 Luminance
-                dY = .299*qRed(*col) + .587*qGreen(*col) + .114*qBlue(*col);
-            } else {
-                // CIE 709 Luminance
-                dY = .2125*qRed(*col) + .7154*qGreen(*col) + .0721*qBlue(*col);
-            }
-            // dY is on [0,255] now.
-
-            dy = dY*hPrediv;
-            dx = x*wPrediv;
-            waveValues[(int)dx][(int)dy]++;
-
-            bits += bpp;
-            x += bpp;
-            if (x > iw) {
-                x -= iw;
-                if (accelFactor > 1) {
-                    bits += bpp*iw*(accelFactor-1);
-                    i += bpp*iw*(accelFactor-1);
+        // Resample the analysed columns to the scope width, waveValues[x][y] is at x*wh + y.
+        // If the scope is wider than the analysis, columns are repeated.
+        QVector <uint> waveValues(ww*wh, 0);
+        quint64 total = 0;
+        for (uint i = 0; i < ww; ++i) {
+            const uint first = (quint64) i*columns/ww;
+            const uint end = qMax(first + 1, (uint) ((quint64) (i+1)*columns/ww));
+            uint *bins = waveValues.data() + i*wh;
+            for (uint c = first; c < end; ++c) {
+                const uint *column = levels.constData() + c*256;
+                for (int l = 0; l < 256; ++l) {
+                    bins[rows[l]] += column[l];
+                    total += column[l];
                 }
             }
         }
 
+        // Number of input pixels that will fall on one scope pixel.
+        // Must be a float because it can be <1 expected px per px.
+        const float pixelDepth = qMax((float) total/(ww*wh), (float) 1e-3);
+        const float gain = 255/(8*pixelDepth);
+        //qDebug() << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain;
+
         switch (paintMode) {
         case PaintMode_Green:
-            for (int i = 0; i < waveformSize.width(); ++i) {
-                for (int j = 0; j < waveformSize.height(); ++j) {
+            for (uint j = 0; j < wh; ++j) {
+                QRgb *line = (QRgb *) wave.scanLine(wh-j-1);
+                for (uint i = 0; i < ww; ++i) {
+                    const uint value = waveValues.at(i*wh + j);
                     // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                    wave.setPixel(i, waveformSize.height()-j-1, qRgba(CHOP255(52*log(0.1*gain*waveValues[i][j])),
-                                                                      CHOP255(52*log(gain*waveValues[i][j])),
-                                                                      CHOP255(52*log(.25*gain*waveValues[i][j])),
-                                                                      CHOP255(64*log(gain*waveValues[i][j]))));
+                    line[i] = qRgba(CHOP255(52*log(0.1*gain*value)),
+                                    CHOP255(52*log(gain*value)),
+                                    CHOP255(52*log(.25*gain*value)),
+                                    CHOP255(64*log(gain*value)));
                 }
             }
             break;
         case PaintMode_Yellow:
-            for (int i = 0; i < waveformSize.width(); ++i) {
-                for (int j = 0; j < waveformSize.height(); ++j) {
-                    wave.setPixel(i, waveformSize.height()-j-1, qRgba(255,242,0,   CHOP255(gain*waveValues[i][j])));
+            for (uint j = 0; j < wh; ++j) {
+                QRgb *line = (QRgb *) wave.scanLine(wh-j-1);
+                for (uint i = 0; i < ww; ++i) {
+                    line[i] = qRgba(255,242,0,   CHOP255(gain*waveValues.at(i*wh + j)));
                 }
             }
             break;
         default:
-            for (int i = 0; i < waveformSize.width(); ++i) {
-                for (int j = 0; j < waveformSize.height(); ++j) {
-                    wave.setPixel(i, waveformSize.height()-j-1, qRgba(255,255,255, CHOP255(2*gain*waveValues[i][j])));
+            for (uint j = 0; j < wh; ++j) {
+                QRgb *line = (QRgb *) wave.scanLine(wh-j-1);
+                for (uint i = 0; i < ww; ++i) {
+                    line[i] = qRgba(255,255,255, CHOP255(2*gain*waveValues.at(i*wh + j)));
                 }
             }
             break;
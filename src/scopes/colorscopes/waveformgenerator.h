@@ -12,6 +12,7 @@
 #define WAVEFORMGENERATOR_H
 
 #include <QObject>
+class FrameAnalysis;
 class QImage;
 class QSize;
 
@@ -26,8 +27,9 @@ public:
     WaveformGenerator();
     ~WaveformGenerator();
 
-    QImage calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode,
-                             bool drawAxis, const WaveformGenerator::Rec rec, uint accelFactor = 1);
+    /** @brief Paints the luma levels of the analysed columns, resampled to @param waveformSize. */
+    QImage calculateWaveform(const QSize &waveformSize, const FrameAnalysis &analysis, WaveformGenerator::PaintMode paintMode,
+                             bool drawAxis, const WaveformGenerator::Rec rec);
 
 //signals:
     //void signalCalculationFinished(QImage image, const uint &ms);
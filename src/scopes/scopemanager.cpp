@@ -24,6 +24,7 @@
 
 
 #include <QDockWidget>
+#include <QtConcurrent>
 #include "klocalizedstring.h"
 
 //#define DEBUG_SM
@@ -41,6 +42,7 @@ ScopeManager::ScopeManager(QObject *parent) :
     connect(pCore->monitorManager(), SIGNAL(clearScopes()), SLOT(slotClearColorScopes()));
     connect(pCore->monitorManager(), SIGNAL(checkScopes()), SLOT(slotCheckActiveScopes()));
     connect(m_signalMapper, SIGNAL(mapped(QString)), SLOT(slotRequestFrame(QString)));
+    connect(&m_analysisWatcher, SIGNAL(finished()), SLOT(slotAnalysisFinished()));
 
     slotUpdateActiveRenderer();
 
@@ -136,10 +138,49 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
 #ifdef DEBUG_SM
     qDebug() << "ScopeManager: Starting to distribute frame.";
 #endif
+    if (m_analysisWatcher.isRunning()) {
+        // Frames come faster than they are analysed, only keep the latest one
+        m_pendingFrame = image;
+    } else {
+        analyseFrame(image);
+    }
+
+    checkActiveColourScopes();
+}
+
+void ScopeManager::analyseFrame(const QImage &image)
+{
+    FrameAnalysis::Parts parts = FrameAnalysis::NoPart;
+    // The least zoomed scope decides, so that every scope gets all its colours
+    float chromaZoom = 0;
+    for (int i = 0; i < m_colorScopes.size(); ++i) {
+        if (acceptsFrame(i)) {
+            const FrameAnalysis::Parts scopeParts = m_colorScopes[i].scope->requiredAnalysis();
+            parts |= scopeParts;
+            if (scopeParts & (FrameAnalysis::ChromaYUV | FrameAnalysis::ChromaYPbPr)) {
+                const float zoom = m_colorScopes[i].scope->requiredChromaZoom();
+                chromaZoom = chromaZoom == 0 ? zoom : qMin(chromaZoom, zoom);
+            }
+        }
+    }
+    if (parts != FrameAnalysis::NoPart) {
+        m_analysisWatcher.setFuture(QtConcurrent::run(&FrameAnalysis::analyse, image, parts, qMax(1.f, chromaZoom)));
+    }
+}
+
+bool ScopeManager::acceptsFrame(int index) const
+{
+    const GfxScopeData &data = m_colorScopes.at(index);
+    return !data.scope->visibleRegion().isEmpty() && (data.scope->autoRefreshEnabled() || data.singleFrameRequested);
+}
+
+void ScopeManager::slotAnalysisFinished()
+{
+    const FrameAnalysisPtr analysis = m_analysisWatcher.result();
     for (int i = 0; i < m_colorScopes.size(); ++i) {
         if (!m_colorScopes[i].scope->visibleRegion().isEmpty()) {
             if (m_colorScopes[i].scope->autoRefreshEnabled()) {
-                m_colorScopes[i].scope->slotRenderZoneUpdated(image);
+                m_colorScopes[i].scope->slotRenderZoneUpdated(analysis);
 #ifdef DEBUG_SM
                 qDebug() << "ScopeManager: Distributed frame to " << m_colorScopes[i].scope->widgetName();
 #endif
@@ -147,7 +188,7 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
                 // Special case: Auto refresh is disabled, but user requested an update (e.g. by clicking).
                 // Force the scope to update.
                 m_colorScopes[i].singleFrameRequested = false;
-                m_colorScopes[i].scope->slotRenderZoneUpdated(image);
+                m_colorScopes[i].scope->slotRenderZoneUpdated(analysis);
                 m_colorScopes[i].scope->forceUpdateScope();
 #ifdef DEBUG_SM
                 qDebug() << "ScopeManager: Distributed forced frame to " << m_colorScopes[i].scope->widgetName();
@@ -156,7 +197,11 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
         }
     }
 
-    checkActiveColourScopes();
+    if (!m_pendingFrame.isNull()) {
+        const QImage frame = m_pendingFrame;
+        m_pendingFrame = QImage();
+        analyseFrame(frame);
+    }
 }
 
 
@@ -15,6 +15,7 @@
 #include "colorscopes/abstractgfxscopewidget.h"
 
 #include <QtCore/QList>
+#include <QFutureWatcher>
 
 class QDockWidget;
 class AbstractRender;
@@ -26,6 +27,9 @@ class AbstractRender;
   all scopes that have been registered via ScopeManager::addScope(AbstractAudioScopeWidget, QDockWidget)
   or ScopeManager::addScope(AbstractGfxScopeWidget, QDockWidget). It checks whether the renderer really
   needs to send data (it does not, for example, if no scopes are visible).
+
+  Frames are analysed once for all colour scopes, see FrameAnalysis. While a frame
+  is being analysed, only the latest of the frames received meanwhile is kept.
   */
 class ScopeManager : public QObject
 {
@@ -71,6 +75,10 @@ private:
 
     QSignalMapper *m_signalMapper;
 
+    QFutureWatcher <FrameAnalysisPtr> m_analysisWatcher;
+    /** @brief Latest frame received while another one was analysed. */
+    QImage m_pendingFrame;
+
     /**
       Checks whether there is any scope accepting audio data, or if all of them are hidden
       or if auto refresh is disabled.
@@ -81,6 +89,14 @@ private:
       \see audioAcceptedByScopes()
       */
     bool imagesAcceptedByScopes() const;
+    /**
+      Returns true if the colour scope at @param index will receive the next frame analysis.
+      */
+    bool acceptsFrame(int index) const;
+    /**
+      Starts analysing @param image for all the colour scopes that will receive it.
+      */
+    void analyseFrame(const QImage &image);
 
     /**
       Creates all the scopes in audioscopes/ and colorscopes/.
@@ -124,6 +140,10 @@ private slots:
     void checkActiveColourScopes();
 
     void slotDistributeFrame(const QImage &image);
+    /**
+      Hands the analysis of the frame to the colour scopes, and analyses the pending frame if any.
+      */
+    void slotAnalysisFinished();
     void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
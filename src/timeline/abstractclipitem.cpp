@@ -53,6 +53,19 @@ AbstractClipItem::AbstractClipItem(const ItemInfo &info, const QRectF& rect, dou
 
 AbstractClipItem::~AbstractClipItem()
 {
+    if (projectScene()) projectScene()->removeFromIndex(this);
+}
+
+void AbstractClipItem::updateSceneIndex(GraphicsItemChange change)
+{
+    CustomTrackScene *scene = projectScene();
+    if (!scene) return;
+    if (change == ItemSceneChange) {
+        // Leaving the scene
+        scene->removeFromIndex(this);
+    } else if (change == ItemPositionHasChanged || change == ItemSceneHasChanged) {
+        scene->updateIndex(this);
+    }
 }
 
 void AbstractClipItem::doUpdate(const QRectF &r)
@@ -168,12 +181,15 @@ GenTime AbstractClipItem::cropDuration() const
 void AbstractClipItem::setCropStart(const GenTime &pos)
 {
     m_info.cropStart = pos;
+    // Clip markers depend on the crop
+    if (projectScene()) projectScene()->updateIndex(this);
 }
 
 void AbstractClipItem::updateItem(int track)
 {
     m_info.track = track;
     m_info.startPos = GenTime((int) scenePos().x(), m_fps);
+    if (projectScene()) projectScene()->updateIndex(this);
 }
 
 void AbstractClipItem::updateRectGeometry()
@@ -219,6 +235,7 @@ void AbstractClipItem::resizeStart(int posx, bool hasSizeLimit, bool /*emitChang
     // set crop from start to 0 (isn't relevant as this only happens for color clips, images)
     if (negCropStart)
         m_info.cropStart = GenTime();
+    if (projectScene()) projectScene()->updateIndex(this);
 }
 
 void AbstractClipItem::resizeEnd(int posx, bool /*emitChange*/)
@@ -249,6 +266,7 @@ void AbstractClipItem::resizeEnd(int posx, bool /*emitChange*/)
         }
         if (fixItem) setRect(0, 0, cropDuration().frames(m_fps) - 0.02, rect().height());
     }
+    if (projectScene()) projectScene()->updateIndex(this);
 }
 
 GenTime AbstractClipItem::startPos() const
@@ -256,6 +274,12 @@ GenTime AbstractClipItem::startPos() const
     return m_info.startPos;
 }
 
+// virtual
+QList <int> AbstractClipItem::snapFrames() const
+{
+    return QList <int>() << (int) startPos().frames(m_fps) << (int) endPos().frames(m_fps);
+}
+
 double AbstractClipItem::fps() const
 {
     return m_fps;
@@ -266,6 +290,7 @@ void AbstractClipItem::updateFps(double fps)
     m_fps = fps;
     setPos((qreal) startPos().frames(m_fps), pos().y());
     updateRectGeometry();
+    if (projectScene()) projectScene()->updateIndex(this);
 }
 
 GenTime AbstractClipItem::maxDuration() const
@@ -58,6 +58,8 @@ public:
     virtual void updateKeyframes(QDomElement effect) = 0;
     virtual GenTime startPos() const ;
     virtual GenTime endPos() const ;
+    /** @brief Returns the frames other items can snap to (start and end, plus markers for clips). */
+    virtual QList <int> snapFrames() const;
     virtual int track() const ;
     virtual GenTime cropStart() const ;
     virtual GenTime cropDuration() const ;
@@ -119,6 +121,8 @@ protected:
     void mouseMoveEvent(QGraphicsSceneMouseEvent * event);
     int trackForPos(int position);
     int posForTrack(int track);
+    /** @brief Keeps the scene's track and snap indexes in sync, called from itemChange(). */
+    void updateSceneIndex(GraphicsItemChange change);
 };
 
 #endif
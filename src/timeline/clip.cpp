@@ -115,6 +115,22 @@ void Clip::replaceEffects(Mlt::Service& service)
     addEffects(service);
 }
 
+void Clip::moveEffects(Mlt::Service& service)
+{
+    int ct = 0;
+    Mlt::Filter *filter = service.filter(ct);
+    while (filter) {
+        QString ix = filter->get("kdenlive_ix");
+        if (!ix.isEmpty() && service.detach(*filter) == 0) {
+            // our reference keeps the filter alive until it is attached
+            m_producer.attach(*filter);
+        }
+        else ct++;
+        delete filter;
+        filter = service.filter(ct);
+    }
+}
+
 void Clip::deleteEffects()
 {
     // remove effects
@@ -48,6 +48,8 @@ public:
     void deleteEffects();
     void addEffects(Mlt::Service& service, bool skipFades = false);
     void replaceEffects(Mlt::Service& service);
+    /** @brief: Detach the kdenlive effects of service and attach them to this clip, without copying them. */
+    void moveEffects(Mlt::Service& service);
     void delEffect(int index);
     /** @brief: Dis/enable all kdenlive effects on a clip. */
     void disableEffects(bool disable);
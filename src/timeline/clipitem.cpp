@@ -21,6 +21,7 @@
 #include "clipitem.h"
 #include "customtrackscene.h"
 #include "customtrackview.h"
+#include "timeline.h"
 #include "transition.h"
 
 #include "renderer.h"
@@ -56,6 +57,8 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo& info, double fps, double s
     //m_hover(false),
     m_speed(speed),
     m_strobe(strobe),
+    m_pendingEffects(NULL),
+    m_pendingThumbs(false),
     m_framePixelWidth(0)
 {
     setZValue(2);
@@ -94,6 +97,7 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo& info, double fps, double s
             m_endThumbTimer.setSingleShot(true);
             connect(&m_endThumbTimer, SIGNAL(timeout()), this, SLOT(slotGetEndThumb()));
 	    connect(m_binClip, SIGNAL(thumbReady(int,QImage)), this, SLOT(slotThumbReady(int,QImage)));
+            connect(m_binClip, SIGNAL(filmstripReady()), this, SLOT(slotFilmstripReady()));
             if (generateThumbs && KdenliveSettings::videothumbnails()) QTimer::singleShot(200, this, SLOT(slotFetchThumbs()));
         }
     } else if (m_clipType == Color) {
@@ -113,6 +117,9 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo& info, double fps, double s
 
 ClipItem::~ClipItem()
 {
+    // Don't build effects when leaving the scene
+    delete m_pendingEffects;
+    m_pendingEffects = NULL;
     blockSignals(true);
     m_endThumbTimer.stop();
     m_startThumbTimer.stop();
@@ -125,6 +132,35 @@ ClipItem::~ClipItem()
     delete m_timeLine;
 }
 
+void ClipItem::setPendingLoad(Mlt::Producer *cut)
+{
+    delete m_pendingEffects;
+    m_pendingEffects = cut;
+    m_pendingThumbs = m_hasThumbs && KdenliveSettings::videothumbnails();
+}
+
+bool ClipItem::hasPendingLoad() const
+{
+    return m_pendingEffects != NULL || m_pendingThumbs;
+}
+
+void ClipItem::loadPendingEffects()
+{
+    effects();
+}
+
+EffectsList &ClipItem::effects() const
+{
+    if (m_pendingEffects && scene()) {
+        // Take the cut first, building the list goes through addEffect()
+        QScopedPointer<Mlt::Producer> cut(m_pendingEffects);
+        m_pendingEffects = NULL;
+        Timeline *timeline = static_cast <CustomTrackScene*>(scene())->timeline();
+        timeline->loadClipEffects(const_cast <ClipItem*>(this), *cut);
+    }
+    return m_effectList;
+}
+
 ClipItem *ClipItem::clone(const ItemInfo &info) const
 {
     ClipItem *duplicate = new ClipItem(m_binClip, info, m_fps, m_speed, m_strobe, FRAME_SIZE);
@@ -136,7 +172,7 @@ ClipItem *ClipItem::clone(const ItemInfo &info) const
             duplicate->slotSetEndThumb(m_endPix);
         }
     }
-    duplicate->setEffectList(m_effectList);
+    duplicate->setEffectList(effects());
     duplicate->setState(m_clipState);
     duplicate->setFades(fadeIn(), fadeOut());
     //duplicate->setSpeed(m_speed);
@@ -145,16 +181,16 @@ ClipItem *ClipItem::clone(const ItemInfo &info) const
 
 void ClipItem::setEffectList(const EffectsList &effectList)
 {
-    m_effectList.clone(effectList);
-    m_effectNames = m_effectList.effectNames().join(QStringLiteral(" / "));
+    effects().clone(effectList);
+    m_effectNames = effects().effectNames().join(QStringLiteral(" / "));
     m_startFade = 0;
     m_endFade = 0;
     bool startFade = false;
     bool endFade = false;
-    if (!m_effectList.isEmpty()) {
+    if (!effects().isEmpty()) {
         // If we only have one fade in /ou effect, always display it in timeline
-        for (int i = 0; i < m_effectList.count(); ++i) {
-            QDomElement effect = m_effectList.at(i);
+        for (int i = 0; i < effects().count(); ++i) {
+            QDomElement effect = effects().at(i);
             QString effectId = effect.attribute(QStringLiteral("id"));
             // check if it is a fade effect
             int fade = 0;
@@ -185,7 +221,7 @@ void ClipItem::setEffectList(const EffectsList &effectList)
 
 const EffectsList ClipItem::effectList() const
 {
-    return m_effectList;
+    return effects();
 }
 
 int ClipItem::selectedEffectIndex() const
@@ -195,7 +231,7 @@ int ClipItem::selectedEffectIndex() const
 
 void ClipItem::initEffect(ProfileInfo pInfo, QDomElement effect, int diff, int offset)
 {
-    EffectsController::initEffect(m_info, pInfo, m_effectList, m_binClip->getProducerProperty(QStringLiteral("proxy")), effect, diff, offset);
+    EffectsController::initEffect(m_info, pInfo, effects(), m_binClip->getProducerProperty(QStringLiteral("proxy")), effect, diff, offset);
 }
 
 bool ClipItem::checkKeyFrames(int width, int height, int previousDuration, int cutPos)
@@ -203,7 +239,7 @@ bool ClipItem::checkKeyFrames(int width, int height, int previousDuration, int c
     bool clipEffectsModified = false;
     QLocale locale;
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
-    int effectsCount = m_effectList.count();
+    int effectsCount = effects().count();
     if (effectsCount == 0) {
         // reset keyframes
 	m_keyframeView.reset();
@@ -292,7 +328,7 @@ bool ClipItem::checkKeyFrames(int width, int height, int previousDuration, int c
 
 void ClipItem::setKeyframes(const int ix, const QStringList &keyframes)
 {
-    QDomElement effect = m_effectList.at(ix);
+    QDomElement effect = effects().at(ix);
     if (effect.attribute(QStringLiteral("disable")) == QLatin1String("1")) return;
     QLocale locale;
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
@@ -320,8 +356,8 @@ void ClipItem::setSelectedEffect(const int ix)
         QString effectId = effect.attribute("id");
 
         // Check for fades to display in timeline
-        int startFade1 = m_effectList.hasEffect(QString(), "fadein");
-        int startFade2 = m_effectList.hasEffect(QString(), "fade_from_black");
+        int startFade1 = effects().hasEffect(QString(), "fadein");
+        int startFade2 = effects().hasEffect(QString(), "fade_from_black");
 
         if (startFade1 >= 0 && startFade2 >= 0) {
             // We have 2 fade ins, only display if effect is selected
@@ -341,8 +377,8 @@ void ClipItem::setSelectedEffect(const int ix)
         }
 
         // Check for fades out to display in timeline
-        int endFade1 = m_effectList.hasEffect(QString(), "fadeout");
-        int endFade2 = m_effectList.hasEffect(QString(), "fade_to_black");
+        int endFade1 = effects().hasEffect(QString(), "fadeout");
+        int endFade2 = effects().hasEffect(QString(), "fade_to_black");
 
         if (endFade1 >= 0 && endFade2 >= 0) {
             // We have 2 fade ins, only display if effect is selected
@@ -375,7 +411,7 @@ bool ClipItem::resizeGeometries(const int index, int width, int height, int prev
 {
     QString geom;
     bool modified = false;
-    QDomElement effect = m_effectList.at(index);
+    QDomElement effect = effects().at(index);
     QDomNodeList params = effect.elementsByTagName(QStringLiteral("parameter"));
     bool cut = effect.attribute(QStringLiteral("kdenlive:sync_in_out")).toInt() == 1;
     if (!cut) {
@@ -400,7 +436,7 @@ QString ClipItem::resizeAnimations(const int index, int width, int height, int p
 {
     QString animation;
     QString keyframes;
-    QDomElement effect = m_effectList.at(index);
+    QDomElement effect = effects().at(index);
     QDomNodeList params = effect.elementsByTagName(QStringLiteral("parameter"));
     for (int i = 0; i < params.count(); ++i) {
         QDomElement e = params.item(i).toElement();
@@ -426,7 +462,7 @@ QString ClipItem::resizeAnimations(const int index, int width, int height, int p
 QStringList ClipItem::keyframes(const int index)
 {
     QStringList result;
-    QDomElement effect = m_effectList.at(index);
+    QDomElement effect = effects().at(index);
     QDomNodeList params = effect.elementsByTagName(QStringLiteral("parameter"));
 
     for (int i = 0; i < params.count(); ++i) {
@@ -443,7 +479,7 @@ QStringList ClipItem::keyframes(const int index)
 
 QDomElement ClipItem::selectedEffect()
 {
-    if (m_selectedEffect == -1 || m_effectList.isEmpty())
+    if (m_selectedEffect == -1 || effects().isEmpty())
         return QDomElement();
     return effectAtIndex(m_selectedEffect);
 }
@@ -477,6 +513,7 @@ void ClipItem::refreshClip(bool checkDuration, bool forceResetThumbs)
                     m_info.cropDuration = m_maxDuration;
                 }
                 updateRectGeometry();
+                if (projectScene()) projectScene()->updateIndex(this);
             }
         }
     }
@@ -498,19 +535,36 @@ void ClipItem::slotFetchThumbs()
     }
 
     QList <int> frames;
+    bool cachedThumbs = false;
     if (m_startPix.isNull()) {
-        m_startThumbRequested = true;
-        frames.append((int)m_speedIndependantInfo.cropStart.frames(m_fps));
+        // Use thumbnails already in memory, the thumbnail thread loads the ones stored on disk
+        int frame = (int)m_speedIndependantInfo.cropStart.frames(m_fps);
+        QImage img = m_binClip->cachedThumbnail(frame);
+        if (!img.isNull()) {
+            m_startPix = QPixmap::fromImage(img);
+            cachedThumbs = true;
+        } else {
+            m_startThumbRequested = true;
+            frames.append(frame);
+        }
     }
 
     if (m_endPix.isNull()) {
-        m_endThumbRequested = true;
-        frames.append((int)(m_speedIndependantInfo.cropStart + m_speedIndependantInfo.cropDuration).frames(m_fps) - 1);
+        int frame = (int)(m_speedIndependantInfo.cropStart + m_speedIndependantInfo.cropDuration).frames(m_fps) - 1;
+        QImage img = m_binClip->cachedThumbnail(frame);
+        if (!img.isNull()) {
+            m_endPix = QPixmap::fromImage(img);
+            cachedThumbs = true;
+        } else {
+            m_endThumbRequested = true;
+            frames.append(frame);
+        }
     }
 
     if (!frames.isEmpty()) {
 	m_binClip->slotExtractImage(frames);
     }
+    if (cachedThumbs) update();
 }
 
 void ClipItem::stopThumbs()
@@ -580,6 +634,12 @@ void ClipItem::slotThumbReady(int frame, const QImage &img)
     }
 }
 
+void ClipItem::slotFilmstripReady()
+{
+    if (scene() == NULL || !KdenliveSettings::filmstripthumbnails()) return;
+    update();
+}
+
 void ClipItem::slotSetStartThumb(const QPixmap &pix)
 {
     m_startPix = pix;
@@ -663,11 +723,55 @@ void ClipItem::animate(qreal /*value*/)
     update(r);
 }
 
+void ClipItem::paintFilmstrip(QPainter *painter, const QRectF &exposed, const QRectF &mapped, double scale)
+{
+    // Tiles are decoded at track height and drawn at the clip's height
+    const int tileHeight = KdenliveSettings::trackheight();
+    const double tileWidth = mapped.height() * FRAME_SIZE / tileHeight;
+    if (tileWidth <= 0 || scale <= 0) return;
+    // Number of frames covered by a tile, a power of two so that tiles
+    // stay at the same place when scrolling and are reused between zoom levels
+    int stride = 1;
+    while (stride * scale < tileWidth && stride < (1 << 20)) {
+        stride *= 2;
+    }
+    const double slotWidth = stride * scale;
+    const int first = qMax(0, (int) exposed.left() / stride);
+    const int last = qMin((int) exposed.right(), (int) rect().width()) / stride;
+    const int cropStart = m_speedIndependantInfo.cropStart.frames(m_fps);
+    const int maxFrame = (m_speedIndependantInfo.cropStart + m_speedIndependantInfo.cropDuration).frames(m_fps) - 1;
+    const bool stillImage = m_clipType == Image || m_clipType == Text || m_clipType == QText;
+    QList <int> missing;
+    for (int i = first; i <= last; ++i) {
+        QRectF target(mapped.left() + i * slotWidth, mapped.top(), tileWidth, mapped.height());
+        if (stillImage) {
+            if (!m_startPix.isNull()) painter->drawPixmap(target, m_startPix, m_startPix.rect());
+        } else {
+            int frame = qMin(maxFrame, cropStart + (int) (i * stride * qAbs(m_speed)));
+            // Only tiles already in memory are painted, decoding happens in the clip's thumbnail thread
+            QImage img = m_binClip->filmstripTile(frame, tileHeight);
+            if (img.isNull()) missing << frame;
+            else painter->drawImage(target, img);
+        }
+        if (i > 0) painter->drawLine(target.topLeft(), target.bottomLeft());
+    }
+    if (!missing.isEmpty()) m_binClip->requestFilmstripTiles(missing, tileHeight);
+}
+
 // virtual
 void ClipItem::paint(QPainter *painter,
                      const QStyleOptionGraphicsItem *option,
                      QWidget *)
 {
+    if (m_pendingThumbs) {
+        // First paint of a clip loaded from a project
+        m_pendingThumbs = false;
+        QTimer::singleShot(0, this, SLOT(slotFetchThumbs()));
+    }
+    if (m_pendingEffects) {
+        // Fades and effect names are drawn
+        effects();
+    }
     QPalette palette = scene()->palette();
     QColor paintColor = m_paintColor;
     QColor textColor;
@@ -701,63 +805,30 @@ void ClipItem::paint(QPainter *painter,
     painter->setPen(m_paintColor.darker());
     // draw thumbnails
     if (KdenliveSettings::videothumbnails() && m_clipState != PlaylistState::AudioOnly) {
-        QRectF thumbRect;
-        if ((m_clipType == Image || m_clipType == Text || m_clipType == QText) && !m_startPix.isNull()) {
-            if (thumbRect.isNull()) thumbRect = QRectF(0, 0, mapped.height() / m_startPix.height() * m_startPix.width(), mapped.height());
-            thumbRect.moveTopRight(mapped.topRight());
-            painter->drawPixmap(thumbRect, m_startPix, m_startPix.rect());
-        } else if (!m_endPix.isNull()) {
-            if (thumbRect.isNull()) thumbRect = QRectF(0, 0, mapped.height() / m_endPix.height() * m_endPix.width(), mapped.height());
-            thumbRect.moveTopRight(mapped.topRight());
-            painter->drawPixmap(thumbRect, m_endPix, m_endPix.rect());
-        }
-        if (!m_startPix.isNull()) {
-            if (thumbRect.isNull()) thumbRect = QRectF(0, 0, mapped.height() / m_startPix.height() * m_startPix.width(), mapped.height());
-            thumbRect.moveTopLeft(mapped.topLeft());
-            painter->drawPixmap(thumbRect, m_startPix, m_startPix.rect());
-        }
-    } else {
-
-        // if we are in full zoom, paint thumbnail for every frame
-        //TODO
-        if (false && /*m_clip->thumbProducer() &&*/ clipType() != Color && clipType() != Audio && m_clipState != PlaylistState::AudioOnly && transformation.m11() == FRAME_SIZE) {
-            int offset = (m_info.startPos - m_info.cropStart).frames(m_fps);
-            int left = qMax((int) m_info.cropStart.frames(m_fps) + 1, (int) mapToScene(exposed.left(), 0).x() - offset);
-            int right = qMin((int)(m_info.cropStart + m_info.cropDuration).frames(m_fps) - 1, (int) mapToScene(exposed.right(), 0).x() - offset);
-            QPointF startPos = mapped.topLeft();
-            int startOffset = m_info.cropStart.frames(m_fps);
-            if (clipType() == Image || clipType() == Text || clipType() == QText) {
-                for (int i = left; i <= right; ++i) {
-                    painter->drawPixmap(startPos + QPointF(FRAME_SIZE *(i - startOffset), 0), m_startPix);
-                }
+        if (KdenliveSettings::filmstripthumbnails() && m_clipType != Color && m_clipType != Audio) {
+            paintFilmstrip(painter, exposed, mapped, transformation.m11());
+        } else {
+            QRectF thumbRect;
+            if ((m_clipType == Image || m_clipType == Text || m_clipType == QText) && !m_startPix.isNull()) {
+                if (thumbRect.isNull()) thumbRect = QRectF(0, 0, mapped.height() / m_startPix.height() * m_startPix.width(), mapped.height());
+                thumbRect.moveTopRight(mapped.topRight());
+                painter->drawPixmap(thumbRect, m_startPix, m_startPix.rect());
+            } else if (!m_endPix.isNull()) {
+                if (thumbRect.isNull()) thumbRect = QRectF(0, 0, mapped.height() / m_endPix.height() * m_endPix.width(), mapped.height());
+                thumbRect.moveTopRight(mapped.topRight());
+                painter->drawPixmap(thumbRect, m_endPix, m_endPix.rect());
             }
-            else {
-                //TODO
-                if (false /*m_clip->thumbProducer()*/) {
-                    QImage img;
-                    QPen pen(Qt::white);
-                    pen.setStyle(Qt::DotLine);
-                    QSet <int> missing;
-                    for (int i = left; i <= right; ++i) {
-                        QPointF xpos = startPos + QPointF(FRAME_SIZE *(i - startOffset), 0);
-                        //TODO
-                        //img = m_clip->thumbProducer()->findCachedThumb(i);
-                        if (img.isNull()) missing << i;
-                        else {
-                            painter->drawImage(xpos, img);
-                        }
-                        painter->drawLine(xpos, xpos + QPointF(0, mapped.height()));
-                    }
-                    if (!missing.isEmpty()) {
-                        //TODO
-                        //m_clip->thumbProducer()->queryIntraThumbs(missing);
-                    }
-                }
+            if (!m_startPix.isNull()) {
+                if (thumbRect.isNull()) thumbRect = QRectF(0, 0, mapped.height() / m_startPix.height() * m_startPix.width(), mapped.height());
+                thumbRect.moveTopLeft(mapped.topLeft());
+                painter->drawPixmap(thumbRect, m_startPix, m_startPix.rect());
             }
         }
     }
     // draw audio thumbnails
     if (KdenliveSettings::audiothumbnails() && m_speed == 1.0 && m_clipState != PlaylistState::VideoOnly && (((m_clipType == AV || m_clipType == Playlist) && (exposed.bottom() > (rect().height() / 2) || m_clipState == PlaylistState::AudioOnly)) || m_clipType == Audio) && m_audioThumbReady && !m_binClip->audioFrameCache.isEmpty()) {
+        // Shallow copy, the bin clip may replace its peaks while we paint
+        const AudioPeaks peaks = m_binClip->audioFrameCache;
         int startpixel = qMax(0, (int) exposed.left());
         int endpixel = qMax(0, (int) (exposed.right() + 0.5) + 1);
         QRectF mappedRect = mapped;
@@ -766,29 +837,21 @@ void ClipItem::paint(QPainter *painter,
         }
 
         double scale = transformation.m11();
-        int channels = m_binClip->audioChannels();
+        int channels = peaks.channels();
         int cropLeft = m_info.cropStart.frames(m_fps);
         double startx = transformation.map(QPoint(startpixel, 0)).x();
         double endx = transformation.map(QPoint(endpixel, 0)).x();
-        int offset = 1;
-        if (scale < 1) {
-            offset = (int) (1.0 / scale);
-        }
-        int audioLevelCount = m_binClip->audioFrameCache.count() - 1;
+        int startOffset = startpixel + cropLeft;
         if (!KdenliveSettings::displayallchannels()) {
             // simplified audio
             int channelHeight = mappedRect.height();
-            int startOffset = startpixel + cropLeft;
-            int i = startOffset;
-            if (offset * scale > 1.0) {
+            if (scale > 1.0) {
                 // Pixels are smaller than a frame, draw using painterpath
                 QPainterPath positiveChannelPath;
                 positiveChannelPath.moveTo(startx, mappedRect.bottom());
-                for (; i < endpixel + cropLeft + offset; i += offset) {
-                    double value = m_binClip->audioFrameCache.at(qMin(i * channels, audioLevelCount)).toDouble() / 256;
-                    for (int channel = 1; channel < channels; channel ++) {
-                        value = qMax(value, m_binClip->audioFrameCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256);
-                    }
+                int i = startOffset;
+                for (; i < endpixel + cropLeft + 1; ++i) {
+                    double value = AudioPeaks::amplitude(peaks.peak(i, i + 1));
                     positiveChannelPath.lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - (value * channelHeight));
                 }
                 positiveChannelPath.lineTo(startx + (i - startOffset) * scale, mappedRect.bottom());
@@ -796,39 +859,33 @@ void ClipItem::paint(QPainter *painter,
                 painter->setBrush(QBrush(QColor(80, 80, 150, 200)));
                 painter->drawPath(positiveChannelPath);
             } else {
-                // Pixels are larger than frames, draw simple lines
+                // Frames are smaller than pixels, draw the peak of all frames covered by each pixel
                 painter->setPen(QColor(80, 80, 150, 200));
-                i = startx;
-                for (; i < endx; i++) {
-                    int framePos = startOffset + ((i - startx) / scale);
-                    double value = m_binClip->audioFrameCache.at(qMin(framePos * channels, audioLevelCount)).toDouble() / 256;
-                    for (int channel = 1; channel < channels; channel ++) {
-                        value = qMax(value, m_binClip->audioFrameCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256);
-                    }
+                for (int i = startx; i < endx; i++) {
+                    int framePos = startOffset + (i - startx) / scale;
+                    int frameEnd = qMax(framePos + 1, (int) (startOffset + (i + 1 - startx) / scale));
+                    double value = AudioPeaks::amplitude(peaks.peak(framePos, frameEnd));
                     painter->drawLine(i, mappedRect.bottom() - (value * channelHeight), i, mappedRect.bottom());
                 }
             }
-        } else if (channels >= 0) {
+        } else if (channels > 0) {
             int channelHeight = (int) (mappedRect.height() + 0.5) / channels;
-            int startOffset = startpixel + cropLeft;
-            double value = 0;
-            if (offset * scale > 1.0) {
+            if (scale > 1.0) {
                 // Pixels are smaller than a frame, draw using painterpath
                 QMap<int, QPainterPath > positiveChannelPaths;
                 QMap<int, QPainterPath > negativeChannelPaths;
-                int i;
+                int i = startOffset;
                 painter->setPen(QColor(80, 80, 150));
                 for (int channel = 0; channel < channels; channel ++) {
                     int y = channelHeight * channel + channelHeight / 2;
                     positiveChannelPaths[channel].moveTo(startx, mappedRect.bottom() - y);
                     negativeChannelPaths[channel].moveTo(startx, mappedRect.bottom() - y);
                     // Draw channel median line
-                    i = startOffset;
                     painter->drawLine(startx, mappedRect.bottom() - y, endx, mappedRect.bottom() - y);
-                    for (; i < endpixel + cropLeft + offset; i += offset) {
-                        value = m_binClip->audioFrameCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256 * channelHeight / 2;
-                        positiveChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y - value);
-                        negativeChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y + value);
+                    for (i = startOffset; i < endpixel + cropLeft + 1; ++i) {
+                        AudioPeak peak = peaks.peak(channel, i, i + 1);
+                        positiveChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y - peak.max / 127.0 * channelHeight / 2);
+                        negativeChannelPaths[channel].lineTo(startx + (i - startOffset) * scale, mappedRect.bottom() - y - peak.min / 127.0 * channelHeight / 2);
                     }
                 }
                 painter->setPen(Qt::NoPen);
@@ -841,20 +898,20 @@ void ClipItem::paint(QPainter *painter,
                     painter->drawPath(negativeChannelPaths.value(channel));
                 }
             } else {
-                // Pixels are larger than frames, draw simple lines
+                // Frames are smaller than pixels, draw the peak of all frames covered by each pixel
                 painter->setPen(QColor(80, 80, 150));
                 for (int channel = 0; channel < channels; channel ++) {
                     // Draw channel median line
                     painter->drawLine(startx, mappedRect.bottom() - (channelHeight * channel + channelHeight / 2), endx, mappedRect.bottom() - (channelHeight * channel + channelHeight / 2));
                 }
-                int i = startx;
                 painter->setPen(QColor(80, 80, 150, 200));
-                for (; i < endx; i++) {
-                    int framePos = startOffset + ((i - startx) / scale);
+                for (int i = startx; i < endx; i++) {
+                    int framePos = startOffset + (i - startx) / scale;
+                    int frameEnd = qMax(framePos + 1, (int) (startOffset + (i + 1 - startx) / scale));
                     for (int channel = 0; channel < channels; channel ++) {
                         int y = channelHeight * channel + channelHeight / 2;
-                        value = m_binClip->audioFrameCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256 * channelHeight / 2;
-                        painter->drawLine(i, mappedRect.bottom() - value - y, i, mappedRect.bottom() - y + value);
+                        AudioPeak peak = peaks.peak(channel, framePos, frameEnd);
+                        painter->drawLine(i, mappedRect.bottom() - y - peak.max / 127.0 * channelHeight / 2, i, mappedRect.bottom() - y - peak.min / 127.0 * channelHeight / 2);
                     }
                 }
             }
@@ -1110,6 +1167,17 @@ QList <CommentedTime> ClipItem::commentedSnapMarkers() const
 }
 
 
+//virtual
+QList <int> ClipItem::snapFrames() const
+{
+    QList <int> frames = AbstractClipItem::snapFrames();
+    QList <CommentedTime> markers = commentedSnapMarkers();
+    for (int i = 0; i < markers.size(); ++i) {
+        frames << (int) markers.at(i).time().frames(m_fps);
+    }
+    return frames;
+}
+
 int ClipItem::fadeIn() const
 {
     return m_startFade;
@@ -1232,6 +1300,12 @@ void ClipItem::resizeEnd(int posx, bool emitChange)
 //virtual
 QVariant ClipItem::itemChange(GraphicsItemChange change, const QVariant &value)
 {
+    if ((change == ItemSceneChange || change == ItemSelectedChange) && m_pendingEffects) {
+        // Effects are built through the scene, do it before leaving it.
+        // A selected clip can be moved or edited, its cut may not stay valid
+        effects();
+    }
+    updateSceneIndex(change);
     if (change == QGraphicsItem::ItemSelectedChange) {
         if (value.toBool())
             setZValue(6);
@@ -1340,41 +1414,41 @@ int ClipItem::effectsCounter()
 
 int ClipItem::effectsCount()
 {
-    return m_effectList.count();
+    return effects().count();
 }
 
 int ClipItem::hasEffect(const QString &tag, const QString &id) const
 {
-    return m_effectList.hasEffect(tag, id);
+    return effects().hasEffect(tag, id);
 }
 
 QStringList ClipItem::effectNames()
 {
-    return m_effectList.effectNames();
+    return effects().effectNames();
 }
 
 QDomElement ClipItem::effect(int ix) const
 {
-    if (ix >= m_effectList.count() || ix < 0) return QDomElement();
-    return m_effectList.at(ix).cloneNode().toElement();
+    if (ix >= effects().count() || ix < 0) return QDomElement();
+    return effects().at(ix).cloneNode().toElement();
 }
 
 QDomElement ClipItem::effectAtIndex(int ix) const
 {
-    if (ix > m_effectList.count() || ix <= 0) return QDomElement();
-    return m_effectList.itemFromIndex(ix).cloneNode().toElement();
+    if (ix > effects().count() || ix <= 0) return QDomElement();
+    return effects().itemFromIndex(ix).cloneNode().toElement();
 }
 
 QDomElement ClipItem::getEffectAtIndex(int ix) const
 {
-    if (ix > m_effectList.count() || ix <= 0) return QDomElement();
-    return m_effectList.itemFromIndex(ix);
+    if (ix > effects().count() || ix <= 0) return QDomElement();
+    return effects().itemFromIndex(ix);
 }
 
 void ClipItem::updateEffect(QDomElement effect)
 {
-    m_effectList.updateEffect(effect);
-    m_effectNames = m_effectList.effectNames().join(QStringLiteral(" / "));
+    effects().updateEffect(effect);
+    m_effectNames = effects().effectNames().join(QStringLiteral(" / "));
     QString id = effect.attribute(QStringLiteral("id"));
     if (id == QLatin1String("fadein") || id == QLatin1String("fadeout") || id == QLatin1String("fade_from_black") || id == QLatin1String("fade_to_black"))
         update();
@@ -1387,18 +1461,18 @@ void ClipItem::updateEffect(QDomElement effect)
 
 void ClipItem::enableEffects(QList <int> indexes, bool disable)
 {
-    m_effectList.enableEffects(indexes, disable);
+    effects().enableEffects(indexes, disable);
 }
 
 bool ClipItem::moveEffect(QDomElement effect, int ix)
 {
-    if (ix <= 0 || ix > (m_effectList.count()) || effect.isNull()) {
+    if (ix <= 0 || ix > (effects().count()) || effect.isNull()) {
         return false;
     }
-    m_effectList.removeAt(effect.attribute(QStringLiteral("kdenlive_ix")).toInt());
+    effects().removeAt(effect.attribute(QStringLiteral("kdenlive_ix")).toInt());
     effect.setAttribute(QStringLiteral("kdenlive_ix"), ix);
-    m_effectList.insert(effect);
-    m_effectNames = m_effectList.effectNames().join(QStringLiteral(" / "));
+    effects().insert(effect);
+    m_effectNames = effects().effectNames().join(QStringLiteral(" / "));
     QString id = effect.attribute(QStringLiteral("id"));
     if (id == QLatin1String("fadein") || id == QLatin1String("fadeout") || id == QLatin1String("fade_from_black") || id == QLatin1String("fade_to_black"))
         update();
@@ -1427,10 +1501,10 @@ EffectsParameterList ClipItem::addEffect(ProfileInfo info, QDomElement effect, b
         ix = 1;
         effect.setAttribute(QStringLiteral("kdenlive_ix"), QStringLiteral("1"));
     }
-    if (!m_effectList.isEmpty() && ix <= m_effectList.count()) {
+    if (!effects().isEmpty() && ix <= effects().count()) {
         needRepaint = true;
-        insertedEffect = m_effectList.insert(effect);
-    } else insertedEffect = m_effectList.append(effect);
+        insertedEffect = effects().insert(effect);
+    } else insertedEffect = effects().append(effect);
 
     // Update index to the real one
     effect.setAttribute(QStringLiteral("kdenlive_ix"), insertedEffect.attribute(QStringLiteral("kdenlive_ix")));
@@ -1466,37 +1540,37 @@ EffectsParameterList ClipItem::addEffect(ProfileInfo info, QDomElement effect, b
     // check if it is a fade effect
     if (effectId == QLatin1String("fadein")) {
         needRepaint = true;
-        if (m_effectList.hasEffect(QString(), QStringLiteral("fade_from_black")) == -1) {
+        if (effects().hasEffect(QString(), QStringLiteral("fade_from_black")) == -1) {
             fade = effectOut - effectIn;
         }/* else {
-        QDomElement fadein = m_effectList.getEffectByTag(QString(), "fade_from_black");
+        QDomElement fadein = effects().getEffectByTag(QString(), "fade_from_black");
             if (fadein.attribute("name") == "out") fade += fadein.attribute("value").toInt();
             else if (fadein.attribute("name") == "in") fade -= fadein.attribute("value").toInt();
         }*/
     } else if (effectId == QLatin1String("fade_from_black")) {
         needRepaint = true;
-        if (m_effectList.hasEffect(QString(), QStringLiteral("fadein")) == -1) {
+        if (effects().hasEffect(QString(), QStringLiteral("fadein")) == -1) {
             fade = effectOut - effectIn;
         }/* else {
-        QDomElement fadein = m_effectList.getEffectByTag(QString(), "fadein");
+        QDomElement fadein = effects().getEffectByTag(QString(), "fadein");
             if (fadein.attribute("name") == "out") fade += fadein.attribute("value").toInt();
             else if (fadein.attribute("name") == "in") fade -= fadein.attribute("value").toInt();
         }*/
     } else if (effectId == QLatin1String("fadeout")) {
         needRepaint = true;
-        if (m_effectList.hasEffect(QString(), QStringLiteral("fade_to_black")) == -1) {
+        if (effects().hasEffect(QString(), QStringLiteral("fade_to_black")) == -1) {
             fade = effectIn - effectOut;
         } /*else {
-        QDomElement fadeout = m_effectList.getEffectByTag(QString(), "fade_to_black");
+        QDomElement fadeout = effects().getEffectByTag(QString(), "fade_to_black");
             if (fadeout.attribute("name") == "out") fade -= fadeout.attribute("value").toInt();
             else if (fadeout.attribute("name") == "in") fade += fadeout.attribute("value").toInt();
         }*/
     } else if (effectId == QLatin1String("fade_to_black")) {
         needRepaint = true;
-        if (m_effectList.hasEffect(QString(), QStringLiteral("fadeout")) == -1) {
+        if (effects().hasEffect(QString(), QStringLiteral("fadeout")) == -1) {
             fade = effectIn - effectOut;
         }/* else {
-        QDomElement fadeout = m_effectList.getEffectByTag(QString(), "fadeout");
+        QDomElement fadeout = effects().getEffectByTag(QString(), "fadeout");
             if (fadeout.attribute("name") == "out") fade -= fadeout.attribute("value").toInt();
             else if (fadeout.attribute("name") == "in") fade += fadeout.attribute("value").toInt();
         }*/
@@ -1556,7 +1630,7 @@ EffectsParameterList ClipItem::addEffect(ProfileInfo info, QDomElement effect, b
         parameters.addParam(QStringLiteral("out"), QString::number((int) (cropStart() + cropDuration()).frames(m_fps) - 1));
         parameters.addParam(QStringLiteral("kdenlive:sync_in_out"), QStringLiteral("0"));
     }
-    m_effectNames = m_effectList.effectNames().join(QStringLiteral(" / "));
+    m_effectNames = effects().effectNames().join(QStringLiteral(" / "));
     if (fade > 0) m_startFade = fade;
     else if (fade < 0) m_endFade = -fade;
 
@@ -1583,7 +1657,7 @@ EffectsParameterList ClipItem::addEffect(ProfileInfo info, QDomElement effect, b
 void ClipItem::deleteEffect(int ix)
 {
     bool needRepaint = false;
-    QDomElement effect = m_effectList.itemFromIndex(ix);
+    QDomElement effect = effects().itemFromIndex(ix);
     QString effectId = effect.attribute(QStringLiteral("id"));
     if ((effectId == QLatin1String("fadein") && hasEffect(QString(), QStringLiteral("fade_from_black")) == -1) ||
             (effectId == QLatin1String("fade_from_black") && hasEffect(QString(), QStringLiteral("fadein")) == -1)) {
@@ -1594,13 +1668,13 @@ void ClipItem::deleteEffect(int ix)
         m_endFade = 0;
         needRepaint = true;
     } else if (EffectsList::hasKeyFrames(effect)) needRepaint = true;
-    m_effectList.removeAt(ix);
-    m_effectNames = m_effectList.effectNames().join(QStringLiteral(" / "));
+    effects().removeAt(ix);
+    m_effectNames = effects().effectNames().join(QStringLiteral(" / "));
 
-    if (m_effectList.isEmpty() || m_selectedEffect == ix) {
+    if (effects().isEmpty() || m_selectedEffect == ix) {
         // Current effect was removed
-        if (ix > m_effectList.count()) {
-            setSelectedEffect(m_effectList.count());
+        if (ix > effects().count()) {
+            setSelectedEffect(effects().count());
         } else setSelectedEffect(ix);
     }
     if (needRepaint) {
@@ -1610,7 +1684,7 @@ void ClipItem::deleteEffect(int ix)
         //r.setHeight(20);
         update(r);
     }
-    if (!m_effectList.isEmpty()) flashClip();
+    if (!effects().isEmpty()) flashClip();
 }
 
 double ClipItem::speed() const
@@ -1631,6 +1705,7 @@ void ClipItem::setSpeed(const double speed, const int strobe)
     m_strobe = strobe;
     m_info.cropStart = GenTime((int)(m_speedIndependantInfo.cropStart.frames(m_fps) / qAbs(m_speed) + 0.5), m_fps);
     m_info.cropDuration = GenTime((int)(m_speedIndependantInfo.cropDuration.frames(m_fps) / qAbs(m_speed) + 0.5), m_fps);
+    if (projectScene()) projectScene()->updateIndex(this);
     //update();
 }
 
@@ -1658,8 +1733,8 @@ const ItemInfo ClipItem::speedIndependantInfo() const
 int ClipItem::nextFreeEffectGroupIndex() const
 {
     int freeGroupIndex = 0;
-    for (int i = 0; i < m_effectList.count(); ++i) {
-        QDomElement effect = m_effectList.at(i);
+    for (int i = 0; i < effects().count(); ++i) {
+        QDomElement effect = effects().at(i);
         EffectInfo effectInfo;
         effectInfo.fromString(effect.attribute(QStringLiteral("kdenlive_info")));
         if (effectInfo.groupIndex >= freeGroupIndex) {
@@ -1762,8 +1837,8 @@ QMap<int, QDomElement> ClipItem::adjustEffectsToDuration(int width, int height,
 {
     QMap<int, QDomElement> effects;
     qDebug()<<"Adjusting effect to duraion";
-    for (int i = 0; i < m_effectList.count(); ++i) {
-        QDomElement effect = m_effectList.at(i);
+    for (int i = 0; i < effects().count(); ++i) {
+        QDomElement effect = effects().at(i);
 
         if (effect.attribute(QStringLiteral("id")).startsWith(QLatin1String("fade"))) {
             QString id = effect.attribute(QStringLiteral("id"));
@@ -49,6 +49,13 @@ class ClipItem : public AbstractClipItem
 public:
     ClipItem(ProjectClip *clip, const ItemInfo &info, double fps, double speed, int strobe, int frame_width, bool generateThumbs = true);
     virtual ~ ClipItem();
+    /** @brief Delays the expensive parts of loading a clip from a project until it is painted or its effects are used.
+     *  @param cut the clip's cut in the track playlist (owned by the item), its filters are parsed to build the effect list */
+    void setPendingLoad(Mlt::Producer *cut);
+    /** @brief Returns true if the clip was not painted or used since setPendingLoad(). */
+    bool hasPendingLoad() const;
+    /** @brief Builds the effect list now if setPendingLoad() delayed it, before the clip's cut is changed. */
+    void loadPendingEffects();
     virtual void paint(QPainter *painter,
                        const QStyleOptionGraphicsItem *option,
                        QWidget *);
@@ -126,6 +133,7 @@ public:
     * @return A list of the times. */
     QList <GenTime> snapMarkers(const QList < GenTime > markers ) const;
     QList <CommentedTime> commentedSnapMarkers() const;
+    QList <int> snapFrames() const;
 
     /** @brief Gets the position of the fade in effect. */
     int fadeIn() const;
@@ -229,13 +237,22 @@ private:
     double m_speed;
     int m_strobe;
 
-    EffectsList m_effectList;
+    /** @brief Use effects(), the list is built on first use for clips loaded from a project. */
+    mutable EffectsList m_effectList;
+    /** @brief Cut whose filters still have to be parsed into m_effectList, see setPendingLoad(). */
+    mutable Mlt::Producer *m_pendingEffects;
+    /** @brief Thumbnails are requested on first paint, see setPendingLoad(). */
+    bool m_pendingThumbs;
+    /** @brief Returns the effect list, building it first if needed. */
+    EffectsList &effects() const;
     QList <Transition*> m_transitionsList;
     QMap<int, QPixmap> m_audioThumbCachePic;
     bool m_audioThumbReady;
     double m_framePixelWidth;
     QPixmap m_videoPix;
     QPixmap m_audioPix;
+    /** @brief Paint one thumbnail per frame (or per group of frames when zoomed out) in the exposed area. */
+    void paintFilmstrip(QPainter *painter, const QRectF &exposed, const QRectF &mapped, double scale);
 
 private slots:
     void slotGetStartThumb();
@@ -245,6 +262,8 @@ private slots:
     void slotSetStartThumb(const QImage &img);
     void slotSetEndThumb(const QImage &img);
     void slotThumbReady(int frame, const QImage &img);
+    /** @brief Some filmstrip tiles were decoded, repaint. */
+    void slotFilmstripReady();
     /** @brief For fixed thumbnail clip (image / titles), update thumb to reflect bin thumbnail. */
     void slotUpdateThumb(QImage);
     /** @brief Something changed a detail in clip (thumbs, markers,...), repaint. */
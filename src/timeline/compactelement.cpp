@@ -0,0 +1,180 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "compactelement.h"
+
+#include <QDomDocument>
+#include <QDomNamedNodeMap>
+#include <QTextStream>
+
+// Rough size of a DOM node with its private data, attributes are nodes too
+static const int nodeCost = 64;
+
+static int stringCost(const QString &str)
+{
+    return str.size() * (int) sizeof(QChar);
+}
+
+static int domCost(const QDomNode &node)
+{
+    int cost = nodeCost + stringCost(node.nodeName()) + stringCost(node.nodeValue());
+    QDomNamedNodeMap attributes = node.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        QDomNode attribute = attributes.item(i);
+        cost += nodeCost + stringCost(attribute.nodeName()) + stringCost(attribute.nodeValue());
+    }
+    for (QDomNode child = node.firstChild(); !child.isNull(); child = child.nextSibling()) {
+        cost += domCost(child);
+    }
+    return cost;
+}
+
+/** Same nodes and text, attributes are not compared. */
+static bool sameStructure(const QDomNode &a, const QDomNode &b)
+{
+    if (a.nodeType() != b.nodeType() || a.nodeName() != b.nodeName()) return false;
+    if (a.isCharacterData() && a.nodeValue() != b.nodeValue()) return false;
+    QDomNode childA = a.firstChild();
+    QDomNode childB = b.firstChild();
+    while (!childA.isNull() && !childB.isNull()) {
+        if (!sameStructure(childA, childB)) return false;
+        childA = childA.nextSibling();
+        childB = childB.nextSibling();
+    }
+    return childA.isNull() && childB.isNull();
+}
+
+static void collectElements(const QDomElement &root, QList <QDomElement> &elements)
+{
+    elements << root;
+    for (QDomElement child = root.firstChildElement(); !child.isNull(); child = child.nextSiblingElement()) {
+        collectElements(child, elements);
+    }
+}
+
+CompactElement::CompactElement() :
+    m_delta(false),
+    m_cost(0)
+{
+}
+
+CompactElement::CompactElement(const QDomElement &element) :
+    m_delta(false),
+    m_cost(0)
+{
+    if (element.isNull()) return;
+    m_element = element;
+    m_cost = domCost(m_element);
+}
+
+CompactElement::CompactElement(const QDomElement &element, const QDomElement &base) :
+    m_delta(false),
+    m_cost(0)
+{
+    if (element.isNull()) return;
+    if (buildDelta(element, base)) {
+        m_delta = true;
+        m_cost = nodeCost;
+        foreach (const Change &change, m_changes) {
+            m_cost += nodeCost + stringCost(change.name) + stringCost(change.value);
+        }
+    } else {
+        m_element = element;
+        m_cost = domCost(m_element);
+    }
+}
+
+bool CompactElement::buildDelta(const QDomElement &element, const QDomElement &base)
+{
+    if (base.isNull() || !sameStructure(element, base)) return false;
+    QList <QDomElement> elements;
+    QList <QDomElement> baseElements;
+    collectElements(element, elements);
+    collectElements(base, baseElements);
+    for (int i = 0; i < elements.count(); ++i) {
+        const QDomElement &current = elements.at(i);
+        const QDomElement &previous = baseElements.at(i);
+        QDomNamedNodeMap attributes = current.attributes();
+        for (int j = 0; j < attributes.count(); ++j) {
+            QDomNode attribute = attributes.item(j);
+            const QString name = attribute.nodeName();
+            if (!previous.hasAttribute(name) || previous.attribute(name) != attribute.nodeValue()) {
+                Change change;
+                change.node = i;
+                change.name = name;
+                change.value = attribute.nodeValue();
+                change.removed = false;
+                m_changes << change;
+            }
+        }
+        attributes = previous.attributes();
+        for (int j = 0; j < attributes.count(); ++j) {
+            const QString name = attributes.item(j).nodeName();
+            if (!current.hasAttribute(name)) {
+                Change change;
+                change.node = i;
+                change.name = name;
+                change.removed = true;
+                m_changes << change;
+            }
+        }
+    }
+    return true;
+}
+
+QDomElement CompactElement::element(const QDomElement &base) const
+{
+    if (m_delta) {
+        QDomElement result = base.cloneNode().toElement();
+        if (m_changes.isEmpty()) return result;
+        QList <QDomElement> elements;
+        collectElements(result, elements);
+        foreach (const Change &change, m_changes) {
+            if (change.node >= elements.count()) continue;
+            if (change.removed) elements[change.node].removeAttribute(change.name);
+            else elements[change.node].setAttribute(change.name, change.value);
+        }
+        return result;
+    }
+    if (!m_xml.isEmpty()) {
+        QDomDocument doc;
+        doc.setContent(qUncompress(m_xml));
+        return doc.documentElement();
+    }
+    return m_element;
+}
+
+bool CompactElement::isNull() const
+{
+    return !m_delta && m_element.isNull() && m_xml.isEmpty();
+}
+
+bool CompactElement::isDelta() const
+{
+    return m_delta;
+}
+
+void CompactElement::compress()
+{
+    if (m_delta || m_element.isNull()) return;
+    QByteArray xml;
+    QTextStream stream(&xml, QIODevice::WriteOnly);
+    stream.setCodec("UTF-8");
+    m_element.save(stream, -1);
+    stream.flush();
+    m_xml = qCompress(xml);
+    m_element = QDomElement();
+    m_cost = m_xml.size();
+}
+
+int CompactElement::cost() const
+{
+    return m_cost;
+}
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef COMPACTELEMENT_H
+#define COMPACTELEMENT_H
+
+#include <QByteArray>
+#include <QDomElement>
+#include <QList>
+#include <QString>
+
+/**
+  Copy of an effect or transition xml element, as stored by undo commands.
+
+  When built against a base element with the same structure (typically
+  the same effect before a parameter change), only the attributes that
+  differ are stored. Full copies can be compressed to serialized xml once
+  they are old enough, see KdenliveDoc::slotCheckUndoBudget().
+  */
+class CompactElement
+{
+public:
+    CompactElement();
+    /** @brief Keeps @param element, it is shared with the caller until compressed. */
+    explicit CompactElement(const QDomElement &element);
+    /** @brief Stores the attributes of @param element that differ from @param base,
+     *  or keeps @param element if their structure differs. */
+    CompactElement(const QDomElement &element, const QDomElement &base);
+
+    /** @brief Returns the stored element.
+     *  @param base for a delta, the element given to the constructor (or an equal one) */
+    QDomElement element(const QDomElement &base = QDomElement()) const;
+    bool isNull() const;
+    bool isDelta() const;
+    /** @brief Replaces the element by compressed xml, element() then returns a new copy. */
+    void compress();
+    /** @brief Approximate memory used, in bytes. */
+    int cost() const;
+
+private:
+    struct Change
+    {
+        /** @brief Position of the element in a depth first walk of the tree. */
+        int node;
+        QString name;
+        QString value;
+        bool removed;
+    };
+    QDomElement m_element;
+    QByteArray m_xml;
+    QList <Change> m_changes;
+    bool m_delta;
+    int m_cost;
+
+    /** @brief Finds the attribute changes from @param base to @param element, false if their structure differs. */
+    bool buildDelta(const QDomElement &element, const QDomElement &base);
+};
+
+/**
+  Undo commands storing effect or transition xml implement this so that
+  KdenliveDoc can account for and compress their data.
+  */
+class CompactableCommand
+{
+public:
+    virtual ~CompactableCommand() {}
+    /** @brief Approximate memory used by the stored xml, in bytes. */
+    virtual int memoryCost() const = 0;
+    /** @brief Compresses the stored xml, undo and redo stay available. */
+    virtual void compact() = 0;
+};
+
+#endif
@@ -63,7 +63,8 @@ CustomRuler::CustomRuler(const Timecode &tc, CustomTrackView *parent) :
         m_headPosition(SEEK_INACTIVE),
         m_clickedGuide(-1),
         m_rate(-1),
-        m_mouseMove(NO_MOVE)
+        m_mouseMove(NO_MOVE),
+        m_chunkSize(0)
 {
     setFont(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont));
     QFontMetricsF fontMetrics(font());
@@ -114,6 +115,14 @@ void CustomRuler::updateFrameSize()
     if (m_rate > 0) setPixelPerMark(m_rate);
 }
 
+void CustomRuler::updatePreview(const QList <int> &rendered, const QList <int> &dirty, int chunkSize)
+{
+    m_renderedChunks = rendered;
+    m_dirtyChunks = dirty;
+    m_chunkSize = chunkSize;
+    update();
+}
+
 void CustomRuler::slotEditGuide()
 {
     m_view->slotEditGuide(m_clickedGuide);
@@ -398,6 +407,15 @@ void CustomRuler::paintEvent(QPaintEvent *e)
     const int zoneEnd = (int)(m_zoneEnd * m_factor);
     p.fillRect(zoneStart - m_offset, LABEL_SIZE + 2, zoneEnd - zoneStart, MAX_HEIGHT - LABEL_SIZE - 2, palette().color(QPalette::Highlight));
 
+    // Draw timeline preview chunks
+    const int chunkWidth = (int)(m_chunkSize * m_factor);
+    foreach (int frame, m_dirtyChunks) {
+        p.fillRect((int)(frame * m_factor) - m_offset, MAX_HEIGHT - 3, chunkWidth, 3, Qt::darkRed);
+    }
+    foreach (int frame, m_renderedChunks) {
+        p.fillRect((int)(frame * m_factor) - m_offset, MAX_HEIGHT - 3, chunkWidth, 3, Qt::darkGreen);
+    }
+
     double f, fend;
     const int offsetmax = ((paintRect.right() + m_offset) / FRAME_SIZE + 1) * FRAME_SIZE;
     int offsetmin;
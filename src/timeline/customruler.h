@@ -49,6 +49,8 @@ public:
     int offset() const;
     void updateProjectFps(const Timecode &t);
     void updateFrameSize();
+    /** @brief Show the rendered and the dirty chunks of the timeline preview, by start frame */
+    void updatePreview(const QList <int> &rendered, const QList <int> &dirty, int chunkSize);
 
 protected:
     void paintEvent(QPaintEvent * /*e*/);
@@ -80,6 +82,9 @@ private:
     int m_startRate;
     MOUSE_MOVE m_mouseMove;
     QMenu *m_goMenu;
+    QList <int> m_renderedChunks;
+    QList <int> m_dirtyChunks;
+    int m_chunkSize;
 
 
 public slots:
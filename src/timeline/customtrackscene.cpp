@@ -18,7 +18,12 @@
  ***************************************************************************/
 
 #include "customtrackscene.h"
+#include "abstractclipitem.h"
 #include "timeline.h"
+#include "mltcontroller/clipcontroller.h"
+
+#include <algorithm>
+#include <cmath>
 
 
 CustomTrackScene::CustomTrackScene(Timeline *timeline, QObject *parent) :
@@ -26,12 +31,160 @@ CustomTrackScene::CustomTrackScene(Timeline *timeline, QObject *parent) :
         isZooming(false),
         m_timeline(timeline),
         m_scale(1.0, 1.0),
-        m_editMode(NormalEdit)
+        m_editMode(NormalEdit),
+        m_markersRevision(ClipController::markersRevision()),
+        m_snapExcluded(NULL),
+        m_snapSkipSelected(false)
 {
 }
 
 CustomTrackScene::~CustomTrackScene()
 {
+    // Delete items while the index still exists, they remove themselves from it
+    clear();
+}
+
+void CustomTrackScene::updateIndex(AbstractClipItem *item)
+{
+    // The length or the markers may have changed even if the start did not
+    updateSnaps(item);
+    IndexEntry entry;
+    entry.track = qMakePair(item->type(), item->track());
+    entry.start = (int) item->startPos().frames(item->fps());
+    QHash <AbstractClipItem *, IndexEntry>::iterator it = m_indexedItems.find(item);
+    if (it != m_indexedItems.end()) {
+        if (it->track == entry.track && it->start == entry.start) return;
+        m_trackIndex[it->track].remove(it->start, item);
+        *it = entry;
+    } else {
+        m_indexedItems.insert(item, entry);
+    }
+    m_trackIndex[entry.track].insert(entry.start, item);
+}
+
+void CustomTrackScene::removeFromIndex(AbstractClipItem *item)
+{
+    removeSnaps(item);
+    QHash <AbstractClipItem *, IndexEntry>::iterator it = m_indexedItems.find(item);
+    if (it == m_indexedItems.end()) return;
+    m_trackIndex[it->track].remove(it->start, item);
+    m_indexedItems.erase(it);
+}
+
+AbstractClipItem *CustomTrackScene::itemAt(int type, int track, int frame) const
+{
+    QMap <QPair <int, int>, QMultiMap <int, AbstractClipItem *> >::const_iterator t = m_trackIndex.constFind(qMakePair(type, track));
+    if (t == m_trackIndex.constEnd()) return NULL;
+    const QMultiMap <int, AbstractClipItem *> &items = t.value();
+    QMultiMap <int, AbstractClipItem *>::const_iterator it = items.upperBound(frame);
+    while (it != items.constBegin()) {
+        --it;
+        AbstractClipItem *item = it.value();
+        if ((int) item->endPos().frames(item->fps()) <= frame) {
+            // Items before this one end even earlier
+            break;
+        }
+        if (item->isEnabled()) return item;
+    }
+    return NULL;
+}
+
+AbstractClipItem *CustomTrackScene::itemStartingAt(int type, int track, int frame) const
+{
+    QMap <QPair <int, int>, QMultiMap <int, AbstractClipItem *> >::const_iterator t = m_trackIndex.constFind(qMakePair(type, track));
+    if (t == m_trackIndex.constEnd()) return NULL;
+    QMultiMap <int, AbstractClipItem *>::const_iterator it = t->constFind(frame);
+    for (; it != t->constEnd() && it.key() == frame; ++it) {
+        if (it.value()->isEnabled()) return it.value();
+    }
+    return NULL;
+}
+
+void CustomTrackScene::updateSnaps(AbstractClipItem *item)
+{
+    QList <int> frames = item->snapFrames();
+    QHash <AbstractClipItem *, QList <int> >::iterator it = m_itemSnaps.find(item);
+    if (it != m_itemSnaps.end()) {
+        if (*it == frames) return;
+        foreach (int frame, *it) {
+            m_snapIndex.remove(frame, item);
+        }
+        *it = frames;
+    } else {
+        m_itemSnaps.insert(item, frames);
+    }
+    foreach (int frame, frames) {
+        m_snapIndex.insert(frame, item);
+    }
+}
+
+void CustomTrackScene::removeSnaps(AbstractClipItem *item)
+{
+    if (item == m_snapExcluded) m_snapExcluded = NULL;
+    QHash <AbstractClipItem *, QList <int> >::iterator it = m_itemSnaps.find(item);
+    if (it == m_itemSnaps.end()) return;
+    foreach (int frame, *it) {
+        m_snapIndex.remove(frame, item);
+    }
+    m_itemSnaps.erase(it);
+}
+
+void CustomTrackScene::setSnapOptions(AbstractClipItem *excluded, const QList <GenTime> &offsets, bool skipSelected, const QList <GenTime> &extraSnaps)
+{
+    const double fps = m_timeline->fps();
+    m_snapExcluded = excluded;
+    m_snapSkipSelected = skipSelected;
+    m_snapOffsets.clear();
+    foreach (const GenTime &offset, offsets) {
+        m_snapOffsets << (int) offset.frames(fps);
+    }
+    m_extraSnaps.clear();
+    foreach (const GenTime &snap, extraSnaps) {
+        m_extraSnaps << (int) snap.frames(fps);
+    }
+    std::sort(m_extraSnaps.begin(), m_extraSnaps.end());
+
+    const int revision = ClipController::markersRevision();
+    if (revision != m_markersRevision) {
+        // Markers were added or removed in the bin since the last query
+        m_markersRevision = revision;
+        QList <AbstractClipItem *> items = m_itemSnaps.keys();
+        foreach (AbstractClipItem *item, items) {
+            if (item->type() == AVWidget) updateSnaps(item);
+        }
+    }
+}
+
+bool CustomTrackScene::isSnapExcluded(AbstractClipItem *item) const
+{
+    return item == m_snapExcluded || (m_snapSkipSelected && item->isSelected());
+}
+
+bool CustomTrackScene::indexSnap(int frame, int offsetIndex, bool before, int *result) const
+{
+    // Points are only proposed minus an offset if they are after it
+    const int offset = offsetIndex < 0 ? 0 : m_snapOffsets.at(offsetIndex);
+    if (before) {
+        QMultiMap <int, AbstractClipItem *>::const_iterator it = m_snapIndex.lowerBound(frame + offset);
+        while (it != m_snapIndex.constBegin()) {
+            --it;
+            if (offsetIndex >= 0 && it.key() <= offset) return false;
+            if (!isSnapExcluded(it.value())) {
+                *result = it.key() - offset;
+                return true;
+            }
+        }
+        return false;
+    }
+    QMultiMap <int, AbstractClipItem *>::const_iterator it = m_snapIndex.upperBound(frame + offset);
+    for (; it != m_snapIndex.constEnd(); ++it) {
+        if (offsetIndex >= 0 && it.key() <= offset) continue;
+        if (!isSnapExcluded(it.value())) {
+            *result = it.key() - offset;
+            return true;
+        }
+    }
+    return false;
 }
 
 double CustomTrackScene::getSnapPointForPos(double pos, bool doSnap)
@@ -40,41 +193,75 @@ double CustomTrackScene::getSnapPointForPos(double pos, bool doSnap)
         double maximumOffset;
         if (m_scale.x() > 3) maximumOffset = 10 / m_scale.x();
         else maximumOffset = 6 / m_scale.x();
-        for (int i = 0; i < m_snapPoints.size(); ++i) {
-            if (qAbs((int)(pos - m_snapPoints.at(i).frames(m_timeline->fps()))) < maximumOffset) {
-                return m_snapPoints.at(i).frames(m_timeline->fps());
+        // Find the first point in range, the distance is truncated so start one frame before
+        const int first = (int) floor(pos - maximumOffset) - 1;
+        bool found = false;
+        int best = 0;
+        for (int i = -1; i < m_snapOffsets.count(); ++i) {
+            int frame = first - 1;
+            while (indexSnap(frame, i, false, &frame) && (!found || frame < best)) {
+                if (qAbs((int)(pos - frame)) < maximumOffset) {
+                    best = frame;
+                    found = true;
+                    break;
+                }
+                if (frame > pos) break;
             }
-            if (m_snapPoints.at(i).frames(m_timeline->fps()) > pos)
+        }
+        QList <int>::const_iterator it = std::lower_bound(m_extraSnaps.constBegin(), m_extraSnaps.constEnd(), first);
+        for (; it != m_extraSnaps.constEnd() && (!found || *it < best); ++it) {
+            if (qAbs((int)(pos - *it)) < maximumOffset) {
+                best = *it;
+                found = true;
                 break;
+            }
+            if (*it > pos) break;
         }
+        if (found) return best;
     }
     return GenTime(pos, m_timeline->fps()).frames(m_timeline->fps());
 }
 
-void CustomTrackScene::setSnapList(const QList <GenTime>& snaps)
-{
-    m_snapPoints = snaps;
-}
-
 GenTime CustomTrackScene::previousSnapPoint(const GenTime &pos) const
 {
-    for (int i = 0; i < m_snapPoints.size(); ++i) {
-        if (m_snapPoints.at(i) >= pos) {
-            if (i == 0) return GenTime();
-            return m_snapPoints.at(i - 1);
+    const int current = (int) pos.frames(m_timeline->fps());
+    bool found = false;
+    int best = 0;
+    int frame;
+    for (int i = -1; i < m_snapOffsets.count(); ++i) {
+        if (indexSnap(current, i, true, &frame) && (!found || frame > best)) {
+            best = frame;
+            found = true;
         }
     }
-    return GenTime();
+    QList <int>::const_iterator it = std::lower_bound(m_extraSnaps.constBegin(), m_extraSnaps.constEnd(), current);
+    if (it != m_extraSnaps.constBegin() && (!found || *(it - 1) > best)) {
+        best = *(it - 1);
+        found = true;
+    }
+    if (!found) return GenTime();
+    return GenTime(best, m_timeline->fps());
 }
 
 GenTime CustomTrackScene::nextSnapPoint(const GenTime &pos) const
 {
-    foreach (const GenTime &seekPoint, m_snapPoints) {
-        if (seekPoint > pos) {
-            return seekPoint;
+    const int current = (int) pos.frames(m_timeline->fps());
+    bool found = false;
+    int best = 0;
+    int frame;
+    for (int i = -1; i < m_snapOffsets.count(); ++i) {
+        if (indexSnap(current, i, false, &frame) && (!found || frame < best)) {
+            best = frame;
+            found = true;
         }
     }
-    return pos;
+    QList <int>::const_iterator it = std::upper_bound(m_extraSnaps.constBegin(), m_extraSnaps.constEnd(), current);
+    if (it != m_extraSnaps.constEnd() && (!found || *it < best)) {
+        best = *it;
+        found = true;
+    }
+    if (!found) return pos;
+    return GenTime(best, m_timeline->fps());
 }
 
 void CustomTrackScene::setScale(double scale, double vscale)
@@ -94,6 +281,11 @@ int CustomTrackScene::tracksCount() const
     return m_timeline->visibleTracksCount();
 }
 
+Timeline *CustomTrackScene::timeline() const
+{
+    return m_timeline;
+}
+
 MltVideoProfile CustomTrackScene::profile() const
 {
     return m_timeline->mltProfile();
@@ -27,12 +27,15 @@
 #define CUSTOMTRACKSCENE_H
 
 #include <QList>
+#include <QHash>
+#include <QMap>
 #include <QGraphicsScene>
 
 #include "gentime.h"
 
 class Timeline;
 class MltVideoProfile;
+class AbstractClipItem;
 
 enum EditMode {
     NormalEdit = 0,
@@ -49,7 +52,12 @@ class CustomTrackScene : public QGraphicsScene
 public:
     explicit CustomTrackScene(Timeline *timeline, QObject *parent = 0);
     ~CustomTrackScene();
-    void setSnapList(const QList <GenTime>& snaps);
+    /** @brief Sets how the snap index is queried until the next call.
+     *  @param excluded an item whose points are ignored (for example the one being resized)
+     *  @param offsets each point is also proposed minus these offsets (duration of the moved items)
+     *  @param skipSelected ignore points of the selected items
+     *  @param extraSnaps cursor, guides and zone positions, offsets already applied */
+    void setSnapOptions(AbstractClipItem *excluded, const QList <GenTime> &offsets, bool skipSelected, const QList <GenTime> &extraSnaps);
     GenTime previousSnapPoint(const GenTime &pos) const;
     GenTime nextSnapPoint(const GenTime &pos) const;
     double getSnapPointForPos(double pos, bool doSnap = true);
@@ -57,15 +65,51 @@ public:
     QPointF scale() const;
     int tracksCount() const;
     MltVideoProfile profile() const;
+    Timeline *timeline() const;
     void setEditMode(EditMode mode);
     EditMode editMode() const;
     bool isZooming;
 
+    /** @brief Updates the entries of a clip or transition in the track and snap indexes, called when its position or length changed. */
+    void updateIndex(AbstractClipItem *item);
+    /** @brief Removes a clip or transition from the track and snap indexes. */
+    void removeFromIndex(AbstractClipItem *item);
+    /** @brief Returns the enabled item of @param type (AVWidget or TransitionWidget) on @param track covering @param frame, or NULL. */
+    AbstractClipItem *itemAt(int type, int track, int frame) const;
+    /** @brief Returns the enabled item of @param type on @param track starting at @param frame, or NULL. */
+    AbstractClipItem *itemStartingAt(int type, int track, int frame) const;
+
 private:
     Timeline *m_timeline;
     QPointF m_scale;
     EditMode m_editMode;
-    QList <GenTime> m_snapPoints;
+    /** @brief Clips and transitions of each (type, track) by start frame, as stored in their ItemInfo.
+     *  Items on a track do not overlap, so the item covering a frame is the last one starting before it. */
+    QMap <QPair <int, int>, QMultiMap <int, AbstractClipItem *> > m_trackIndex;
+    struct IndexEntry {
+        QPair <int, int> track;
+        int start;
+    };
+    /** @brief Where each item is stored in m_trackIndex. */
+    QHash <AbstractClipItem *, IndexEntry> m_indexedItems;
+    /** @brief Snap frames of all clips and transitions (edges and clip markers) with the item they belong to. */
+    QMultiMap <int, AbstractClipItem *> m_snapIndex;
+    /** @brief The frames each item has in m_snapIndex. */
+    QHash <AbstractClipItem *, QList <int> > m_itemSnaps;
+    /** @brief Value of ClipController::markersRevision() when clip markers were last read. */
+    int m_markersRevision;
+    /** @brief Query options, see setSnapOptions(). */
+    AbstractClipItem *m_snapExcluded;
+    QList <int> m_snapOffsets;
+    bool m_snapSkipSelected;
+    /** @brief Sorted frames of the cursor, guides and zone. */
+    QList <int> m_extraSnaps;
+    void updateSnaps(AbstractClipItem *item);
+    void removeSnaps(AbstractClipItem *item);
+    bool isSnapExcluded(AbstractClipItem *item) const;
+    /** @brief Returns the item point minus @param offsetIndex offset (-1 for no offset) nearest to @param frame, before or after it.
+     *  @return false if there is none */
+    bool indexSnap(int frame, int offsetIndex, bool before, int *result) const;
 };
 
 #endif
@@ -3244,7 +3244,8 @@ void CustomTrackView::addTrack(const TrackInfo &type, int ix)
         }
     }
 
-    // insert track in MLT's playlist
+    // insert track in MLT's playlist, below the preview and overlay tracks
+    m_timeline->connectOverlayTrack(false);
     transitionInfos = m_document->renderer()->mltInsertTrack(ix,  type.trackName, type.type == VideoTrack);
     Mlt::Tractor *tractor = m_document->renderer()->lockService();
     // When adding a track, MLT sometimes incorrectly updates transition's tracks
@@ -3258,8 +3259,9 @@ void CustomTrackView::addTrack(const TrackInfo &type, int ix)
     // Check we have composite transitions where necessary
     m_timeline->updateComposites();
     m_document->renderer()->unlockService(tractor);
-    // Reload timeline and m_tracks structure from MLT's playlist
+    // Reload timeline and m_tracks structure from MLT's playlist, before the preview track is back
     reloadTimeline();
+    m_timeline->connectOverlayTrack(true);
     loadGroups(groups);
 }
 
@@ -3291,6 +3293,8 @@ void CustomTrackView::removeTrack(int ix)
     clearSelection();
     emit transitionItemSelected(NULL);
 
+    // Track indexes of the preview and overlay tracks change, take them out
+    m_timeline->connectOverlayTrack(false);
     //Delete composite transition
     Mlt::Tractor *tractor = m_document->renderer()->lockService();
     QScopedPointer<Mlt::Field> field(tractor->field());
@@ -3341,6 +3345,7 @@ void CustomTrackView::removeTrack(int ix)
     m_timeline->updateComposites();
     m_document->renderer()->unlockService(tractor);
     reloadTimeline();
+    m_timeline->connectOverlayTrack(true);
     loadGroups(groups);
 }
 
@@ -4925,67 +4930,42 @@ void CustomTrackView::slotUpdateClip(const QString &clipId, bool reload)
     m_document->renderer()->unlockService(tractor);
 }
 
+// The track index is based on the clip infos, check that the item is really displayed there (it could be dragged in a group)
+static bool isAtScenePoint(QGraphicsItem *item, const QPointF &p)
+{
+    return item && item->contains(item->mapFromScene(p));
+}
+
 ClipItem *CustomTrackView::getClipItemAtEnd(GenTime pos, int track)
 {
     int framepos = (int)(pos.frames(m_document->fps()));
-    QList<QGraphicsItem *> list = scene()->items(QPointF(framepos - 1, getPositionFromTrack(track) + m_tracksHeight / 2));
-    ClipItem *clip = NULL;
-    for (int i = 0; i < list.size(); ++i) {
-        if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == AVWidget) {
-            ClipItem *test = static_cast <ClipItem *>(list.at(i));
-            if (test->endPos() == pos) clip = test;
-            break;
-        }
-    }
-    return clip;
+    AbstractClipItem *item = m_scene->itemAt(AVWidget, track, framepos - 1);
+    if (!isAtScenePoint(item, QPointF(framepos - 1, getPositionFromTrack(track) + m_tracksHeight / 2))) return NULL;
+    ClipItem *clip = static_cast <ClipItem *>(item);
+    return clip->endPos() == pos ? clip : NULL;
 }
 
 ClipItem *CustomTrackView::getClipItemAtStart(GenTime pos, int track)
 {
-    QList<QGraphicsItem *> list = scene()->items(QPointF(pos.frames(m_document->fps()), getPositionFromTrack(track) + m_tracksHeight / 2));
-    ClipItem *clip = NULL;
-    for (int i = 0; i < list.size(); ++i) {
-        if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == AVWidget) {
-            ClipItem *test = static_cast <ClipItem *>(list.at(i));
-            if (test->startPos() == pos) {
-	      clip = test;
-	      break;
-	    }
-        }
-    }
-    return clip;
+    int framepos = (int)(pos.frames(m_document->fps()));
+    AbstractClipItem *item = m_scene->itemStartingAt(AVWidget, track, framepos);
+    if (!isAtScenePoint(item, QPointF(framepos, getPositionFromTrack(track) + m_tracksHeight / 2))) return NULL;
+    ClipItem *clip = static_cast <ClipItem *>(item);
+    return clip->startPos() == pos ? clip : NULL;
 }
 
 ClipItem *CustomTrackView::getClipItemAtMiddlePoint(int pos, int track)
 {
-    const QPointF p(pos, getPositionFromTrack(track) + m_tracksHeight / 2);
-    QList<QGraphicsItem *> list = scene()->items(p);
-    ClipItem *clip = NULL;
-    for (int i = 0; i < list.size(); ++i) {
-        if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == AVWidget) {
-            clip = static_cast <ClipItem *>(list.at(i));
-            break;
-        }
-    }
-    return clip;
+    AbstractClipItem *item = m_scene->itemAt(AVWidget, track, pos);
+    if (!isAtScenePoint(item, QPointF(pos, getPositionFromTrack(track) + m_tracksHeight / 2))) return NULL;
+    return static_cast <ClipItem *>(item);
 }
 
 Transition *CustomTrackView::getTransitionItemAt(int pos, int track)
 {
-    const QPointF p(pos, getPositionFromTrack(track) + Transition::itemOffset() + 1);
-    QList<QGraphicsItem *> list = scene()->items(p);
-    Transition *clip = NULL;
-    for (int i = 0; i < list.size(); ++i) {
-        if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == TransitionWidget) {
-            clip = static_cast <Transition *>(list.at(i));
-            break;
-        }
-    }
-    return clip;
+    AbstractClipItem *item = m_scene->itemAt(TransitionWidget, track, pos);
+    if (!isAtScenePoint(item, QPointF(pos, getPositionFromTrack(track) + Transition::itemOffset() + 1))) return NULL;
+    return static_cast <Transition *>(item);
 }
 
 Transition *CustomTrackView::getTransitionItemAt(GenTime pos, int track)
@@ -4996,34 +4976,19 @@ Transition *CustomTrackView::getTransitionItemAt(GenTime pos, int track)
 Transition *CustomTrackView::getTransitionItemAtEnd(GenTime pos, int track)
 {
     int framepos = (int)(pos.frames(m_document->fps()));
-    const QPointF p(framepos - 1, getPositionFromTrack(track) + Transition::itemOffset() + 1);
-    QList<QGraphicsItem *> list = scene()->items(p);
-    Transition *clip = NULL;
-    for (int i = 0; i < list.size(); ++i) {
-        if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == TransitionWidget) {
-            Transition *test = static_cast <Transition *>(list.at(i));
-            if (test->endPos() == pos) clip = test;
-            break;
-        }
-    }
-    return clip;
+    AbstractClipItem *item = m_scene->itemAt(TransitionWidget, track, framepos - 1);
+    if (!isAtScenePoint(item, QPointF(framepos - 1, getPositionFromTrack(track) + Transition::itemOffset() + 1))) return NULL;
+    Transition *tr = static_cast <Transition *>(item);
+    return tr->endPos() == pos ? tr : NULL;
 }
 
 Transition *CustomTrackView::getTransitionItemAtStart(GenTime pos, int track)
 {
-    const QPointF p(pos.frames(m_document->fps()), getPositionFromTrack(track) + Transition::itemOffset() + 1);
-    QList<QGraphicsItem *> list = scene()->items(p);
-    Transition *clip = NULL;
-    for (int i = 0; i < list.size(); ++i) {
-        if (!list.at(i)->isEnabled()) continue;
-        if (list.at(i)->type() == TransitionWidget) {
-            Transition *test = static_cast <Transition *>(list.at(i));
-            if (test->startPos() == pos) clip = test;
-            break;
-        }
-    }
-    return clip;
+    int framepos = (int)(pos.frames(m_document->fps()));
+    AbstractClipItem *item = m_scene->itemStartingAt(TransitionWidget, track, framepos);
+    if (!isAtScenePoint(item, QPointF(framepos, getPositionFromTrack(track) + Transition::itemOffset() + 1))) return NULL;
+    Transition *tr = static_cast <Transition *>(item);
+    return tr->startPos() == pos ? tr : NULL;
 }
 
 bool CustomTrackView::moveClip(const ItemInfo &start, const ItemInfo &end, bool refresh, ItemInfo *out_actualEnd)
@@ -5094,6 +5059,11 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
     m_selectionGroup = new AbstractGroupItem(m_document->fps());
     scene()->addItem(m_selectionGroup);
 
+    // Cuts are taken out of the playlists and put back with their filters,
+    // all in one locked pass of the tractor with a single refresh at the end
+    Mlt::Tractor *tractor = m_document->renderer()->lockService();
+    QHash <ClipItem *, Mlt::Producer *> cuts;
+    QHash <Transition *, TransitionInfo> oldTransitions;
     m_document->renderer()->blockSignals(true);
     for (int i = 0; i < startClip.count(); ++i) {
         if (reverseMove) {
@@ -5108,7 +5078,14 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
             } else {
                 m_selectionGroup->addItem(clip);
             }
-            m_timeline->track(startClip.at(i).track)->del(startClip.at(i).startPos.seconds());
+            // A clip loaded from the project still parses its effects from this cut,
+            // build them before insertCut() moves the filters to a new cut
+            clip->loadPendingEffects();
+            Track *track = m_timeline->track(startClip.at(i).track);
+            track->playlist().lock();
+            Mlt::Producer *cut = track->takeCut(startClip.at(i).startPos.seconds());
+            track->playlist().unlock();
+            if (cut) cuts.insert(clip, cut);
         } else qDebug() << "//MISSING CLIP AT: " << startClip.at(i).startPos.frames(25)<<" / track: "<<startClip.at(i).track<<" / OFFSET: "<<trackOffset;
     }
     for (int i = 0; i < startTransition.count(); ++i) {
@@ -5124,7 +5101,12 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
             } else {
                 m_selectionGroup->addItem(tr);
             }
-            m_timeline->transitionHandler->deleteTransition(tr->transitionTag(), tr->transitionEndTrack(), startTransition.at(i).track, startTransition.at(i).startPos, startTransition.at(i).endPos, tr->toXML());
+            TransitionInfo trInfo;
+            trInfo.startPos = startTransition.at(i).startPos;
+            trInfo.endPos = startTransition.at(i).endPos;
+            trInfo.b_track = startTransition.at(i).track;
+            trInfo.a_track = tr->transitionEndTrack();
+            oldTransitions.insert(tr, trInfo);
         } else qDebug() << "//MISSING TRANSITION AT: " << startTransition.at(i).startPos.frames(25);
     }
     m_document->renderer()->blockSignals(false);
@@ -5136,6 +5118,8 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
         m_selectionGroup->setTransform(QTransform::fromTranslate(offset.frames(m_document->fps()), -trackOffset *(qreal) m_tracksHeight), true);
         //m_selectionGroup->moveBy(offset.frames(m_document->fps()), trackOffset *(qreal) m_tracksHeight);
 
+        QList <TransitionMove> transitionMoves;
+        QList <Transition *> movedTransitions;
         QList<QGraphicsItem *> children = m_selectionGroup->childItems();
         QList <AbstractGroupItem*> groupList;
         // Expand groups
@@ -5168,6 +5152,16 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
 
             if (item->type() == AVWidget) {
                 ClipItem *clip = static_cast <ClipItem*>(item);
+                Mlt::Producer *cut = cuts.take(clip);
+                if (cut) {
+                    Track *track = m_timeline->track(info.track);
+                    track->playlist().lock();
+                    track->insertCut(info.startPos.seconds(), cut, clip->clipState(), m_scene->editMode());
+                    track->playlist().unlock();
+                    delete cut;
+                    continue;
+                }
+                // Clip was not found in its playlist, create it again
                 Mlt::Producer *prod;
                 if (clip->clipState() == PlaylistState::VideoOnly) {
                     prod = m_document->renderer()->getBinVideoProducer(clip->getBinId());
@@ -5190,9 +5184,32 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
                     if (newTrack < 0 || newTrack > m_timeline->tracksCount()) newTrack = getPreviousVideoTrack(info.track);
                 }
                 tr->updateTransitionEndTrack(newTrack);
-                m_timeline->transitionHandler->addTransition(tr->transitionTag(), newTrack, info.track, info.startPos, info.endPos, tr->toXML());
+                if (oldTransitions.contains(tr)) {
+                    TransitionMove move;
+                    move.tag = tr->transitionTag();
+                    move.oldInfo = oldTransitions.value(tr);
+                    move.newInfo.startPos = info.startPos;
+                    move.newInfo.endPos = info.endPos;
+                    move.newInfo.b_track = info.track;
+                    move.newInfo.a_track = newTrack;
+                    transitionMoves << move;
+                    movedTransitions << tr;
+                } else {
+                    m_timeline->transitionHandler->addTransition(tr->transitionTag(), newTrack, info.track, info.startPos, info.endPos, tr->toXML(), false);
+                }
             }
         }
+        QList <int> missingTransitions;
+        m_timeline->transitionHandler->moveTransitions(transitionMoves, &missingTransitions);
+        // Transitions that were not found in MLT are planted again at their new place
+        foreach (int index, missingTransitions) {
+            const TransitionMove &move = transitionMoves.at(index);
+            Transition *tr = movedTransitions.at(index);
+            m_timeline->transitionHandler->addTransition(move.tag, move.newInfo.a_track, move.newInfo.b_track, move.newInfo.startPos, move.newInfo.endPos, tr->toXML(), false);
+        }
+        // Clips that were not moved back in the timeline
+        qDeleteAll(cuts);
+        m_document->renderer()->unlockService(tractor);
         m_selectionMutex.unlock();
         resetSelectionGroup(false);
         for (int i = 0; i < groupList.count(); ++i) {
@@ -5203,7 +5220,11 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
 
         KdenliveSettings::setSnaptopoints(snap);
         m_document->renderer()->doRefresh();
-    } else qDebug() << "///////// WARNING; NO GROUP TO MOVE";
+    } else {
+        qDeleteAll(cuts);
+        m_document->renderer()->unlockService(tractor);
+        qDebug() << "///////// WARNING; NO GROUP TO MOVE";
+    }
 }
 
 void CustomTrackView::moveTransition(const ItemInfo &start, const ItemInfo &end, bool refresh)
@@ -5654,55 +5675,9 @@ double CustomTrackView::getSnapPointForPos(double pos)
 
 void CustomTrackView::updateSnapPoints(AbstractClipItem *selected, QList <GenTime> offsetList, bool skipSelectedItems)
 {
+    // Clips, transitions and their markers are kept in the scene's snap index
     QList <GenTime> snaps;
     if (selected && offsetList.isEmpty()) offsetList.append(selected->cropDuration());
-    QList<QGraphicsItem *> itemList = items();
-    for (int i = 0; i < itemList.count(); ++i) {
-        if (itemList.at(i) == selected) continue;
-        if (skipSelectedItems && itemList.at(i)->isSelected()) continue;
-        if (itemList.at(i)->type() == AVWidget) {
-            ClipItem *item = static_cast <ClipItem *>(itemList.at(i));
-            if (!item) continue;
-            GenTime start = item->startPos();
-            GenTime end = item->endPos();
-            snaps.append(start);
-            snaps.append(end);
-            if (!offsetList.isEmpty()) {
-                for (int j = 0; j < offsetList.size(); ++j) {
-                    if (start > offsetList.at(j)) snaps.append(start - offsetList.at(j));
-                    if (end > offsetList.at(j)) snaps.append(end - offsetList.at(j));
-                }
-            }
-            // Add clip markers
-            ClipController *controller = m_document->getClipController(item->getBinId());
-            if (!controller) {
-                qDebug()<<" + + ++ WARN, NO CTLRR!!!";
-            }
-            QList < GenTime > markers = item->snapMarkers(controller->snapMarkers());
-            for (int j = 0; j < markers.size(); ++j) {
-                GenTime t = markers.at(j);
-                snaps.append(t);
-                if (!offsetList.isEmpty()) {
-                    for (int k = 0; k < offsetList.size(); ++k) {
-                        if (t > offsetList.at(k)) snaps.append(t - offsetList.at(k));
-                    }
-                }
-            }
-        } else if (itemList.at(i)->type() == TransitionWidget) {
-            Transition *transition = static_cast <Transition*>(itemList.at(i));
-            if (!transition) continue;
-            GenTime start = transition->startPos();
-            GenTime end = transition->endPos();
-            snaps.append(start);
-            snaps.append(end);
-            if (!offsetList.isEmpty()) {
-                for (int j = 0; j < offsetList.size(); ++j) {
-                    if (start > offsetList.at(j)) snaps.append(start - offsetList.at(j));
-                    if (end > offsetList.at(j)) snaps.append(end - offsetList.at(j));
-                }
-            }
-        }
-    }
 
     // add cursor position
     GenTime pos = GenTime(m_cursorPos, m_document->fps());
@@ -5728,10 +5703,7 @@ void CustomTrackView::updateSnapPoints(AbstractClipItem *selected, QList <GenTim
     snaps.append(GenTime(z.x(), m_document->fps()));
     snaps.append(GenTime(z.y(), m_document->fps()));
 
-    qSort(snaps);
-    m_scene->setSnapList(snaps);
-    //for (int i = 0; i < m_snapPoints.size(); ++i)
-    //    //qDebug() << "SNAP POINT: " << m_snapPoints.at(i).frames(25);
+    m_scene->setSnapOptions(selected, offsetList, skipSelectedItems, snaps);
 }
 
 void CustomTrackView::slotSeekToPreviousSnap()
@@ -6556,7 +6528,8 @@ void CustomTrackView::slotUpdateAllThumbs()
     for (int i = 0; i < itemList.count(); ++i) {
         if (itemList.at(i)->type() == AVWidget) {
             item = static_cast <ClipItem *>(itemList.at(i));
-            if (item && item->isEnabled() && item->clipType() != Color && item->clipType() != Audio) {
+            // Clips that were not displayed yet fetch their thumbnails on first paint
+            if (item && item->isEnabled() && !item->hasPendingLoad() && item->clipType() != Color && item->clipType() != Audio) {
                 // Check if we have a cached thumbnail
                 if (item->clipType() == Image || item->clipType() == Text) {
                     QString thumb = thumbBase + item->getBinHash() + "#0.png";
@@ -6917,7 +6890,7 @@ void CustomTrackView::setAudioAlignReference()
             }
             AudioEnvelope *envelope = new AudioEnvelope(clip->binClip()->url().path(), prod);
             m_audioCorrelator = new AudioCorrelation(envelope);
-            connect(m_audioCorrelator, SIGNAL(gotAudioAlignData(int,int,int)), this, SLOT(slotAlignClip(int,int,int)));
+            connect(m_audioCorrelator, SIGNAL(gotAudioAlignData(int,int,int,double)), this, SLOT(slotAlignClip(int,int,int,double)));
             connect(m_audioCorrelator, SIGNAL(displayMessage(QString,MessageType)), this, SIGNAL(displayMessage(QString,MessageType)));
             emit displayMessage(i18n("Processing audio, please wait."), ProcessingJobMessage);
         }
@@ -6971,7 +6944,7 @@ void CustomTrackView::alignAudio()
     emit displayMessage(i18n("Processing audio, please wait."), ProcessingJobMessage);
 }
 
-void CustomTrackView::slotAlignClip(int track, int pos, int shift)
+void CustomTrackView::slotAlignClip(int track, int pos, int shift, double confidence)
 {
     QUndoCommand *moveCommand = new QUndoCommand();
     ClipItem *clip = getClipItemAtStart(GenTime(pos, m_document->fps()), track);
@@ -7009,7 +6982,13 @@ void CustomTrackView::slotAlignClip(int track, int pos, int shift)
         emit displayMessage(i18n("Unable to move clip due to collision."), ErrorMessage);
         return;
     }
-    emit displayMessage(i18n("Clip aligned."), OperationCompletedMessage);
+    const int percent = qRound(confidence * 100);
+    if (confidence < 0.3) {
+        // Most likely no common audio, the user should check the result
+        emit displayMessage(i18n("Clip aligned with low confidence (%1%).", percent), InformationMessage);
+    } else {
+        emit displayMessage(i18n("Clip aligned (confidence %1%).", percent), OperationCompletedMessage);
+    }
     moveCommand->setText(i18n("Auto-align clip"));
     new MoveClipCommand(this, start, end, true, moveCommand);
     updateTrackDuration(clip->track(), moveCommand);
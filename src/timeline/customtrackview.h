@@ -330,7 +330,8 @@ public slots:
     void slotAlignPlayheadToMousePos();
 
     void slotInfoProcessingFinished();
-    void slotAlignClip(int, int, int);
+    /** @brief Moves the clip at @param pos on @param track by the @param shift found by the audio alignment. */
+    void slotAlignClip(int track, int pos, int shift, double confidence);
     /** @brief Export part of the playlist in an xml file */
     void exportTimelineSelection(QString path = QString());
 
@@ -0,0 +1,404 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "previewmanager.h"
+#include "../customruler.h"
+#include "../timeline.h"
+#include "doc/kdenlivedoc.h"
+#include "project/projectmanager.h"
+#include "renderer.h"
+#include "kdenlivesettings.h"
+#include "core.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QThread>
+#include <QUndoStack>
+#include <QtConcurrent>
+#include <QDebug>
+
+static const char previewTrackId[] = "timeline_preview";
+
+/** Appends the properties that affect rendering, MLT's private properties and kdenlive's metadata are skipped. */
+static void appendProperties(QByteArray &data, Mlt::Properties &properties)
+{
+    for (int i = 0; i < properties.count(); ++i) {
+        const char *name = properties.get_name(i);
+        if (name == NULL || name[0] == '_' || qstrncmp(name, "meta.", 5) == 0 || qstrncmp(name, "kdenlive:", 9) == 0) continue;
+        data.append(name).append('=').append(properties.get(i)).append(';');
+    }
+}
+
+static void appendFilters(QByteArray &data, Mlt::Service &service)
+{
+    for (int i = 0; i < service.filter_count(); ++i) {
+        QScopedPointer<Mlt::Filter> filter(service.filter(i));
+        // Disabled effects do not change the output, toggling them back finds the previous chunks
+        if (filter->get_int("disable") == 1) continue;
+        data.append("filter:");
+        appendProperties(data, *filter);
+    }
+}
+
+/** Appends data to all chunks between in and out, data is preceded by its offset from the chunk start. */
+static void appendToChunks(QMap <int, QByteArray> &chunks, int chunkSize, int in, int out, const QByteArray &data)
+{
+    for (int frame = in - in % chunkSize; frame <= out; frame += chunkSize) {
+        QMap <int, QByteArray>::iterator it = chunks.find(frame);
+        if (it == chunks.end()) continue;
+        it->append(QByteArray::number(in - frame)).append(data);
+    }
+}
+
+PreviewManager::PreviewManager(KdenliveDoc *doc, CustomRuler *ruler, Mlt::Tractor *tractor, Timeline *parent) :
+    QObject(parent)
+    , m_doc(doc)
+    , m_ruler(ruler)
+    , m_tractor(tractor)
+    , m_timeline(parent)
+    , m_previewTrack(NULL)
+    , m_connected(false)
+    , m_autoRender(false)
+    , m_cacheLoaded(false)
+{
+    m_extension = KdenliveSettings::previewextension();
+    m_chunkSize = qMax(1, KdenliveSettings::timelinechunks());
+    m_checkTimer.setSingleShot(true);
+    m_checkTimer.setInterval(1000);
+    connect(&m_checkTimer, &QTimer::timeout, this, &PreviewManager::slotCheckChunks);
+    connect(this, &PreviewManager::chunkRendered, this, &PreviewManager::gotRenderedChunk, Qt::QueuedConnection);
+}
+
+PreviewManager::~PreviewManager()
+{
+    abortRendering();
+    delete m_previewTrack;
+}
+
+bool PreviewManager::initialize()
+{
+    const QString documentId = m_doc->getDocumentProperty(QStringLiteral("documentid"));
+    if (documentId.isEmpty()) return false;
+    m_cacheDir.setPath(m_doc->projectFolder().path() + QStringLiteral("/preview/") + documentId);
+    if (!m_cacheDir.exists() && !m_cacheDir.mkpath(QStringLiteral("."))) {
+        qDebug() << "// Cannot create timeline preview folder: " << m_cacheDir.absolutePath();
+        return false;
+    }
+    m_previewTrack = new Mlt::Playlist(*m_tractor->profile());
+    m_previewTrack->set("kdenlive:playlistid", previewTrackId);
+    // Chunks are rendered without audio, the sound comes from the timeline tracks
+    m_previewTrack->set("hide", 2);
+    connect(m_doc->commandStack(), &QUndoStack::indexChanged, this, &PreviewManager::slotTimelineChanged);
+    return true;
+}
+
+void PreviewManager::loadCachedChunks()
+{
+    m_cacheLoaded = true;
+    // Reuse the chunks rendered in a previous session if their content did not change
+    m_chunkHashes = computeHashes();
+    const QStringList files = m_cacheDir.entryList(QStringList() << QStringLiteral("*.") + m_extension, QDir::Files);
+    m_tractor->lock();
+    foreach (const QString &fileName, files) {
+        bool ok;
+        const int frame = fileName.section(QLatin1Char('-'), 0, 0).toInt(&ok);
+        const QString file = m_cacheDir.absoluteFilePath(fileName);
+        if (ok && m_chunkHashes.contains(frame) && file == chunkFile(frame, m_chunkHashes.value(frame))) {
+            insertChunk(frame, file);
+        } else {
+            QFile::remove(file);
+        }
+    }
+    m_tractor->unlock();
+}
+
+void PreviewManager::disconnectTrack()
+{
+    if (!m_connected) return;
+    QScopedPointer<Mlt::Producer> top(m_tractor->track(m_tractor->count() - 1));
+    if (top && isPreviewTrack(*top)) {
+        m_tractor->remove_track(m_tractor->count() - 1);
+    }
+    m_connected = false;
+}
+
+void PreviewManager::reconnectTrack()
+{
+    if (m_connected || !m_previewTrack || !m_autoRender) return;
+    m_tractor->insert_track(*m_previewTrack, m_tractor->count());
+    m_connected = true;
+}
+
+bool PreviewManager::isConnected() const
+{
+    return m_connected;
+}
+
+//static
+bool PreviewManager::isPreviewTrack(Mlt::Producer &track)
+{
+    return qstrcmp(track.get("kdenlive:playlistid"), previewTrackId) == 0;
+}
+
+void PreviewManager::setAutoRender(bool enable)
+{
+    m_autoRender = enable;
+    if (enable) {
+        if (!m_cacheLoaded) loadCachedChunks();
+        slotCheckChunks();
+    } else {
+        abortRendering();
+        updateRuler();
+    }
+}
+
+void PreviewManager::abortRendering()
+{
+    if (!m_previewThread.isRunning()) return;
+    m_abortPreview.store(1);
+    m_previewThread.waitForFinished();
+    m_pendingChunks.clear();
+}
+
+void PreviewManager::slotTimelineChanged()
+{
+    m_checkTimer.start();
+}
+
+void PreviewManager::slotCheckChunks()
+{
+    if (!m_autoRender && m_renderedChunks.isEmpty() && m_pendingChunks.isEmpty()) {
+        // Nothing to invalidate, hashing waits until rendering is enabled
+        return;
+    }
+    m_chunkHashes = computeHashes();
+    bool removed = false;
+    m_tractor->lock();
+    foreach (int frame, m_renderedChunks.keys()) {
+        if (m_renderedChunks.value(frame) != chunkFile(frame, m_chunkHashes.value(frame))) {
+            removeChunk(frame);
+            removed = true;
+        }
+    }
+    m_tractor->unlock();
+    if (removed) m_doc->renderer()->doRefresh();
+    if (m_previewThread.isRunning()) {
+        // Restart if a chunk waiting to be rendered changed
+        QMap <int, QByteArray>::const_iterator it = m_pendingChunks.constBegin();
+        for (; it != m_pendingChunks.constEnd(); ++it) {
+            if (m_chunkHashes.value(it.key()) != it.value()) {
+                abortRendering();
+                break;
+            }
+        }
+    }
+    if (m_autoRender && !m_previewThread.isRunning()) startRendering();
+    updateRuler();
+}
+
+QMap <int, QByteArray> PreviewManager::computeHashes()
+{
+    QMap <int, QByteArray> chunks;
+    Mlt::Profile *profile = m_tractor->profile();
+    QByteArray header = QByteArray(profile->description()) + QByteArray::number(profile->width()) + 'x' + QByteArray::number(profile->height()) + '@' + QByteArray::number(profile->fps());
+    // Parent producers are shared by many cuts
+    QHash <mlt_service, QByteArray> parents;
+    QList <QByteArray> tracksData;
+    QList <Mlt::Playlist *> playlists;
+
+    m_tractor->lock();
+    int duration = 0;
+    for (int i = 0; i < m_timeline->tracksCount(); ++i) {
+        QScopedPointer<Mlt::Producer> track(m_tractor->track(i));
+        Mlt::Playlist *playlist = new Mlt::Playlist(*track);
+        duration = qMax(duration, playlist->get_playtime());
+        QByteArray trackData = "track:" + QByteArray::number(i) + ':' + QByteArray::number(track->get_int("hide"));
+        appendFilters(trackData, *playlist);
+        tracksData << trackData;
+        playlists << playlist;
+    }
+    for (int frame = 0; frame < duration; frame += m_chunkSize) {
+        chunks.insert(frame, header);
+    }
+    for (int i = 0; i < playlists.count(); ++i) {
+        Mlt::Playlist *playlist = playlists.at(i);
+        appendToChunks(chunks, m_chunkSize, 0, duration - 1, tracksData.at(i));
+        for (int j = 0; j < playlist->count(); ++j) {
+            if (playlist->is_blank(j)) continue;
+            QScopedPointer<Mlt::Producer> clip(playlist->get_clip(j));
+            mlt_service parentService = clip->parent().get_service();
+            QHash <mlt_service, QByteArray>::iterator parent = parents.find(parentService);
+            if (parent == parents.end()) {
+                QByteArray parentData = clip->parent().get("kdenlive:file_hash");
+                appendProperties(parentData, clip->parent());
+                appendFilters(parentData, clip->parent());
+                parent = parents.insert(parentService, QCryptographicHash::hash(parentData, QCryptographicHash::Md5));
+            }
+            QByteArray clipData = "clip:" + QByteArray::number(i) + ':' + QByteArray::number(clip->get_in()) + ':' + QByteArray::number(clip->get_out());
+            appendFilters(clipData, *clip);
+            clipData = parent.value() + QCryptographicHash::hash(clipData, QCryptographicHash::Md5);
+            const int start = playlist->clip_start(j);
+            appendToChunks(chunks, m_chunkSize, start, start + playlist->clip_length(j) - 1, clipData);
+        }
+    }
+    qDeleteAll(playlists);
+
+    QScopedPointer<Mlt::Field> field(m_tractor->field());
+    mlt_service nextservice = mlt_service_get_producer(field->get_service());
+    mlt_service_type type = mlt_service_identify(nextservice);
+    while (type == transition_type) {
+        Mlt::Transition transition((mlt_transition) nextservice);
+        nextservice = mlt_service_producer(nextservice);
+        QByteArray transitionData = "transition:";
+        appendProperties(transitionData, transition);
+        int in = transition.get_in();
+        int out = transition.get_out();
+        if (transition.get_int("always_active") == 1) {
+            in = 0;
+            out = duration - 1;
+        }
+        appendToChunks(chunks, m_chunkSize, in, qMin(out, duration - 1), QCryptographicHash::hash(transitionData, QCryptographicHash::Md5));
+        if (nextservice == NULL) break;
+        type = mlt_service_identify(nextservice);
+    }
+    m_tractor->unlock();
+
+    QMap <int, QByteArray>::iterator it = chunks.begin();
+    for (; it != chunks.end(); ++it) {
+        it.value() = QCryptographicHash::hash(it.value(), QCryptographicHash::Md5).toHex();
+    }
+    return chunks;
+}
+
+QString PreviewManager::chunkFile(int frame, const QByteArray &hash) const
+{
+    return m_cacheDir.absoluteFilePath(QString::number(frame) + QLatin1Char('-') + QString::fromLatin1(hash) + QLatin1Char('.') + m_extension);
+}
+
+QList <int> PreviewManager::dirtyChunks() const
+{
+    QList <int> dirty;
+    const QPoint zone = m_doc->zone();
+    foreach (int frame, m_chunkHashes.keys()) {
+        if (frame + m_chunkSize <= zone.x() || frame > zone.y()) continue;
+        if (!m_renderedChunks.contains(frame)) dirty << frame;
+    }
+    return dirty;
+}
+
+void PreviewManager::startRendering()
+{
+    const QList <int> dirty = dirtyChunks();
+    if (dirty.isEmpty()) return;
+    m_pendingChunks.clear();
+    foreach (int frame, dirty) {
+        m_pendingChunks.insert(frame, m_chunkHashes.value(frame));
+    }
+    // The scene does not contain the preview and overlay tracks
+    const QString scene = pCore->projectManager()->projectSceneList();
+    m_abortPreview.store(0);
+    m_previewThread = QtConcurrent::run(this, &PreviewManager::doPreviewRender, scene, m_pendingChunks);
+}
+
+void PreviewManager::doPreviewRender(const QString &scene, QMap <int, QByteArray> chunks)
+{
+    Mlt::Profile profile(mlt_profile_clone(m_tractor->profile()->get_profile()));
+    Mlt::Producer producer(profile, "xml-string", scene.toUtf8().constData());
+    if (!producer.is_valid()) {
+        qDebug() << "// Cannot load timeline for preview rendering";
+        return;
+    }
+    const int duration = producer.get_playtime();
+    const QStringList params = KdenliveSettings::previewparams().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    const QString tmpFile = m_cacheDir.absoluteFilePath(QStringLiteral("render.") + m_extension);
+    QMap <int, QByteArray>::const_iterator it = chunks.constBegin();
+    for (; it != chunks.constEnd() && m_abortPreview.load() == 0; ++it) {
+        const int frame = it.key();
+        if (frame >= duration) continue;
+        QScopedPointer<Mlt::Producer> cut(producer.cut(frame, qMin(frame + m_chunkSize, duration) - 1));
+        Mlt::Consumer consumer(profile, "avformat", tmpFile.toUtf8().constData());
+        consumer.set("real_time", -1);
+        consumer.set("terminate_on_pause", 1);
+        foreach (const QString &param, params) {
+            consumer.set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+        }
+        consumer.connect(*cut);
+        consumer.start();
+        while (!consumer.is_stopped() && m_abortPreview.load() == 0) {
+            QThread::msleep(50);
+        }
+        consumer.stop();
+        if (m_abortPreview.load() != 0) {
+            QFile::remove(tmpFile);
+            break;
+        }
+        const QString file = chunkFile(frame, it.value());
+        QFile::remove(file);
+        if (QFile::rename(tmpFile, file)) emit chunkRendered(frame, file);
+    }
+}
+
+void PreviewManager::gotRenderedChunk(int frame, const QString &file)
+{
+    m_pendingChunks.remove(frame);
+    if (m_renderedChunks.value(frame) == file) {
+        // Rendered again after an aborted pass, the file was replaced in place
+        return;
+    }
+    if (m_renderedChunks.contains(frame) || file != chunkFile(frame, m_chunkHashes.value(frame))) {
+        // Timeline changed while rendering
+        QFile::remove(file);
+        return;
+    }
+    m_tractor->lock();
+    insertChunk(frame, file);
+    m_tractor->unlock();
+    updateRuler();
+    m_doc->renderer()->doRefresh();
+}
+
+void PreviewManager::insertChunk(int frame, const QString &file)
+{
+    Mlt::Producer producer(*m_tractor->profile(), file.toUtf8().constData());
+    if (!producer.is_valid()) {
+        QFile::remove(file);
+        return;
+    }
+    QScopedPointer<Mlt::Producer> cut(producer.cut(0, qMin(producer.get_length(), m_chunkSize) - 1));
+    m_previewTrack->insert_at(frame, cut.data(), 1);
+    m_previewTrack->consolidate_blanks();
+    m_renderedChunks.insert(frame, file);
+}
+
+void PreviewManager::removeChunk(int frame)
+{
+    int ix = m_previewTrack->get_clip_index_at(frame);
+    if (ix < m_previewTrack->count() && !m_previewTrack->is_blank(ix)) {
+        delete m_previewTrack->replace_with_blank(ix);
+        m_previewTrack->consolidate_blanks();
+    }
+    QFile::remove(m_renderedChunks.take(frame));
+}
+
+void PreviewManager::updateRuler()
+{
+    m_ruler->updatePreview(m_renderedChunks.keys(), m_autoRender ? dirtyChunks() : QList <int>(), m_chunkSize);
+}
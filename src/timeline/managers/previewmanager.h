@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent (agent@local)                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef PREVIEWMANAGER_H
+#define PREVIEWMANAGER_H
+
+#include <QObject>
+#include <QDir>
+#include <QMap>
+#include <QTimer>
+#include <QFuture>
+#include <QAtomicInt>
+
+#include <mlt++/Mlt.h>
+
+class KdenliveDoc;
+class CustomRuler;
+class Timeline;
+
+/**
+ * @class PreviewManager
+ * @brief Renders chunks of the timeline to files in the project cache and plays them.
+ *
+ * Rendered chunks are inserted in a playlist placed above all the timeline
+ * tracks, so that the project monitor plays them instead of the live
+ * composite. Each chunk is identified by a hash of everything it displays
+ * (clips, cut effects, track effects and transitions), chunks whose hash
+ * changed after an edit are removed from the preview track.
+ */
+
+class PreviewManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    PreviewManager(KdenliveDoc *doc, CustomRuler *ruler, Mlt::Tractor *tractor, Timeline *parent);
+    virtual ~PreviewManager();
+    /** @brief Creates the preview track, the chunks rendered in a previous session are reused
+     *  when rendering is first enabled. The track is not added to the tractor before that.
+     *  Returns false if the cache folder cannot be used. */
+    bool initialize();
+    /** @brief Remove / re-add the preview track from the tractor, which must be locked.
+     *  The split overlay track, if any, has to be removed first and added after. */
+    void disconnectTrack();
+    void reconnectTrack();
+    bool isConnected() const;
+    /** @brief Returns true if the tractor track is a preview track, which is not part of the project. */
+    static bool isPreviewTrack(Mlt::Producer &track);
+    /** @brief Render the dirty chunks of the timeline zone whenever the timeline changes.
+     *  The preview track is only in the tractor while enabled, see Timeline::setAutoPreview(). */
+    void setAutoRender(bool enable);
+    /** @brief Stop the rendering thread, the chunks already rendered are kept. */
+    void abortRendering();
+
+public slots:
+    /** @brief The timeline or its zone changed, check the chunks after a short delay. */
+    void slotTimelineChanged();
+
+private slots:
+    void slotCheckChunks();
+    void gotRenderedChunk(int frame, const QString &file);
+
+private:
+    KdenliveDoc *m_doc;
+    CustomRuler *m_ruler;
+    Mlt::Tractor *m_tractor;
+    Timeline *m_timeline;
+    Mlt::Playlist *m_previewTrack;
+    bool m_connected;
+    bool m_autoRender;
+    /** @brief True once the chunks of a previous session were checked, see loadCachedChunks(). */
+    bool m_cacheLoaded;
+    QDir m_cacheDir;
+    QString m_extension;
+    int m_chunkSize;
+    QTimer m_checkTimer;
+    QFuture <void> m_previewThread;
+    QAtomicInt m_abortPreview;
+    /** @brief Content hash of each chunk, by start frame, as of the last check. */
+    QMap <int, QByteArray> m_chunkHashes;
+    /** @brief Chunks currently in the preview track, by start frame. */
+    QMap <int, QString> m_renderedChunks;
+    /** @brief Chunks given to the rendering thread, with the hash they are rendered for. */
+    QMap <int, QByteArray> m_pendingChunks;
+
+    /** @brief Inserts the chunks of the cache folder that are still valid, deletes the others. */
+    void loadCachedChunks();
+    /** @brief Hashes the content of every chunk of the timeline. */
+    QMap <int, QByteArray> computeHashes();
+    QString chunkFile(int frame, const QByteArray &hash) const;
+    /** @brief Chunks of the timeline zone that have no valid rendering. */
+    QList <int> dirtyChunks() const;
+    void startRendering();
+    void doPreviewRender(const QString &scene, QMap <int, QByteArray> chunks);
+    void insertChunk(int frame, const QString &file);
+    void removeChunk(int frame);
+    void updateRuler();
+
+signals:
+    void chunkRendered(int frame, const QString &file);
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "transition.h"
 #include "transitionhandler.h"
 #include "timelinecommands.h"
+#include "managers/previewmanager.h"
 #include "customruler.h"
 #include "customtrackview.h"
 #include "dialogs/profilesdialog.h"
@@ -42,6 +43,7 @@
 #include "mltcontroller/effectscontroller.h"
 
 #include <QScrollBar>
+#include <QElapsedTimer>
 #include <QLocale>
 #include <KDualAction>
 
@@ -55,6 +57,7 @@ Timeline::Timeline(KdenliveDoc *doc, const QList<QAction *> &actions, bool *ok,
     multitrackView(false)
     , m_hasOverlayTrack(false)
     , m_overlayTrack(NULL)
+    , m_timelinePreview(NULL)
     , m_scale(1.0)
     , m_doc(doc)
     , m_verticalZoom(1)
@@ -133,6 +136,7 @@ Timeline::Timeline(KdenliveDoc *doc, const QList<QAction *> &actions, bool *ok,
 
 Timeline::~Timeline()
 {
+    delete m_timelinePreview;
     delete m_ruler;
     delete m_trackview;
     delete m_scene;
@@ -144,11 +148,22 @@ Timeline::~Timeline()
 
 void Timeline::loadTimeline()
 {
+    QElapsedTimer timer;
+    timer.start();
     parseDocument(m_doc->toXml());
+    qDebug() << "// Timeline items created in" << timer.elapsed() << "ms";
     m_trackview->slotUpdateAllThumbs();
     m_trackview->slotSelectTrack(m_trackview->getNextVideoTrack(1));
     slotChangeZoom(m_doc->zoom().x(), m_doc->zoom().y());
     slotSetZone(m_doc->zone(), false);
+    m_timelinePreview = new PreviewManager(m_doc, m_ruler, m_tractor, this);
+    if (!m_timelinePreview->initialize()) {
+        delete m_timelinePreview;
+        m_timelinePreview = NULL;
+    } else {
+        connect(m_ruler, SIGNAL(zoneMoved(int,int)), m_timelinePreview, SLOT(slotTimelineChanged()));
+        setAutoPreview(KdenliveSettings::autopreview());
+    }
 }
 
 Track* Timeline::track(int i) 
@@ -159,12 +174,12 @@ Track* Timeline::track(int i)
 
 int Timeline::tracksCount() const
 {
-    return m_tractor->count() - (m_hasOverlayTrack ? 1 : 0);
+    return m_tractor->count() - (m_hasOverlayTrack && !m_overlayTrack ? 1 : 0) - (m_timelinePreview && m_timelinePreview->isConnected() ? 1 : 0);
 }
 
 int Timeline::visibleTracksCount() const
 {
-    return m_tractor->count() - 1 - (m_hasOverlayTrack ? 1 : 0);
+    return tracksCount() - 1;
 }
 
 //virtual
@@ -214,6 +229,7 @@ void Timeline::slotSetZone(const QPoint &p, bool updateDocumentProperties)
 {
     m_ruler->setZone(p);
     if (updateDocumentProperties) m_doc->setZone(p.x(), p.y());
+    if (m_timelinePreview) m_timelinePreview->slotTimelineChanged();
 }
 
 void Timeline::setDuration(int dur)
@@ -235,7 +251,7 @@ int Timeline::getTracks() {
     for (int i = 0; i < m_tractor->count(); ++i) {
         QScopedPointer<Mlt::Producer> track(m_tractor->track(i));
         QString playlist_name = track->get("id");
-        if (playlist_name == QLatin1String("black_track")) continue;
+        if (playlist_name == QLatin1String("black_track") || PreviewManager::isPreviewTrack(*track)) continue;
         clipsCount += track->count();
     }
     emit startLoadingBin(clipsCount);
@@ -247,7 +263,7 @@ int Timeline::getTracks() {
     for (int i = 0; i < m_tractor->count(); ++i) {
         QScopedPointer<Mlt::Producer> track(m_tractor->track(i));
         QString playlist_name = track->get("id");
-        if (playlist_name == QLatin1String("playlistmain")) continue;
+        if (playlist_name == QLatin1String("playlistmain") || PreviewManager::isPreviewTrack(*track)) continue;
         bool isBackgroundBlackTrack = playlist_name == QLatin1String("black_track");
         // check track effects
         Mlt::Playlist playlist(*track);
@@ -359,13 +375,13 @@ void Timeline::getTransitions() {
             prop.set("kdenlive_id", "slide");
         QDomElement base = MainWindow::transitions.getEffectByTag(prop.get("mlt_service"), prop.get("kdenlive_id")).cloneNode().toElement();
         //check invalid parameters
-        if (a_track > m_tractor->count() - 1) {
-            m_documentErrors.append(i18n("Transition %1 had an invalid track: %2 > %3", prop.get("id"), a_track, m_tractor->count() - 1) + '\n');
-            prop.set("a_track", m_tractor->count() - 1);
+        if (a_track > tracksCount() - 1) {
+            m_documentErrors.append(i18n("Transition %1 had an invalid track: %2 > %3", prop.get("id"), a_track, tracksCount() - 1) + '\n');
+            prop.set("a_track", tracksCount() - 1);
         }
-        if (b_track > m_tractor->count() - 1) {
-            m_documentErrors.append(i18n("Transition %1 had an invalid track: %2 > %3", prop.get("id"), b_track, m_tractor->count() - 1) + '\n');
-            prop.set("b_track", m_tractor->count() - 1);
+        if (b_track > tracksCount() - 1) {
+            m_documentErrors.append(i18n("Transition %1 had an invalid track: %2 > %3", prop.get("id"), b_track, tracksCount() - 1) + '\n');
+            prop.set("b_track", tracksCount() - 1);
         }
         if (a_track == b_track || b_track <= 0
             || transitionInfo.startPos >= transitionInfo.endPos
@@ -813,8 +829,8 @@ void Timeline::fixAudioMixing()
         resource = mlt_properties_get(properties, "mlt_service");
     }
 
-    // Re-add correct audio transitions
-    for (int i = 1; i < m_tractor->count(); i++) {
+    // Re-add correct audio transitions, the preview and overlay tracks are not mixed
+    for (int i = 1; i < tracksCount(); i++) {
         //bool muted = getTrackInfo(i).isMute;
         //if (muted) continue;
         /*int a_track = qMax(lowestTrack, i - 1);
@@ -908,13 +924,11 @@ int Timeline::loadTrack(int ix, int offset, Mlt::Playlist &playlist) {
         QString id = idString;
         double speed = 1.0;
         int strobe = 1;
-        bool hasSpeedEffect = false;
         if (idString.endsWith(QLatin1String("_video"))) {
             // Video only producer, store it in BinController
             m_doc->renderer()->loadExtraProducer(idString, new Mlt::Producer(clip->parent()));
         }
         if (idString.startsWith(QLatin1String("slowmotion"))) {
-	    hasSpeedEffect = true;
             QLocale locale;
             locale.setNumberOptions(QLocale::OmitGroupSeparator);
             id = idString.section(':', 1, 1);
@@ -942,24 +956,43 @@ int Timeline::loadTrack(int ix, int offset, Mlt::Playlist &playlist) {
         clipinfo.track = ix;
 	position += length;
 	//qDebug()<<"// Loading clip: "<<idString<<" / SPEED: "<<speed<<"\n++++++++++++++++++++++++";
-        ClipItem *item = new ClipItem(binclip, clipinfo, fps, speed, strobe, m_trackview->getFrameWidth(), true);
+        // Thumbnails and effects are only loaded when the clip is displayed or used
+        ClipItem *item = new ClipItem(binclip, clipinfo, fps, speed, strobe, m_trackview->getFrameWidth(), false);
         item->setPos(clipinfo.startPos.frames(fps), KdenliveSettings::trackheight() * (visibleTracksCount() - clipinfo.track) + 1 + item->itemOffset());
         //qDebug()<<" * * Loaded clip on tk: "<<clipinfo.track<< ", POS: "<<clipinfo.startPos.frames(fps);
         item->updateState(idString);
+        removeUnknownEffects(*clip);
+        item->setPendingLoad(new Mlt::Producer(*clip));
         m_scene->addItem(item);
         if (locked) item->setItemLocked(true);
-        if (hasSpeedEffect) {
-            QDomElement speedeffect = MainWindow::videoEffects.getEffectByTag(QString(), QStringLiteral("speed")).cloneNode().toElement();
-            EffectsList::setParameter(speedeffect, QStringLiteral("speed"), QString::number((int)(100 * speed + 0.5)));
-            EffectsList::setParameter(speedeffect, QStringLiteral("strobe"), QString::number(strobe));
-            item->addEffect(m_doc->getProfileInfo(), speedeffect, false);
-        }
-        // parse clip effects
-        getEffects(*clip, item);
     }
     return position;
 }
 
+void Timeline::loadClipEffects(ClipItem *item, Mlt::Producer &cut)
+{
+    if (QString(cut.parent().get("id")).startsWith(QLatin1String("slowmotion"))) {
+        QDomElement speedeffect = MainWindow::videoEffects.getEffectByTag(QString(), QStringLiteral("speed")).cloneNode().toElement();
+        EffectsList::setParameter(speedeffect, QStringLiteral("speed"), QString::number((int)(100 * item->speed() + 0.5)));
+        EffectsList::setParameter(speedeffect, QStringLiteral("strobe"), QString::number(item->strobe()));
+        item->addEffect(m_doc->getProfileInfo(), speedeffect, false);
+    }
+    // parse clip effects
+    getEffects(cut, item);
+}
+
+void Timeline::removeUnknownEffects(Mlt::Service &service)
+{
+    for (int ix = 0; ix < service.filter_count(); ++ix) {
+        QScopedPointer<Mlt::Filter> effect(service.filter(ix));
+        if (getEffectByTag(effect->get("tag"), effect->get("kdenlive_id")).isNull()) {
+            m_documentErrors.append(i18n("Effect %1:%2 not found in MLT, it was removed from this project\n", effect->get("tag"), effect->get("kdenlive_id")));
+            service.detach(*effect);
+            --ix;
+        }
+    }
+}
+
 void Timeline::loadGuides(QMap <double, QString> guidesData)
 {
     QMapIterator<double, QString> i(guidesData);
@@ -976,7 +1009,8 @@ void Timeline::getEffects(Mlt::Service &service, ClipItem *clip, int track) {
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
     for (int ix = 0; ix < service.filter_count(); ++ix) {
         QScopedPointer<Mlt::Filter> effect(service.filter(ix));
-        QDomElement clipeffect = getEffectByTag(effect->get("tag"), effect->get("kdenlive_id"));
+        EffectSchema schema;
+        QDomElement clipeffect = getEffectByTag(effect->get("tag"), effect->get("kdenlive_id"), &schema);
         if (clipeffect.isNull()) {
             m_documentErrors.append(i18n("Effect %1:%2 not found in MLT, it was removed from this project\n", effect->get("tag"), effect->get("kdenlive_id")));
             service.detach(*effect);
@@ -992,10 +1026,11 @@ void Timeline::getEffects(Mlt::Service &service, ClipItem *clip, int track) {
 
         QDomNodeList params = currenteffect.elementsByTagName(QStringLiteral("parameter"));
 	ProfileInfo info = m_doc->getProfileInfo();
-        for (int i = 0; i < params.count(); ++i) {
+        for (int i = 0; i < params.count() && i < schema.count(); ++i) {
             QDomElement e = params.item(i).toElement();
-            if (e.attribute(QStringLiteral("type")) == QLatin1String("keyframe")) e.setAttribute(QStringLiteral("keyframes"), getKeyframes(service, ix, e));
-            else setParam(info, e, effect->get(e.attribute(QStringLiteral("name")).toUtf8().constData()));
+            const EffectParameter &param = schema.at(i);
+            if (param.type == QLatin1String("keyframe")) e.setAttribute(QStringLiteral("keyframes"), getKeyframes(service, ix, e));
+            else setParam(info, e, param, effect->get(param.name.toUtf8().constData()));
         }
 
         if (effect->get_out()) { // no keyframes but in/out points
@@ -1070,19 +1105,17 @@ void Timeline::getSubfilters(Mlt::Filter *effect, QDomElement &currenteffect) {
 
 //static
 void Timeline::setParam(ProfileInfo info, QDomElement param, QString value) {
+    setParam(info, param, EffectsList::parseParameter(param), value);
+}
+
+void Timeline::setParam(ProfileInfo info, QDomElement param, const EffectParameter &schema, const QString &value) {
     QLocale locale;
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
     //get Kdenlive scaling parameters
-    double offset = locale.toDouble(param.attribute(QStringLiteral("offset"), QStringLiteral("0")));
-    double fact;
-    QString factor = param.attribute(QStringLiteral("factor"), QStringLiteral("1"));
-    if (factor.contains('%')) {
-        fact = EffectsController::getStringEval(info, factor);
-    } else {
-        fact = locale.toDouble(factor);
-    }
+    const double offset = schema.offset;
+    const double fact = schema.factorExpression.isEmpty() ? schema.factor : EffectsController::getStringEval(info, schema.factorExpression);
     //adjust parameter if necessary
-    QString type = param.attribute(QStringLiteral("type"));
+    const QString &type = schema.type;
     if (type == QLatin1String("simplekeyframe")) {
         QStringList kfrs = value.split(';');
         for (int l = 0; l < kfrs.count(); ++l) {
@@ -1102,14 +1135,20 @@ void Timeline::setParam(ProfileInfo info, QDomElement param, QString value) {
     }
 }
 
-QDomElement Timeline::getEffectByTag(const QString &effecttag, const QString &effectid)
+QDomElement Timeline::getEffectByTag(const QString &effecttag, const QString &effectid, EffectSchema *schema)
 {
-    QDomElement clipeffect = MainWindow::customEffects.getEffectByTag(QString(), effectid);
+    const EffectsList *list = &MainWindow::customEffects;
+    QDomElement clipeffect = list->getEffectByTag(QString(), effectid);
     if (clipeffect.isNull()) {
-        clipeffect = MainWindow::videoEffects.getEffectByTag(effecttag, effectid);
+        list = &MainWindow::videoEffects;
+        clipeffect = list->getEffectByTag(effecttag, effectid);
     }
     if (clipeffect.isNull()) {
-        clipeffect = MainWindow::audioEffects.getEffectByTag(effecttag, effectid);
+        list = &MainWindow::audioEffects;
+        clipeffect = list->getEffectByTag(effecttag, effectid);
+    }
+    if (schema) {
+        *schema = clipeffect.isNull() ? EffectSchema() : list->parameterSchema(clipeffect);
     }
     return clipeffect;
 }
@@ -1518,25 +1557,41 @@ void Timeline::slotMultitrackView(bool enable)
 
 void Timeline::connectOverlayTrack(bool enable)
 {
-    if (!m_hasOverlayTrack) return;
+    if (!m_hasOverlayTrack && !m_timelinePreview) return;
     m_tractor->lock();
     if (enable) {
-        // Re-add overlaytrack
-        m_tractor->insert_track(*m_overlayTrack, tracksCount() + 1);
-        delete m_overlayTrack;
-        m_overlayTrack = NULL;
+        // Re-add preview track, then overlaytrack on top
+        if (m_timelinePreview) m_timelinePreview->reconnectTrack();
+        if (m_hasOverlayTrack && m_overlayTrack) {
+            m_tractor->insert_track(*m_overlayTrack, m_tractor->count());
+            delete m_overlayTrack;
+            m_overlayTrack = NULL;
+        }
     } else {
-        m_overlayTrack = m_tractor->track(tracksCount());
-        m_tractor->remove_track(tracksCount());
+        if (m_hasOverlayTrack && !m_overlayTrack) {
+            m_overlayTrack = m_tractor->track(m_tractor->count() - 1);
+            m_tractor->remove_track(m_tractor->count() - 1);
+        }
+        if (m_timelinePreview) m_timelinePreview->disconnectTrack();
     }
     m_tractor->unlock();
 }
 
+void Timeline::setAutoPreview(bool enable)
+{
+    if (!m_timelinePreview) return;
+    // The preview track is only planted while enabled, below the split overlay track
+    connectOverlayTrack(false);
+    m_timelinePreview->setAutoRender(enable);
+    connectOverlayTrack(true);
+    m_doc->renderer()->doRefresh();
+}
+
 void Timeline::removeSplitOverlay()
 {
     if (!m_hasOverlayTrack) return;
     m_tractor->lock();
-    m_tractor->remove_track(tracksCount());
+    m_tractor->remove_track(m_tractor->count() - 1);
     m_hasOverlayTrack = false;
     m_tractor->unlock();
 }
@@ -1566,7 +1621,7 @@ bool Timeline::createOverlay(Mlt::Filter *filter, int tk, int startPos)
     overlay.insert_blank(0, startPos);
     Mlt::Producer split(trac.get_producer());
     overlay.insert_at(startPos, &split, 1);
-    int trackIndex = tracksCount();
+    int trackIndex = m_tractor->count();
     m_tractor->insert_track(overlay, trackIndex);
     Mlt::Producer *overlayTrack = m_tractor->track(trackIndex);
     overlayTrack->set("hide", 2);
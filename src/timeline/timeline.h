@@ -43,6 +43,7 @@ class CustomTrackView;
 class KdenliveDoc;
 class TransitionHandler;
 class CustomRuler;
+class PreviewManager;
 class QUndoCommand;
 
 class Timeline : public QWidget, public Ui::TimeLine_UI
@@ -97,8 +98,9 @@ public:
     void checkTrackHeight(bool force = false);
     void updatePalette();
     void refreshIcons();
-    /** @brief Returns a kdenlive effect xml description from an effect tag / id */
-    static QDomElement getEffectByTag(const QString &effecttag, const QString &effectid);
+    /** @brief Returns a kdenlive effect xml description from an effect tag / id
+     *  @param schema if not NULL, set to the parsed parameters of the effect */
+    static QDomElement getEffectByTag(const QString &effecttag, const QString &effectid, EffectSchema *schema = NULL);
     /** @brief Move a clip between tracks */
     bool moveClip(int startTrack, qreal startPos, int endTrack, qreal endPos, PlaylistState::ClipState state, int mode, bool duplicate);
     void renameTrack(int ix, const QString &name);
@@ -127,6 +129,8 @@ public:
     int changeClipSpeed(ItemInfo info, ItemInfo speedIndependantInfo, PlaylistState::ClipState state, double speed, int strobe, Mlt::Producer *originalProd, bool removeEffect = false);
     /** @brief Set an effect's XML accordingly to MLT::filter values. */
     static void setParam(ProfileInfo info, QDomElement param, QString value);
+    /** @brief Same as above, with the attributes of @param param already parsed in @param schema. */
+    static void setParam(ProfileInfo info, QDomElement param, const EffectParameter &schema, const QString &value);
     int getTracks();
     void getTransitions();
     void refreshTractor();
@@ -150,6 +154,11 @@ public:
     void connectOverlayTrack(bool enable);
     /** @brief Update composite transitions's tracks */
     void updateComposites();
+    /** @brief Builds the effect list of a clip loaded from the project, from the filters of its cut.
+     *  Called by the clip the first time it needs its effects, see ClipItem::setPendingLoad(). */
+    void loadClipEffects(ClipItem *item, Mlt::Producer &cut);
+    /** @brief Dis/enable background rendering of the timeline zone to preview chunks */
+    void setAutoPreview(bool enable);
 
 protected:
     void keyPressEvent(QKeyEvent * event);
@@ -173,6 +182,8 @@ private:
     /** @brief number of special overlay tracks to preview effects */
     bool m_hasOverlayTrack;
     Mlt::Producer *m_overlayTrack;
+    /** @brief Renders the timeline in chunks played from a track above all others */
+    PreviewManager *m_timelinePreview;
     CustomRuler *m_ruler;
     CustomTrackView *m_trackview;
     QList <QString> m_invalidProducers;
@@ -192,6 +203,8 @@ private:
     void parseDocument(const QDomDocument &doc);
     int loadTrack(int ix, int offset, Mlt::Playlist &playlist);
     void getEffects(Mlt::Service &service, ClipItem *clip, int track = 0);
+    /** @brief Detach the filters that are not known effects and report them in m_documentErrors. */
+    void removeUnknownEffects(Mlt::Service &service);
     void adjustDouble(QDomElement &e, const QString &value);
 
     /** @brief Adjust kdenlive effect xml parameters to the MLT value*/
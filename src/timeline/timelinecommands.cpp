@@ -26,6 +26,19 @@
 
 #include <klocalizedstring.h>
 
+/** Copy of an effect stack that does not share the document of the clip's list. */
+static CompactElement copyStack(const EffectsList &effects)
+{
+    return CompactElement(effects.documentElement().cloneNode().toElement());
+}
+
+static EffectsList restoreStack(const CompactElement &stack)
+{
+    EffectsList effects;
+    effects.setList(stack.element());
+    return effects;
+}
+
 AddEffectCommand::AddEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &effect, bool doIt, QUndoCommand * parent) :
         QUndoCommand(parent),
         m_view(view),
@@ -35,7 +48,7 @@ AddEffectCommand::AddEffectCommand(CustomTrackView *view, const int track, const
         m_doIt(doIt)
 {
     QString effectName;
-    QDomElement namenode = m_effect.firstChildElement(QStringLiteral("name"));
+    QDomElement namenode = effect.firstChildElement(QStringLiteral("name"));
     if (!namenode.isNull())
         effectName = i18n(namenode.text().toUtf8().data());
     else
@@ -49,17 +62,27 @@ AddEffectCommand::AddEffectCommand(CustomTrackView *view, const int track, const
 void AddEffectCommand::undo()
 {
     if (m_doIt)
-        m_view->deleteEffect(m_track, m_pos, m_effect);
+        m_view->deleteEffect(m_track, m_pos, m_effect.element());
     else
-        m_view->addEffect(m_track, m_pos, m_effect);
+        m_view->addEffect(m_track, m_pos, m_effect.element());
 }
 // virtual
 void AddEffectCommand::redo()
 {
     if (m_doIt)
-        m_view->addEffect(m_track, m_pos, m_effect);
+        m_view->addEffect(m_track, m_pos, m_effect.element());
     else
-        m_view->deleteEffect(m_track, m_pos, m_effect);
+        m_view->deleteEffect(m_track, m_pos, m_effect.element());
+}
+
+int AddEffectCommand::memoryCost() const
+{
+    return m_effect.cost();
+}
+
+void AddEffectCommand::compact()
+{
+    m_effect.compress();
 }
 
 AddTimelineClipCommand::AddTimelineClipCommand(CustomTrackView *view, const QString &clipId, const ItemInfo &info, const EffectsList &effects, PlaylistState::ClipState state, bool doIt, bool doRemove, QUndoCommand * parent) :
@@ -67,7 +90,7 @@ AddTimelineClipCommand::AddTimelineClipCommand(CustomTrackView *view, const QStr
         m_view(view),
         m_clipId(clipId),
         m_clipInfo(info),
-        m_effects(effects),
+        m_effects(copyStack(effects)),
         m_state(state),
         m_doIt(doIt),
         m_remove(doRemove)
@@ -81,20 +104,30 @@ void AddTimelineClipCommand::undo()
     if (!m_remove)
         m_view->deleteClip(m_clipInfo);
     else
-        m_view->addClip(m_clipId, m_clipInfo, m_effects, m_state);
+        m_view->addClip(m_clipId, m_clipInfo, restoreStack(m_effects), m_state);
 }
 // virtual
 void AddTimelineClipCommand::redo()
 {
     if (m_doIt) {
         if (!m_remove)
-            m_view->addClip(m_clipId, m_clipInfo, m_effects, m_state);
+            m_view->addClip(m_clipId, m_clipInfo, restoreStack(m_effects), m_state);
         else
             m_view->deleteClip(m_clipInfo);
     }
     m_doIt = true;
 }
 
+int AddTimelineClipCommand::memoryCost() const
+{
+    return m_effects.cost();
+}
+
+void AddTimelineClipCommand::compact()
+{
+    m_effects.compress();
+}
+
 AddTrackCommand::AddTrackCommand(CustomTrackView *view, int ix, const TrackInfo &info, bool addTrack, QUndoCommand * parent) :
         QUndoCommand(parent),
         m_view(view),
@@ -148,22 +181,32 @@ AddTransitionCommand::AddTransitionCommand(CustomTrackView *view, const ItemInfo
 void AddTransitionCommand::undo()
 {
     if (m_remove)
-        m_view->addTransition(m_info, m_track, m_params, m_refresh);
+        m_view->addTransition(m_info, m_track, m_params.element(), m_refresh);
     else
-        m_view->deleteTransition(m_info, m_track, m_params, m_refresh);
+        m_view->deleteTransition(m_info, m_track, m_params.element(), m_refresh);
 }
 // virtual
 void AddTransitionCommand::redo()
 {
     if (m_doIt) {
         if (m_remove)
-            m_view->deleteTransition(m_info, m_track, m_params, m_refresh);
+            m_view->deleteTransition(m_info, m_track, m_params.element(), m_refresh);
         else
-            m_view->addTransition(m_info, m_track, m_params, m_refresh);
+            m_view->addTransition(m_info, m_track, m_params.element(), m_refresh);
     }
     m_doIt = true;
 }
 
+int AddTransitionCommand::memoryCost() const
+{
+    return m_params.cost();
+}
+
+void AddTransitionCommand::compact()
+{
+    m_params.compress();
+}
+
 ChangeClipTypeCommand::ChangeClipTypeCommand(CustomTrackView *view, const int track, const GenTime &pos, PlaylistState::ClipState state, PlaylistState::ClipState originalState, QUndoCommand * parent) :
         QUndoCommand(parent),
         m_view(view),
@@ -267,7 +310,7 @@ EditEffectCommand::EditEffectCommand(CustomTrackView *view, const int track, con
     m_view(view),
     m_track(track),
     m_oldeffect(oldeffect),
-    m_effect(effect),
+    m_effect(effect, oldeffect),
     m_pos(pos),
     m_stackPos(stackPos),
     m_doIt(doIt),
@@ -281,7 +324,7 @@ EditEffectCommand::EditEffectCommand(CustomTrackView *view, const int track, con
     else
         effectName = i18n("effect");
     setText(i18n("Edit effect %1", effectName));
-    if (m_effect.attribute(QStringLiteral("id")) == QLatin1String("pan_zoom")) {
+    if (effect.attribute(QStringLiteral("id")) == QLatin1String("pan_zoom")) {
         QString bg = EffectsList::parameter(effect, QStringLiteral("background"));
         QString oldBg = EffectsList::parameter(oldeffect, QStringLiteral("background"));
         if (bg != oldBg) {
@@ -306,24 +349,36 @@ bool EditEffectCommand::mergeWith(const QUndoCommand * other)
         return false;
     if (m_pos != static_cast<const EditEffectCommand*>(other)->m_pos)
         return false;
-    m_effect = static_cast<const EditEffectCommand*>(other)->m_effect.cloneNode().toElement();
+    const EditEffectCommand *command = static_cast<const EditEffectCommand*>(other);
+    m_effect = CompactElement(command->m_effect.element(command->m_oldeffect.element()), m_oldeffect.element());
     return true;
 }
 // virtual
 void EditEffectCommand::undo()
 {
-    m_view->updateEffect(m_track, m_pos, m_oldeffect, true, m_replaceEffect);
+    m_view->updateEffect(m_track, m_pos, m_oldeffect.element(), true, m_replaceEffect);
 }
 // virtual
 void EditEffectCommand::redo()
 {
     if (m_doIt) {
-        m_view->updateEffect(m_track, m_pos, m_effect, m_refreshEffectStack, m_replaceEffect);
+        m_view->updateEffect(m_track, m_pos, m_effect.element(m_oldeffect.element()), m_refreshEffectStack, m_replaceEffect);
     }
     m_doIt = true;
     m_refreshEffectStack = true;
 }
 
+int EditEffectCommand::memoryCost() const
+{
+    return m_oldeffect.cost() + m_effect.cost();
+}
+
+void EditEffectCommand::compact()
+{
+    m_oldeffect.compress();
+    m_effect.compress();
+}
+
 EditGuideCommand::EditGuideCommand(CustomTrackView *view, const GenTime &oldPos, const QString &oldcomment, const GenTime &pos, const QString &comment, bool doIt, QUndoCommand * parent) :
     QUndoCommand(parent),
     m_view(view),
@@ -363,11 +418,11 @@ EditTransitionCommand::EditTransitionCommand(CustomTrackView *view, const int tr
         QUndoCommand(parent),
         m_view(view),
         m_track(track),
+        m_effect(effect.cloneNode().toElement(), oldeffect),
         m_oldeffect(oldeffect),
         m_pos(pos),
         m_doIt(doIt)
 {
-    m_effect = effect.cloneNode().toElement();
     QString effectName;
     QDomElement namenode = effect.firstChildElement(QStringLiteral("name"));
     if (!namenode.isNull()) effectName = i18n(namenode.text().toUtf8().data());
@@ -385,21 +440,35 @@ bool EditTransitionCommand::mergeWith(const QUndoCommand * other)
     if (other->id() != id()) return false;
     if (m_track != static_cast<const EditTransitionCommand*>(other)->m_track) return false;
     if (m_pos != static_cast<const EditTransitionCommand*>(other)->m_pos) return false;
-    m_effect = static_cast<const EditTransitionCommand*>(other)->m_effect;
+    const EditTransitionCommand *command = static_cast<const EditTransitionCommand*>(other);
+    m_effect = CompactElement(command->m_effect.element(command->m_oldeffect.element()), m_oldeffect.element());
     return true;
 }
 // virtual
 void EditTransitionCommand::undo()
 {
-    m_view->updateTransition(m_track, m_pos, m_effect, m_oldeffect, m_doIt);
+    QDomElement oldeffect = m_oldeffect.element();
+    m_view->updateTransition(m_track, m_pos, m_effect.element(oldeffect), oldeffect, m_doIt);
 }
 // virtual
 void EditTransitionCommand::redo()
 {
-    m_view->updateTransition(m_track, m_pos, m_oldeffect, m_effect, m_doIt);
+    QDomElement oldeffect = m_oldeffect.element();
+    m_view->updateTransition(m_track, m_pos, oldeffect, m_effect.element(oldeffect), m_doIt);
     m_doIt = true;
 }
 
+int EditTransitionCommand::memoryCost() const
+{
+    return m_effect.cost() + m_oldeffect.cost();
+}
+
+void EditTransitionCommand::compact()
+{
+    m_effect.compress();
+    m_oldeffect.compress();
+}
+
 GroupClipsCommand::GroupClipsCommand(CustomTrackView *view, const QList <ItemInfo> &clipInfos, const QList <ItemInfo>& transitionInfos, bool group, QUndoCommand * parent) :
     QUndoCommand(parent),
     m_view(view),
@@ -600,16 +669,16 @@ RazorClipCommand::RazorClipCommand(CustomTrackView *view, const ItemInfo &info,
     QUndoCommand(parent),
     m_view(view),
     m_info(info),
+    m_originalStack(copyStack(stack)),
     m_cutTime(cutTime),
     m_doIt(doIt)
 {
-    m_originalStack.clone(stack);
     setText(i18n("Razor clip"));
 }
 // virtual
 void RazorClipCommand::undo()
 {
-    m_view->cutClip(m_info, m_cutTime, false, m_originalStack);
+    m_view->cutClip(m_info, m_cutTime, false, restoreStack(m_originalStack));
 }
 // virtual
 void RazorClipCommand::redo()
@@ -619,6 +688,16 @@ void RazorClipCommand::redo()
     }
     m_doIt = true;
 }
+
+int RazorClipCommand::memoryCost() const
+{
+    return m_originalStack.cost();
+}
+
+void RazorClipCommand::compact()
+{
+    m_originalStack.compress();
+}
 /*
 RazorGroupCommand::RazorGroupCommand(CustomTrackView *view, QList <ItemInfo> clips1, QList <ItemInfo> transitions1, QList <ItemInfo> clipsCut, QList <ItemInfo> transitionsCut, QList <ItemInfo> clips2, QList <ItemInfo> transitions2, GenTime cutPos, QUndoCommand * parent) :
     QUndoCommand(parent),
@@ -713,18 +792,28 @@ SplitAudioCommand::SplitAudioCommand(CustomTrackView *view, const int track, con
     m_view(view),
     m_pos(pos),
     m_track(track),
-    m_effects(effects)
+    m_effects(copyStack(effects))
 {
     setText(i18n("Split audio"));
 }
 // virtual
 void SplitAudioCommand::undo()
 {
-    m_view->doSplitAudio(m_pos, m_track, m_effects, false);
+    m_view->doSplitAudio(m_pos, m_track, restoreStack(m_effects), false);
 }
 // virtual
 void SplitAudioCommand::redo()
 {
-    m_view->doSplitAudio(m_pos, m_track, m_effects, true);
+    m_view->doSplitAudio(m_pos, m_track, restoreStack(m_effects), true);
+}
+
+int SplitAudioCommand::memoryCost() const
+{
+    return m_effects.cost();
+}
+
+void SplitAudioCommand::compact()
+{
+    m_effects.compress();
 }
 
@@ -28,35 +28,40 @@
 #include <QDomElement>
 #include "definitions.h"
 #include "effectslist/effectslist.h"
+#include "compactelement.h"
 class GenTime;
 class CustomTrackView;
 class Timeline;
 
-class AddEffectCommand : public QUndoCommand
+class AddEffectCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     AddEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &effect, bool doIt, QUndoCommand * parent = 0);
     void undo();
     void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     int m_track;
-    QDomElement m_effect;
+    CompactElement m_effect;
     GenTime m_pos;
     bool m_doIt;
 };
 
-class AddTimelineClipCommand : public QUndoCommand
+class AddTimelineClipCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     AddTimelineClipCommand(CustomTrackView *view, const QString &clipId, const ItemInfo &info, const EffectsList &effects, PlaylistState::ClipState state, bool doIt, bool doRemove, QUndoCommand * parent = 0);
     void undo();
     void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     QString m_clipId;
     ItemInfo m_clipInfo;
-    EffectsList m_effects;
+    CompactElement m_effects;
     PlaylistState::ClipState m_state;
     bool m_doIt;
     bool m_remove;
@@ -75,16 +80,18 @@ private:
     TrackInfo m_info;
 };
 
-class AddTransitionCommand : public QUndoCommand
+class AddTransitionCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     AddTransitionCommand(CustomTrackView *view, const ItemInfo &info, int transitiontrack, const QDomElement &params, bool remove, bool doIt, QUndoCommand * parent = 0);
     void undo();
     void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     ItemInfo m_info;
-    QDomElement m_params;
+    CompactElement m_params;
     int m_track;
     bool m_doIt;
     bool m_remove;
@@ -153,7 +160,7 @@ private:
     int m_newState;
 };
 
-class EditEffectCommand : public QUndoCommand
+class EditEffectCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     EditEffectCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &oldeffect, const QDomElement &effect, int stackPos, bool refreshEffectStack, bool doIt, QUndoCommand *parent = 0);
@@ -161,11 +168,14 @@ public:
     virtual bool mergeWith(const QUndoCommand * command);
     void undo();
     void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     const int m_track;
-    QDomElement m_oldeffect;
-    QDomElement m_effect;
+    CompactElement m_oldeffect;
+    /** @brief Only stores the parameters changed from m_oldeffect. */
+    CompactElement m_effect;
     const GenTime m_pos;
     int m_stackPos;
     bool m_doIt;
@@ -188,7 +198,7 @@ private:
     bool m_doIt;
 };
 
-class EditTransitionCommand : public QUndoCommand
+class EditTransitionCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     EditTransitionCommand(CustomTrackView *view, const int track, const GenTime &pos, const QDomElement &oldeffect, const QDomElement &effect, bool doIt, QUndoCommand * parent = NULL);
@@ -196,11 +206,14 @@ public:
     virtual bool mergeWith(const QUndoCommand * command);
     virtual void undo();
     virtual void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     const int m_track;
-    QDomElement m_effect;
-    QDomElement m_oldeffect;
+    /** @brief Only stores the parameters changed from m_oldeffect. */
+    CompactElement m_effect;
+    CompactElement m_oldeffect;
     const GenTime m_pos;
     bool m_doIt;
 };
@@ -306,16 +319,18 @@ private:
     bool m_refresh;
 };
 
-class RazorClipCommand : public QUndoCommand
+class RazorClipCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     RazorClipCommand(CustomTrackView *view, const ItemInfo &info, EffectsList stack, const GenTime &cutTime, bool doIt = true, QUndoCommand * parent = 0);
     void undo();
     void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     ItemInfo m_info;
-    EffectsList m_originalStack;
+    CompactElement m_originalStack;
     GenTime m_cutTime;
     bool m_doIt;
 };
@@ -375,17 +390,19 @@ private:
     bool m_dontWorry;
 };
 
-class SplitAudioCommand : public QUndoCommand
+class SplitAudioCommand : public QUndoCommand, public CompactableCommand
 {
 public:
     SplitAudioCommand(CustomTrackView *view, const int track, const GenTime &pos, const EffectsList &effects, QUndoCommand * parent = 0);
     void undo();
     void redo();
+    int memoryCost() const;
+    void compact();
 private:
     CustomTrackView *m_view;
     const GenTime m_pos;
     const int m_track;
-    EffectsList m_effects;
+    CompactElement m_effects;
 };
 
 #endif
@@ -144,6 +144,40 @@ bool Track::move(qreal start, qreal end, int mode)
     return result;
 }
 
+Mlt::Producer *Track::takeCut(qreal t)
+{
+    int ix = m_playlist.get_clip_index_at(frame(t));
+    bool durationChanged = (ix == m_playlist.count() - 1);
+    Mlt::Producer *clip = m_playlist.replace_with_blank(ix);
+    if (!clip || clip->is_blank()) {
+        qWarning("Error taking clip at %f", t);
+        delete clip;
+        return NULL;
+    }
+    m_playlist.consolidate_blanks();
+    if (durationChanged) emit newTrackDuration(m_playlist.get_playtime());
+    return clip;
+}
+
+bool Track::insertCut(qreal t, Mlt::Producer *cut, PlaylistState::ClipState state, int mode)
+{
+    QString service = cut->parent().get("mlt_service");
+    QString parentId = cut->parent().get("id");
+    QString trackSuffix = m_playlist.get("id");
+    if (state == PlaylistState::AudioOnly) {
+        trackSuffix.append("_audio");
+    }
+    if (!needsDuplicate(service) || state == PlaylistState::VideoOnly || parentId.endsWith(QLatin1String("_video")) || parentId.section(QStringLiteral("_"), 1) == trackSuffix) {
+        // Cut can be used as is on this track
+        return doAdd(t, cut, mode);
+    }
+    // Source is duplicated per track, cut our own copy
+    QScopedPointer<Mlt::Producer> trackProducer(clipProducer(cut, state));
+    QScopedPointer<Mlt::Producer> newCut(trackProducer->cut(cut->get_in(), cut->get_out()));
+    Clip(*newCut).moveEffects(*cut);
+    return doAdd(t, newCut.data(), mode);
+}
+
 bool Track::del(qreal t)
 {
     m_playlist.lock();
@@ -92,6 +92,19 @@ public:
      * @param mode allow insert in non-blanks by replacing (mode=1) or pushing (mode=2) content
      * @return true if success */
     bool move(qreal start, qreal end, int mode = 0);
+    /** @brief remove a clip, keeping its cut and filters for insertCut()
+     * The playlist must be locked / unlocked before and after calling takeCut
+     * @param t is the clip start (in seconds)
+     * @return the cut, owned by the caller, or NULL if there is no clip at t */
+    Mlt::Producer *takeCut(qreal t);
+    /** @brief insert a cut removed from a track with takeCut()
+     * If the cut comes from another track and its source is duplicated per track,
+     * a cut of this track's producer is used and the filters are moved to it.
+     * The playlist must be locked / unlocked before and after calling insertCut
+     * @param t is the time position of the clip (in seconds)
+     * @param mode allow insert in non-blanks by replacing (mode=1) or pushing (mode=2) content
+     * @return true if success */
+    bool insertCut(qreal t, Mlt::Producer *cut, PlaylistState::ClipState state, int mode);
     /** @brief delete a clip
      * @param time where clip is present (in seconds);
      * @return true if success */
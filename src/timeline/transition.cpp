@@ -210,6 +210,7 @@ int Transition::type() const
 //virtual
 QVariant Transition::itemChange(GraphicsItemChange change, const QVariant &value)
 {
+    updateSceneIndex(change);
     if (change == QGraphicsItem::ItemSelectedChange) {
         if (value.toBool()) setZValue(5);
         else setZValue(4);
@@ -20,11 +20,89 @@
 
 #include "transitionhandler.h"
 
+#include <algorithm>
 
 TransitionHandler::TransitionHandler(Mlt::Tractor *tractor) :
     m_tractor(tractor)
+    , m_registryValid(false)
+    , m_fieldEvent(NULL)
 {
-    
+    QScopedPointer<Mlt::Field> field(m_tractor->field());
+    m_fieldEvent = field->listen("service-changed", this, (mlt_listener) TransitionHandler::fieldChanged);
+}
+
+TransitionHandler::~TransitionHandler()
+{
+    delete m_fieldEvent;
+}
+
+//static
+void TransitionHandler::fieldChanged(mlt_properties, TransitionHandler *self)
+{
+    self->m_registryValid = false;
+}
+
+void TransitionHandler::updateRegistry() const
+{
+    if (m_registryValid) return;
+    m_registry.clear();
+    QScopedPointer<Mlt::Field> field(m_tractor->field());
+    mlt_service nextservice = mlt_service_get_producer(field->get_service());
+    while (nextservice && mlt_service_identify(nextservice) == transition_type) {
+        mlt_transition tr = (mlt_transition) nextservice;
+        QString resource = mlt_properties_get(MLT_SERVICE_PROPERTIES(nextservice), "mlt_service");
+        m_registry[TransitionKey(mlt_transition_get_b_track(tr), resource)].insert((int) mlt_transition_get_in(tr), tr);
+        nextservice = mlt_service_producer(nextservice);
+    }
+    m_registryValid = true;
+}
+
+mlt_transition TransitionHandler::findTransition(const QString &tag, int b_track, int position) const
+{
+    // A miss may come from in points changed behind our back, look again in a fresh registry
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass > 0) m_registryValid = false;
+        updateRegistry();
+        QHash<TransitionKey, QMultiMap<int, mlt_transition> >::const_iterator bucket = m_registry.constFind(TransitionKey(b_track, tag));
+        if (bucket == m_registry.constEnd()) continue;
+        QMultiMap<int, mlt_transition>::const_iterator it = bucket->upperBound(position);
+        while (it != bucket->constBegin()) {
+            --it;
+            mlt_transition tr = it.value();
+            if ((int) mlt_transition_get_in(tr) != it.key() || mlt_transition_get_b_track(tr) != b_track) continue;
+            if ((int) mlt_transition_get_out(tr) >= position) return tr;
+        }
+    }
+    return NULL;
+}
+
+mlt_transition TransitionHandler::findTransition(const QString &tag, int b_track, int in, int out) const
+{
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass > 0) m_registryValid = false;
+        updateRegistry();
+        QHash<TransitionKey, QMultiMap<int, mlt_transition> >::const_iterator bucket = m_registry.constFind(TransitionKey(b_track, tag));
+        if (bucket == m_registry.constEnd()) continue;
+        QMultiMap<int, mlt_transition>::const_iterator it = bucket->constFind(in);
+        for (; it != bucket->constEnd() && it.key() == in; ++it) {
+            mlt_transition tr = it.value();
+            if ((int) mlt_transition_get_in(tr) == in && (int) mlt_transition_get_out(tr) == out && mlt_transition_get_b_track(tr) == b_track) {
+                return tr;
+            }
+        }
+    }
+    return NULL;
+}
+
+void TransitionHandler::setInAndOut(mlt_transition transition, int in, int out)
+{
+    const int oldIn = (int) mlt_transition_get_in(transition);
+    mlt_transition_set_in_and_out(transition, in, out);
+    if (!m_registryValid) return;
+    TransitionKey key(mlt_transition_get_b_track(transition), QString(mlt_properties_get(MLT_TRANSITION_PROPERTIES(transition), "mlt_service")));
+    QMultiMap<int, mlt_transition> &bucket = m_registry[key];
+    bucket.remove(oldIn, transition);
+    bucket.insert(in, transition);
 }
 
 bool TransitionHandler::addTransition(QString tag, int a_track, int b_track, GenTime in, GenTime out, QDomElement xml, bool do_refresh)
@@ -200,62 +278,45 @@ void TransitionHandler::updateTransitionParams(QString type, int a_track, int b_
     QScopedPointer<Mlt::Field> field(m_tractor->field());
     field->lock();
     double fps = m_tractor->get_fps();
-    mlt_service nextservice = mlt_service_get_producer(field->get_service());
-    mlt_properties properties = MLT_SERVICE_PROPERTIES(nextservice);
-    QString resource = mlt_properties_get(properties, "mlt_service");
     int in_pos = (int) in.frames(fps);
     int out_pos = (int) out.frames(fps) - 1;
 
-    mlt_service_type mlt_type = mlt_service_identify( nextservice );
-    while (mlt_type == transition_type) {
-        mlt_transition tr = (mlt_transition) nextservice;
-        int currentTrack = mlt_transition_get_b_track(tr);
+    mlt_transition tr = findTransition(type, b_track, in_pos, out_pos);
+    if (tr) {
         int currentBTrack = mlt_transition_get_a_track(tr);
-        int currentIn = (int) mlt_transition_get_in(tr);
-        int currentOut = (int) mlt_transition_get_out(tr);
-
-        // //qDebug()<<"Looking for transition : " << currentIn <<'x'<<currentOut<< ", OLD oNE: "<<in_pos<<'x'<<out_pos;
-        if (resource == type && b_track == currentTrack && currentIn == in_pos && currentOut == out_pos) {
-            QMap<QString, QString> map = getTransitionParamsFromXml(xml);
-            QMap<QString, QString>::Iterator it;
-            QString key;
-            mlt_properties transproperties = MLT_TRANSITION_PROPERTIES(tr);
-
-            QString currentId = mlt_properties_get(transproperties, "kdenlive_id");
-            if (currentId != xml.attribute(QStringLiteral("id"))) {
-                // The transition ID is not the same, so reset all properties
-                mlt_properties_set(transproperties, "kdenlive_id", xml.attribute(QStringLiteral("id")).toUtf8().constData());
-                // Cleanup previous properties
-                QStringList permanentProps;
-                permanentProps << QStringLiteral("factory") << QStringLiteral("kdenlive_id") << QStringLiteral("mlt_service") << QStringLiteral("mlt_type") << QStringLiteral("in");
-                permanentProps << QStringLiteral("out") << QStringLiteral("a_track") << QStringLiteral("b_track");
-                for (int i = 0; i < mlt_properties_count(transproperties); ++i) {
-                    QString propName = mlt_properties_get_name(transproperties, i);
-                    if (!propName.startsWith('_') && ! permanentProps.contains(propName)) {
-                        mlt_properties_set(transproperties, propName.toUtf8().constData(), "");
-                    }
+        QMap<QString, QString> map = getTransitionParamsFromXml(xml);
+        QMap<QString, QString>::Iterator it;
+        QString key;
+        mlt_properties transproperties = MLT_TRANSITION_PROPERTIES(tr);
+
+        QString currentId = mlt_properties_get(transproperties, "kdenlive_id");
+        if (currentId != xml.attribute(QStringLiteral("id"))) {
+            // The transition ID is not the same, so reset all properties
+            mlt_properties_set(transproperties, "kdenlive_id", xml.attribute(QStringLiteral("id")).toUtf8().constData());
+            // Cleanup previous properties
+            QStringList permanentProps;
+            permanentProps << QStringLiteral("factory") << QStringLiteral("kdenlive_id") << QStringLiteral("mlt_service") << QStringLiteral("mlt_type") << QStringLiteral("in");
+            permanentProps << QStringLiteral("out") << QStringLiteral("a_track") << QStringLiteral("b_track");
+            for (int i = 0; i < mlt_properties_count(transproperties); ++i) {
+                QString propName = mlt_properties_get_name(transproperties, i);
+                if (!propName.startsWith('_') && ! permanentProps.contains(propName)) {
+                    mlt_properties_set(transproperties, propName.toUtf8().constData(), "");
                 }
             }
+        }
 
-            mlt_properties_set_int(transproperties, "force_track", xml.attribute(QStringLiteral("force_track")).toInt());
-            mlt_properties_set_int(transproperties, "automatic", xml.attribute(QStringLiteral("automatic"), QStringLiteral("0")).toInt());
+        mlt_properties_set_int(transproperties, "force_track", xml.attribute(QStringLiteral("force_track")).toInt());
+        mlt_properties_set_int(transproperties, "automatic", xml.attribute(QStringLiteral("automatic"), QStringLiteral("0")).toInt());
 
-            if (currentBTrack != a_track) {
-                mlt_properties_set_int(transproperties, "a_track", a_track);
-            }
-            for (it = map.begin(); it != map.end(); ++it) {
-                key = it.key();
-                mlt_properties_set(transproperties, key.toUtf8().constData(), it.value().toUtf8().constData());
-                //qDebug() << " ------  UPDATING TRANS PARAM: " << key.toUtf8().constData() << ": " << it.value().toUtf8().constData();
-                //filter->set("kdenlive_id", id);
-            }
-            break;
+        if (currentBTrack != a_track) {
+            mlt_properties_set_int(transproperties, "a_track", a_track);
+        }
+        for (it = map.begin(); it != map.end(); ++it) {
+            key = it.key();
+            mlt_properties_set(transproperties, key.toUtf8().constData(), it.value().toUtf8().constData());
+            //qDebug() << " ------  UPDATING TRANS PARAM: " << key.toUtf8().constData() << ": " << it.value().toUtf8().constData();
+            //filter->set("kdenlive_id", id);
         }
-        nextservice = mlt_service_producer(nextservice);
-        if (nextservice == NULL) break;
-        properties = MLT_SERVICE_PROPERTIES(nextservice);
-        mlt_type = mlt_service_identify( nextservice );
-        resource = mlt_properties_get(properties, "mlt_service");
     }
     field->unlock();
     //askForRefresh();
@@ -267,30 +328,12 @@ void TransitionHandler::deleteTransition(QString tag, int /*a_track*/, int b_tra
 {
     QScopedPointer<Mlt::Field> field(m_tractor->field());
     field->lock();
-    mlt_service nextservice = mlt_service_get_producer(field->get_service());
-    mlt_properties properties = MLT_SERVICE_PROPERTIES(nextservice);
-    QString resource = mlt_properties_get(properties, "mlt_service");
     double fps = m_tractor->get_fps();
     const int old_pos = (int)((in + out).frames(fps) / 2);
     ////qDebug() << " del trans pos: " << in.frames(25) << '-' << out.frames(25);
-
-    mlt_service_type mlt_type = mlt_service_identify( nextservice );
-    while (mlt_type == transition_type) {
-        mlt_transition tr = (mlt_transition) nextservice;
-        int currentTrack = mlt_transition_get_b_track(tr);
-        int currentIn = (int) mlt_transition_get_in(tr);
-        int currentOut = (int) mlt_transition_get_out(tr);
-        ////qDebug() << "// FOUND EXISTING TRANS, IN: " << currentIn << ", OUT: " << currentOut << ", TRACK: " << currentTrack;
-
-        if (resource == tag && b_track == currentTrack && currentIn <= old_pos && currentOut >= old_pos) {
-            mlt_field_disconnect_service(field->get_field(), nextservice);
-            break;
-        }
-        nextservice = mlt_service_producer(nextservice);
-        if (nextservice == NULL) break;
-        properties = MLT_SERVICE_PROPERTIES(nextservice);
-        mlt_type = mlt_service_identify( nextservice );
-        resource = mlt_properties_get(properties, "mlt_service");
+    mlt_transition tr = findTransition(tag, b_track, old_pos);
+    if (tr) {
+        mlt_field_disconnect_service(field->get_field(), MLT_TRANSITION_SERVICE(tr));
     }
     field->unlock();
     //askForRefresh();
@@ -300,17 +343,19 @@ void TransitionHandler::deleteTransition(QString tag, int /*a_track*/, int b_tra
 void TransitionHandler::deleteTrackTransitions(int ix)
 {
     QScopedPointer<Mlt::Field> field(m_tractor->field());
-    mlt_service nextservice = mlt_service_get_producer(field->get_service());
-    mlt_service_type type = mlt_service_identify( nextservice );
-    while (type == transition_type) {
-	Mlt::Transition transition((mlt_transition) nextservice);
-        nextservice = mlt_service_producer(nextservice);
-        int currentTrack = transition.get_b_track();
-        if (ix == currentTrack) {
-            field->disconnect_service(transition);
+    // Rare operation, start from a fresh registry in case tracks were changed behind our back
+    m_registryValid = false;
+    updateRegistry();
+    // Collect first, disconnecting invalidates the registry
+    QList <mlt_transition> transitions;
+    QHash<TransitionKey, QMultiMap<int, mlt_transition> >::const_iterator it = m_registry.constBegin();
+    for (; it != m_registry.constEnd(); ++it) {
+        if (it.key().first == ix) transitions << it.value().values();
+    }
+    foreach(mlt_transition tr, transitions) {
+        if (mlt_transition_get_b_track(tr) == ix) {
+            mlt_field_disconnect_service(field->get_field(), MLT_TRANSITION_SERVICE(tr));
         }
-        if (nextservice == NULL) break;
-        type = mlt_service_identify(nextservice );
     }
 }
 
@@ -334,65 +379,90 @@ bool TransitionHandler::moveTransition(QString type, int startTrack, int newTrac
     }
     QScopedPointer<Mlt::Field> field(m_tractor->field());
     field->lock();
-    mlt_service nextservice = mlt_service_get_producer(field->get_service());
-    mlt_properties properties = MLT_SERVICE_PROPERTIES(nextservice);
-    QString resource = mlt_properties_get(properties, "mlt_service");
     int old_pos = (int)(old_in + old_out) / 2;
-    bool found = false;
-    mlt_service_type mlt_type = mlt_service_identify( nextservice );
-    while (mlt_type == transition_type) {
-        Mlt::Transition transition((mlt_transition) nextservice);
-        nextservice = mlt_service_producer(nextservice);
-        int currentTrack = transition.get_b_track();
-        int currentIn = (int) transition.get_in();
-        int currentOut = (int) transition.get_out();
-
-        if (resource == type && startTrack == currentTrack && currentIn <= old_pos && currentOut >= old_pos) {
-            found = true;
-            if (newTrack - startTrack != 0) {
-                Mlt::Properties trans_props(transition.get_properties());
-                Mlt::Transition new_transition(*m_tractor->profile(), transition.get("mlt_service"));
+    mlt_transition tr = findTransition(type, startTrack, old_pos);
+    bool found = tr != NULL;
+    if (found) {
+        if (newTrack - startTrack != 0) {
+            Mlt::Transition transition(tr);
+            Mlt::Properties trans_props(transition.get_properties());
+            Mlt::Transition new_transition(*m_tractor->profile(), transition.get("mlt_service"));
+            Mlt::Properties new_trans_props(new_transition.get_properties());
+            // We cannot use MLT's property inherit because it also clones internal values like _unique_id which messes up the playlist
+            cloneProperties(new_trans_props, trans_props);
+            new_transition.set_in_and_out(new_in, new_out);
+            field->disconnect_service(transition);
+            plantTransition(field.data(), new_transition, newTransitionTrack, newTrack);
+        } else setInAndOut(tr, new_in, new_out);
+    }
+    field->unlock();
+    if (doRefresh) refresh();
+    //if (m_isBlocked == 0) m_mltConsumer->set("refresh", 1);
+    return found;
+}
+
+int TransitionHandler::moveTransitions(const QList <TransitionMove> &moves, QList <int> *missing)
+{
+    if (moves.isEmpty()) return 0;
+    double fps = m_tractor->get_fps();
+    QScopedPointer<Mlt::Field> field(m_tractor->field());
+    field->lock();
+    // Find all transitions before changing anything, planting modifies the chain
+    QList <QPair <Mlt::Transition *, int> > found;
+    for (int i = 0; i < moves.count(); ++i) {
+        const TransitionMove &move = moves.at(i);
+        int old_pos = ((int) move.oldInfo.startPos.frames(fps) + (int) move.oldInfo.endPos.frames(fps) - 1) / 2;
+        mlt_transition tr = findTransition(move.tag, move.oldInfo.b_track, old_pos);
+        bool duplicate = false;
+        for (int j = 0; j < found.count() && !duplicate; ++j) {
+            duplicate = found.at(j).first->get_transition() == tr;
+        }
+        if (tr && !duplicate) found << qMakePair(new Mlt::Transition(tr), i);
+        else if (missing) missing->append(i);
+    }
+    for (int i = 0; i < found.count(); ++i) {
+        Mlt::Transition *transition = found.at(i).first;
+        const TransitionMove &move = moves.at(found.at(i).second);
+        int new_in = (int) move.newInfo.startPos.frames(fps);
+        int new_out = (int) move.newInfo.endPos.frames(fps) - 1;
+        if (new_in < new_out) {
+            if (move.newInfo.b_track != move.oldInfo.b_track || move.newInfo.a_track != transition->get_a_track()) {
+                Mlt::Properties trans_props(transition->get_properties());
+                Mlt::Transition new_transition(*m_tractor->profile(), transition->get("mlt_service"));
                 Mlt::Properties new_trans_props(new_transition.get_properties());
-                // We cannot use MLT's property inherit because it also clones internal values like _unique_id which messes up the playlist
                 cloneProperties(new_trans_props, trans_props);
                 new_transition.set_in_and_out(new_in, new_out);
-                field->disconnect_service(transition);
-                plantTransition(field.data(), new_transition, newTransitionTrack, newTrack);
-            } else transition.set_in_and_out(new_in, new_out);
-            break;
+                field->disconnect_service(*transition);
+                plantTransition(field.data(), new_transition, move.newInfo.a_track, move.newInfo.b_track);
+            } else {
+                setInAndOut(transition->get_transition(), new_in, new_out);
+            }
         }
-        if (nextservice == NULL) break;
-        properties = MLT_SERVICE_PROPERTIES(nextservice);
-        mlt_type = mlt_service_identify( nextservice );
-        resource = mlt_properties_get(properties, "mlt_service");
+        delete transition;
     }
     field->unlock();
-    if (doRefresh) refresh();
-    //if (m_isBlocked == 0) m_mltConsumer->set("refresh", 1);
-    return found;
+    return found.count();
 }
 
 Mlt::Transition *TransitionHandler::getTransition(const QString &name, int b_track, int a_track, bool internalTransition) const
 {
-    QScopedPointer<Mlt::Service> service(m_tractor->field());
-    while (service && service->is_valid()) {
-        if (service->type() == transition_type) {
-            Mlt::Transition t((mlt_transition) service->get_service());
-            if (name == t.get("mlt_service") && t.get_b_track() == b_track) {
-                if (a_track == -1 || t.get_a_track() == a_track) {
-                    int internal = t.get_int("internal_added");
-                    if (internal == 0) {
-                      if (!internalTransition) {
-                          return new Mlt::Transition(t);
-                      }
-                    }
-                    else if (internalTransition) {
-                        return new Mlt::Transition(t);
-                    }
-                }
+    updateRegistry();
+    const QMultiMap<int, mlt_transition> planted = m_registry.value(TransitionKey(b_track, name));
+    QMultiMap<int, mlt_transition>::const_iterator it = planted.constBegin();
+    for (; it != planted.constEnd(); ++it) {
+        Mlt::Transition t(it.value());
+        if (t.get_b_track() != b_track) continue;
+        if (a_track == -1 || t.get_a_track() == a_track) {
+            int internal = t.get_int("internal_added");
+            if (internal == 0) {
+              if (!internalTransition) {
+                  return new Mlt::Transition(t);
+              }
+            }
+            else if (internalTransition) {
+                return new Mlt::Transition(t);
             }
         }
-        service.reset(service->producer());
     }
     return 0;
 }
@@ -514,30 +584,33 @@ void TransitionHandler::enableMultiTrack(bool enable)
 
 void TransitionHandler::rebuildComposites(int lowestVideoTrack)
 {
-    QList <Mlt::Transition *>composites;
+    // Get the list of internal composite transitions from the registry
+    QList <mlt_transition> composites;
     QList <int> disabled;
-    QScopedPointer<Mlt::Service> service(m_tractor->field());
-    // Get the list of composite transitions
-    while (service && service->is_valid()) {
-        if (service->type() == transition_type) {
-            Mlt::Transition t((mlt_transition) service->get_service());
-            int internal = t.get_int("internal_added");
-            if (internal == 0) {
-                return;
+    updateRegistry();
+    QHash<TransitionKey, QMultiMap<int, mlt_transition> >::const_iterator it = m_registry.constBegin();
+    for (; it != m_registry.constEnd(); ++it) {
+        const QString &service = it.key().second;
+        if (service != QLatin1String("frei0r.cairoblend") && service != QLatin1String("movit.overlay")) {
+            continue;
+        }
+        foreach(mlt_transition tr, it.value()) {
+            mlt_properties properties = MLT_TRANSITION_PROPERTIES(tr);
+            if (mlt_properties_get_int(properties, "internal_added") == 0) {
+                continue;
             }
-            QString service = t.get("mlt_service");
-            if (service == QLatin1String("frei0r.cairoblend") || service == QLatin1String("movit.overlay")) {
-                composites << new Mlt::Transition(t);
-                if (t.get_int("disable") == 1) {
-                    disabled << t.get_int("b_track");
-                }
+            composites << tr;
+            if (mlt_properties_get_int(properties, "disable") == 1) {
+                disabled << mlt_properties_get_int(properties, "b_track");
             }
         }
-        service.reset(service->producer());
     }
-    for (int i = 0; i < composites.count(); i++) {
-        Mlt::Transition *tr = composites.at(i);
-        int bTrack = tr->get_int("b_track");
+    std::sort(disabled.begin(), disabled.end());
+    QScopedPointer<Mlt::Field> field(m_tractor->field());
+    field->lock();
+    foreach(mlt_transition tr, composites) {
+        mlt_properties properties = MLT_TRANSITION_PROPERTIES(tr);
+        int bTrack = mlt_properties_get_int(properties, "b_track");
         if (disabled.contains(bTrack)) {
             // transition disabled, pass
             continue;
@@ -548,7 +621,7 @@ void TransitionHandler::rebuildComposites(int lowestVideoTrack)
                 aTrack = disabled.at(j);
             } else break;
         }
-        tr->set("a_track", aTrack);
+        mlt_properties_set_int(properties, "a_track", aTrack);
     }
-    qDeleteAll(composites);
+    field->unlock();
 }
@@ -29,6 +29,16 @@
 #include "definitions.h"
 #include <mlt++/Mlt.h>
 
+#include <QHash>
+#include <QMultiMap>
+
+/** @brief A transition to move with TransitionHandler::moveTransitions().
+ *  oldInfo gives the tag's current b_track and position, newInfo its new tracks and position. */
+struct TransitionMove {
+    QString tag;
+    TransitionInfo oldInfo;
+    TransitionInfo newInfo;
+};
 
 class TransitionHandler : public QObject
 {
@@ -36,6 +46,7 @@ class TransitionHandler : public QObject
 
 public:
     explicit TransitionHandler(Mlt::Tractor *tractor);
+    ~TransitionHandler();
     bool addTransition(QString tag, int a_track, int b_track, GenTime in, GenTime out, QDomElement xml, bool do_refresh = true);
     QMap<QString, QString> getTransitionParamsFromXml(const QDomElement &xml);
     void plantTransition(Mlt::Transition &tr, int a_track, int b_track);
@@ -46,6 +57,10 @@ public:
     void deleteTransition(QString tag, int a_track, int b_track, GenTime in, GenTime out, QDomElement xml, bool refresh = true);
     void deleteTrackTransitions(int ix);
     bool moveTransition(QString type, int startTrack,  int newTrack, int newTransitionTrack, GenTime oldIn, GenTime oldOut, GenTime newIn, GenTime newOut);
+    /** @brief Move several transitions while the field is locked once, the caller has to refresh the monitor.
+     *  @param missing if not NULL, receives the indexes of the moves whose transition was not found
+     *  @return the number of transitions found */
+    int moveTransitions(const QList <TransitionMove> &moves, QList <int> *missing = NULL);
     QList <TransitionInfo> mltInsertTrack(int ix, const QString &name, bool videoTrack);
     void duplicateTransitionOnPlaylist(int in, int out, QString tag, QDomElement xml, int a_track, int b_track, Mlt::Field *field);
     /** @brief Get a transition with tag name. */
@@ -58,6 +73,25 @@ public:
 private:
     Mlt::Tractor *m_tractor;
 
+    /** @brief Registry key: b_track and mlt_service of a transition. */
+    typedef QPair<int, QString> TransitionKey;
+    /** @brief Transitions planted in the field, by b_track and service, ordered by in point.
+     *  The registry is rebuilt with one walk of the field chain after MLT reports that a
+     *  service was planted or disconnected, whoever did it. In and out points or a_track can
+     *  change without notice, so they are checked on the planted transition when looking up. */
+    mutable QHash<TransitionKey, QMultiMap<int, mlt_transition> > m_registry;
+    mutable bool m_registryValid;
+    Mlt::Event *m_fieldEvent;
+
+    static void fieldChanged(mlt_properties owner, TransitionHandler *self);
+    void updateRegistry() const;
+    /** @brief Returns the transition of type @param tag on @param b_track covering @param position, NULL if none. */
+    mlt_transition findTransition(const QString &tag, int b_track, int position) const;
+    /** @brief Returns the transition of type @param tag on @param b_track with these exact in and out points, NULL if none. */
+    mlt_transition findTransition(const QString &tag, int b_track, int in, int out) const;
+    /** @brief Moves a transition found in the registry and updates its entry. */
+    void setInAndOut(mlt_transition transition, int in, int out);
+
 signals:
     void refresh();
 };
@@ -0,0 +1,289 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QList>
+#include <QDomElement>
+#include <mlt++/Mlt.h>
+#include <iostream>
+
+#include "timeline/track.h"
+#include "timeline/transitionhandler.h"
+
+/*
+ * Compares the two ways CustomTrackView::moveGroup moved a group of clips
+ * and their transitions, using the timeline Track and TransitionHandler:
+ * - rebuild: each clip is deleted, cut again at the destination with
+ *   Track::add and its effects are added again one by one the way
+ *   Render::mltAddEffect does, transitions are moved one by one with
+ *   TransitionHandler::moveTransition
+ * - batch: the cuts are taken out with Track::takeCut and put back with
+ *   their filters by Track::insertCut while the tractor is locked once,
+ *   transitions are moved by TransitionHandler::moveTransitions
+ *
+ * Clips are on track 2 with a transition to track 1. With --cross-track
+ * they move to track 3, their transitions then go from track 3 to track 2.
+ */
+
+static const int clipLength = 50;
+static const int gapLength = 10;
+static const char transitionTag[] = "luma";
+
+void printUsage(const char *path)
+{
+    std::cout << "Moves N clips carrying M effects in an MLT tractor and prints the time spent." << std::endl << std::endl
+              << path << " [options]" << std::endl
+              << "\t-h, --help\n\t\tDisplay this help" << std::endl
+              << "\t--clips=<N>\n\t\tNumber of clips to move (default 500)" << std::endl
+              << "\t--effects=<M>\n\t\tNumber of effects on each clip (default 10)" << std::endl
+              << "\t--file=<media>\n\t\tUse this media for the clips instead of a colour, avformat sources are duplicated per track" << std::endl
+              << "\t--cross-track\n\t\tMove the clips to another track" << std::endl
+                 ;
+}
+
+/** A tractor with the black track and three playlists, wrapped by timeline tracks. */
+class Timeline
+{
+public:
+    Timeline(Mlt::Profile &profile)
+        : tractor(profile)
+    {
+        for (int i = 0; i < 4; ++i) {
+            Mlt::Playlist playlist(profile);
+            playlist.set("id", i == 0 ? "black_track" : QString("playlist%1").arg(i).toUtf8().constData());
+            tractor.set_track(playlist, i);
+            QScopedPointer<Mlt::Producer> trackProducer(tractor.track(i));
+            Mlt::Playlist trackPlaylist((mlt_playlist) trackProducer->get_service());
+            tracks << new Track(i, QList<QAction *>(), trackPlaylist, VideoTrack);
+        }
+        transitions = new TransitionHandler(&tractor);
+    }
+    ~Timeline()
+    {
+        delete transitions;
+        qDeleteAll(tracks);
+    }
+    Mlt::Tractor tractor;
+    QList <Track *> tracks;
+    TransitionHandler *transitions;
+};
+
+/** Fills track 2 with count clips separated by blanks, each with effects filters and a transition. */
+void fillTimeline(Mlt::Profile &profile, Timeline &timeline, Mlt::Producer &source, int count, int effects)
+{
+    const double fps = profile.fps();
+    Track *track = timeline.tracks.at(2);
+    for (int i = 0; i < count; ++i) {
+        const int start = i * (clipLength + gapLength) + gapLength;
+        QScopedPointer<Mlt::Producer> cut(source.cut(0, clipLength - 1));
+        for (int j = 0; j < effects; ++j) {
+            Mlt::Filter filter(profile, "brightness");
+            filter.set("kdenlive_id", "brightness");
+            filter.set("kdenlive_ix", j + 1);
+            filter.set("start", 1.0);
+            cut->attach(filter);
+        }
+        track->playlist().lock();
+        track->insertCut(GenTime(start, fps).seconds(), cut.data(), PlaylistState::Original, 0);
+        track->playlist().unlock();
+        timeline.transitions->addTransition(transitionTag, 1, 2, GenTime(start, fps), GenTime(start + clipLength, fps), QDomElement(), false);
+    }
+}
+
+/** Returns the start frame of every clip of the playlist. */
+QList <int> clipPositions(Mlt::Playlist &playlist)
+{
+    QList <int> positions;
+    for (int i = 0; i < playlist.count(); ++i) {
+        if (!playlist.is_blank(i)) positions << playlist.clip_start(i);
+    }
+    return positions;
+}
+
+/** Counts the filters attached to the clips of the playlist, to check that no effect was lost. */
+int effectCount(Mlt::Playlist &playlist)
+{
+    int count = 0;
+    for (int i = 0; i < playlist.count(); ++i) {
+        if (playlist.is_blank(i)) continue;
+        QScopedPointer<Mlt::Producer> clip(playlist.get_clip(i));
+        count += clip->filter_count();
+    }
+    return count;
+}
+
+/** Adds an effect like Render::mltAddEffect(track, position, params, false): the clip is looked up in its
+ *  track, filters after the insert point are detached and attached again after the new one. */
+void addEffect(Mlt::Tractor &tractor, int track, int position, int ix)
+{
+    QScopedPointer<Mlt::Producer> tk(tractor.track(track));
+    Mlt::Playlist trackPlaylist((mlt_playlist) tk->get_service());
+    QScopedPointer<Mlt::Producer> clip(trackPlaylist.get_clip(trackPlaylist.get_clip_index_at(position)));
+    if (!clip) return;
+    Mlt::Service service(clip->get_service());
+    service.lock();
+    QList <Mlt::Filter *> filtersList;
+    int ct = 0;
+    Mlt::Filter *filter = service.filter(ct);
+    while (filter) {
+        if (filter->get_int("kdenlive_ix") >= ix) {
+            filtersList.append(filter);
+            service.detach(*filter);
+        } else {
+            delete filter;
+            ct++;
+        }
+        filter = service.filter(ct);
+    }
+    Mlt::Filter effect(*service.profile(), "brightness");
+    effect.set("kdenlive_id", "brightness");
+    effect.set("kdenlive_ix", ix);
+    effect.set("start", 1.0);
+    service.attach(effect);
+    for (int i = 0; i < filtersList.count(); ++i) {
+        service.attach(*filtersList.at(i));
+    }
+    qDeleteAll(filtersList);
+    service.unlock();
+}
+
+qint64 rebuildMove(Timeline &timeline, int sourceTrack, int destTrack, int offset, int effects)
+{
+    const double fps = timeline.tractor.get_fps();
+    Track *source = timeline.tracks.at(sourceTrack);
+    Track *dest = timeline.tracks.at(destTrack);
+    QElapsedTimer timer;
+    timer.start();
+    QList <int> positions = clipPositions(source->playlist());
+    QList <Mlt::Producer *> parents;
+    foreach (int pos, positions) {
+        QScopedPointer<Mlt::Producer> clip(source->playlist().get_clip(source->playlist().get_clip_index_at(pos)));
+        parents << new Mlt::Producer(clip->parent());
+        source->del(GenTime(pos, fps).seconds());
+    }
+    for (int i = 0; i < positions.count(); ++i) {
+        const int newPos = positions.at(i) + offset;
+        dest->add(GenTime(newPos, fps).seconds(), parents.at(i), 0, GenTime(clipLength, fps).seconds(), PlaylistState::Original, true, 0);
+        for (int j = 0; j < effects; ++j) {
+            addEffect(timeline.tractor, destTrack, newPos, j + 1);
+        }
+        delete parents.at(i);
+    }
+    foreach (int pos, positions) {
+        timeline.transitions->moveTransition(transitionTag, sourceTrack, destTrack, destTrack - 1, GenTime(pos, fps), GenTime(pos + clipLength, fps),
+                                             GenTime(pos + offset, fps), GenTime(pos + offset + clipLength, fps));
+    }
+    return timer.elapsed();
+}
+
+qint64 batchMove(Timeline &timeline, int sourceTrack, int destTrack, int offset, int *missing)
+{
+    const double fps = timeline.tractor.get_fps();
+    Track *source = timeline.tracks.at(sourceTrack);
+    Track *dest = timeline.tracks.at(destTrack);
+    QElapsedTimer timer;
+    timer.start();
+    timeline.tractor.lock();
+    QList <int> positions = clipPositions(source->playlist());
+    QList <Mlt::Producer *> cuts;
+    QList <TransitionMove> moves;
+    foreach (int pos, positions) {
+        source->playlist().lock();
+        Mlt::Producer *cut = source->takeCut(GenTime(pos, fps).seconds());
+        source->playlist().unlock();
+        cuts << cut;
+        TransitionMove move;
+        move.tag = transitionTag;
+        move.oldInfo.startPos = GenTime(pos, fps);
+        move.oldInfo.endPos = GenTime(pos + clipLength, fps);
+        move.oldInfo.b_track = sourceTrack;
+        move.oldInfo.a_track = sourceTrack - 1;
+        move.newInfo.startPos = GenTime(pos + offset, fps);
+        move.newInfo.endPos = GenTime(pos + offset + clipLength, fps);
+        move.newInfo.b_track = destTrack;
+        move.newInfo.a_track = destTrack - 1;
+        moves << move;
+    }
+    for (int i = 0; i < cuts.count(); ++i) {
+        if (!cuts.at(i)) continue;
+        dest->playlist().lock();
+        dest->insertCut(GenTime(positions.at(i) + offset, fps).seconds(), cuts.at(i), PlaylistState::Original, 0);
+        dest->playlist().unlock();
+        delete cuts.at(i);
+    }
+    QList <int> notFound;
+    timeline.transitions->moveTransitions(moves, &notFound);
+    *missing = notFound.count();
+    timeline.tractor.unlock();
+    return timer.elapsed();
+}
+
+int main(int argc, char *argv[])
+{
+    // Track headers are widgets, but nothing is shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeAt(0);
+
+    int clips = 500;
+    int effects = 10;
+    bool crossTrack = false;
+    QString file;
+
+    foreach (const QString &str, args) {
+        if (str.startsWith(QLatin1String("--clips="))) {
+            clips = str.section('=', 1).toInt();
+        } else if (str.startsWith(QLatin1String("--effects="))) {
+            effects = str.section('=', 1).toInt();
+        } else if (str.startsWith(QLatin1String("--file="))) {
+            file = str.section('=', 1);
+        } else if (str == "--cross-track") {
+            crossTrack = true;
+        } else {
+            printUsage(argv[0]);
+            return str == "-h" || str == "--help" ? 0 : 1;
+        }
+    }
+
+    Mlt::Factory::init();
+    Mlt::Profile profile("atsc_1080p_25");
+    Mlt::Producer source(profile, file.isEmpty() ? "color:red" : file.toUtf8().constData());
+    if (!source.is_valid()) {
+        std::cout << file.toStdString() << " is invalid." << std::endl;
+        return 2;
+    }
+    source.set("id", "1");
+    if (file.isEmpty()) source.set("length", clipLength * 10);
+    // Move by a few frames, the clips are separated by blanks so they only overlap themselves
+    const int offset = gapLength / 2;
+    const int destTrack = crossTrack ? 3 : 2;
+
+    Timeline rebuild(profile);
+    fillTimeline(profile, rebuild, source, clips, effects);
+    qint64 rebuildTime = rebuildMove(rebuild, 2, destTrack, offset, effects);
+    const int rebuildEffects = effectCount(rebuild.tracks.at(destTrack)->playlist());
+
+    Timeline batch(profile);
+    fillTimeline(profile, batch, source, clips, effects);
+    int missing = 0;
+    qint64 batchTime = batchMove(batch, 2, destTrack, offset, &missing);
+    const int batchEffects = effectCount(batch.tracks.at(destTrack)->playlist());
+
+    std::cout << "Moving " << clips << " clips with " << effects << " effects" << (crossTrack ? " to another track" : "") << std::endl
+              << "\trebuild: " << rebuildTime << " ms, " << rebuildEffects << " effects at destination" << std::endl
+              << "\tbatch:   " << batchTime << " ms, " << batchEffects << " effects at destination, "
+              << missing << " transitions not found" << std::endl;
+    return 0;
+}
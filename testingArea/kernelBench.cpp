@@ -0,0 +1,350 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include <QGuiApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QList>
+#include <QStringList>
+#include <mlt++/Mlt.h>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "../src/scopes/colorscopes/frameanalysis.h"
+#include "../src/scopes/colorscopes/histogramgenerator.h"
+#include "../src/scopes/colorscopes/rgbparadegenerator.h"
+#include "../src/scopes/colorscopes/scopekernels.h"
+#include "../src/scopes/colorscopes/vectorscopegenerator.h"
+#include "../src/scopes/colorscopes/waveformgenerator.h"
+#include "../src/lib/audio/audioCorrelation.h"
+#include "../src/lib/audio/audioEnvelope.h"
+#include "../src/lib/audio/fftCorrelation.h"
+#include "../src/lib/audio/fftTools.h"
+#include "../src/doc/kthumb.h"
+
+/*
+ * Measures the throughput of the kernels run for each monitor frame or
+ * audio buffer: the colour scope analysis and generators, the audio
+ * spectrum FFT, audio envelopes and their correlation, and the thumbnail
+ * frame conversion.
+ *
+ * Synthetic frames and audio are used unless a media file is given, the
+ * thumbnails then come from an MLT noise producer. Runs headless, the
+ * offscreen platform is used when no other one is set.
+ */
+
+static const int sampleRate = 48000;
+static const int channels = 2;
+static const int framePool = 8;
+
+void printUsage(const char *path)
+{
+    std::cout << "Runs frames and audio buffers through the scope, audio and thumbnail kernels and prints their throughput." << std::endl << std::endl
+              << path << " [options]" << std::endl
+              << "\t-h, --help\n\t\tDisplay this help" << std::endl
+              << "\t--frames=<N>\n\t\tNumber of frames to process in each benchmark (default 100)" << std::endl
+              << "\t--size=<W>x<H>\n\t\tSize of the synthetic frames (default 1920x1080)" << std::endl
+              << "\t--file=<media>\n\t\tUse the frames and audio of this file instead of synthetic data" << std::endl
+              << "\t--only=<scopes|audio|thumbs>\n\t\tOnly run one group of benchmarks" << std::endl
+              << "The scope kernels can be forced with KDENLIVE_SCOPE_KERNELS=avx2|sse2|scalar." << std::endl
+                 ;
+}
+
+/** Prints the throughput of count frames of bytes bytes each, processed in ms milliseconds. */
+void report(const char *name, int count, qint64 bytes, qint64 ms)
+{
+    const double seconds = qMax(ms, (qint64) 1) / 1000.0;
+    std::cout << "\t" << std::left << std::setw(28) << name << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1) << count / seconds << " frames/s"
+              << std::setw(10) << bytes * count / seconds / 1048576 << " MB/s" << std::endl;
+}
+
+/** Colour gradients moving with index, with some noise so that most bins get hits. */
+QImage syntheticFrame(const QSize &size, int index)
+{
+    QImage image(size, QImage::Format_RGB32);
+    const int w = size.width();
+    const int h = size.height();
+    quint32 seed = index + 1;
+    for (int y = 0; y < h; ++y) {
+        QRgb *line = (QRgb *) image.scanLine(y);
+        for (int x = 0; x < w; ++x) {
+            seed = seed * 1664525 + 1013904223;
+            const int noise = (seed >> 24) & 31;
+            line[x] = qRgb((x * 255 / w + index + noise) & 255, (y * 255 / h + noise) & 255,
+                           ((x + y) * 255 / (w + h) + 2 * index) & 255);
+        }
+    }
+    return image;
+}
+
+/** Sine sweep with noise, interleaved stereo, one video frame worth of samples per frame. */
+audioShortVector syntheticAudio(int frames, double fps)
+{
+    const int samples = frames * qRound(sampleRate / fps);
+    audioShortVector audio(samples * channels);
+    quint32 seed = 1;
+    for (int i = 0; i < samples; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        const double t = (double) i / sampleRate;
+        const double value = 12000 * sin(2 * M_PI * (200 + 2000 * t) * t) + ((int) (seed >> 20) - 2048);
+        for (int c = 0; c < channels; ++c) {
+            audio[i * channels + c] = (qint16) value;
+        }
+    }
+    return audio;
+}
+
+/** Sum of the absolute sample values of each frame of the first channel, like AudioEnvelope. */
+QVector <qint64> syntheticEnvelope(const audioShortVector &audio, int samplesPerFrame)
+{
+    const int frames = audio.size() / channels / samplesPerFrame;
+    QVector <qint64> envelope(frames);
+    for (int i = 0; i < frames; ++i) {
+        qint64 sum = 0;
+        for (int k = 0; k < samplesPerFrame; ++k) {
+            sum += abs(audio.at((i * samplesPerFrame + k) * channels));
+        }
+        envelope[i] = sum;
+    }
+    return envelope;
+}
+
+void benchScopes(const QList <QImage> &frames, int count)
+{
+    std::cout << "Colour scopes (" << ScopeKernels::instructionSet() << " kernels, "
+              << frames.first().width() << "x" << frames.first().height() << ")" << std::endl;
+    const qint64 frameBytes = frames.first().width() * frames.first().height() * 4;
+    const FrameAnalysis::Parts allParts = FrameAnalysis::Histograms | FrameAnalysis::Waveform | FrameAnalysis::Parade
+            | FrameAnalysis::ChromaYUV | FrameAnalysis::ChromaColors | FrameAnalysis::Luma601 | FrameAnalysis::Luma709;
+    QElapsedTimer timer;
+
+    QList <FrameAnalysisPtr> analyses;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        FrameAnalysisPtr analysis = FrameAnalysis::analyse(frames.at(i % frames.count()), allParts);
+        if (analyses.count() < frames.count()) analyses << analysis;
+    }
+    report("analysis, all parts", count, frameBytes, timer.elapsed());
+
+    const struct {
+        const char *name;
+        FrameAnalysis::Parts parts;
+    } singleParts[] = {
+        { "analysis, histograms", FrameAnalysis::Histograms | FrameAnalysis::Luma709 },
+        { "analysis, waveform", FrameAnalysis::Waveform | FrameAnalysis::Luma709 },
+        { "analysis, parade", FrameAnalysis::Parade },
+        { "analysis, vectorscope", FrameAnalysis::ChromaYUV }
+    };
+    for (uint k = 0; k < sizeof(singleParts) / sizeof(singleParts[0]); ++k) {
+        timer.start();
+        for (int i = 0; i < count; ++i) {
+            FrameAnalysis::analyse(frames.at(i % frames.count()), singleParts[k].parts);
+        }
+        report(singleParts[k].name, count, frameBytes, timer.elapsed());
+    }
+
+    WaveformGenerator waveform;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        waveform.calculateWaveform(QSize(720, 300), *analyses.at(i % analyses.count()), WaveformGenerator::PaintMode_Green,
+                                   true, WaveformGenerator::Rec_709);
+    }
+    report("waveform generator", count, frameBytes, timer.elapsed());
+
+    HistogramGenerator histogram;
+    const int components = HistogramGenerator::ComponentY | HistogramGenerator::ComponentSum | HistogramGenerator::ComponentR
+            | HistogramGenerator::ComponentG | HistogramGenerator::ComponentB;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        histogram.calculateHistogram(QSize(512, 400), *analyses.at(i % analyses.count()), components, HistogramGenerator::Rec_709, false);
+    }
+    report("histogram generator", count, frameBytes, timer.elapsed());
+
+    RGBParadeGenerator parade;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        parade.calculateRGBParade(QSize(720, 300), *analyses.at(i % analyses.count()), RGBParadeGenerator::PaintMode_RGB, true, true);
+    }
+    report("parade generator", count, frameBytes, timer.elapsed());
+
+    VectorscopeGenerator vectorscope;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        vectorscope.calculateVectorscope(QSize(400, 400), *analyses.at(i % analyses.count()), 1, VectorscopeGenerator::PaintMode_Green2,
+                                         VectorscopeGenerator::ColorSpace_YUV, true);
+    }
+    report("vectorscope generator", count, frameBytes, timer.elapsed());
+}
+
+void benchAudio(const audioShortVector &audio, int samplesPerFrame, Mlt::Producer *producer, const QString &file)
+{
+    std::cout << "Audio analysis (" << samplesPerFrame << " samples per frame)" << std::endl;
+    const int frames = audio.size() / channels / samplesPerFrame;
+    const qint64 frameBytes = samplesPerFrame * channels * sizeof(qint16);
+    QElapsedTimer timer;
+
+    // Spectrum of each frame, as done by the audio spectrum scope
+    FFTTools fftTools;
+    const uint windowSize = 2048;
+    QVector <float> spectrum(windowSize / 2);
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        const audioShortVector frame = audio.mid(i * samplesPerFrame * channels, samplesPerFrame * channels);
+        fftTools.fftNormalized(frame, 0, channels, spectrum.data(), FFTTools::Window_Hamming, windowSize, 0);
+    }
+    report("FFTTools::fftNormalized", frames, frameBytes, timer.elapsed());
+
+    if (producer != NULL) {
+        AudioEnvelope envelope(file, producer, 0, frames);
+        timer.start();
+        envelope.envelope();
+        // The envelope is computed on one channel
+        report("AudioEnvelope", envelope.envelopeSize(), samplesPerFrame * sizeof(qint16), timer.elapsed());
+    } else {
+        std::cout << "\t" << std::left << std::setw(28) << "AudioEnvelope" << std::right << "skipped, needs --file" << std::endl;
+    }
+
+    // Align the envelope on a shifted copy of itself, counting the envelope frames of both
+    const QVector <qint64> mainEnvelope = syntheticEnvelope(audio, samplesPerFrame);
+    const QVector <qint64> subEnvelope = mainEnvelope.mid(mainEnvelope.size() / 4, mainEnvelope.size() / 2);
+    const int envelopeFrames = mainEnvelope.size() + subEnvelope.size();
+    QVector <qint64> correlation(envelopeFrames + 1);
+    timer.start();
+    AudioCorrelation::correlate(mainEnvelope.constData(), mainEnvelope.size(), subEnvelope.constData(), subEnvelope.size(),
+                                correlation.data());
+    report("AudioCorrelation::correlate", envelopeFrames, sizeof(qint64), timer.elapsed());
+
+    timer.start();
+    FFTCorrelation::correlate(mainEnvelope.constData(), mainEnvelope.size(), subEnvelope.constData(), subEnvelope.size(),
+                              correlation.data());
+    report("FFTCorrelation::correlate", envelopeFrames, sizeof(qint64), timer.elapsed());
+
+    timer.start();
+    const AudioAlignment alignment = AudioCorrelation::align(mainEnvelope.constData(), mainEnvelope.size(),
+                                                             subEnvelope.constData(), subEnvelope.size());
+    report("AudioCorrelation::align", envelopeFrames, sizeof(qint64), timer.elapsed());
+    delete alignment.info;
+}
+
+void benchThumbnails(Mlt::Producer *producer, int frames, const QString &source)
+{
+    const int width = 320;
+    const int height = 180;
+    std::cout << "Thumbnails (" << source.toStdString() << ")" << std::endl;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        KThumb::getFrame(producer, i, width, height);
+    }
+    report("KThumb::getFrame", frames, width * height * 4, timer.elapsed());
+}
+
+int main(int argc, char *argv[])
+{
+    // No display is needed, painting only uses images
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeAt(0);
+
+    int frameCount = 100;
+    QSize frameSize(1920, 1080);
+    QString file;
+    QString only;
+
+    foreach (const QString &str, args) {
+        if (str.startsWith(QLatin1String("--frames="))) {
+            frameCount = qMax(1, str.section('=', 1).toInt());
+        } else if (str.startsWith(QLatin1String("--size="))) {
+            const QString size = str.section('=', 1);
+            frameSize = QSize(size.section('x', 0, 0).toInt(), size.section('x', 1).toInt());
+        } else if (str.startsWith(QLatin1String("--file="))) {
+            file = str.section('=', 1);
+        } else if (str.startsWith(QLatin1String("--only="))) {
+            only = str.section('=', 1);
+        } else {
+            printUsage(argv[0]);
+            return str == "-h" || str == "--help" ? 0 : 1;
+        }
+    }
+    if (frameSize.isEmpty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Mlt::Factory::init();
+    Mlt::Profile profile("atsc_1080p_25");
+    Mlt::Producer *producer = NULL;
+    if (!file.isEmpty()) {
+        producer = new Mlt::Producer(profile, file.toUtf8().constData());
+        if (!producer->is_valid()) {
+            std::cout << file.toStdString() << " is invalid." << std::endl;
+            return 2;
+        }
+        frameCount = qMin(frameCount, producer->get_length());
+    }
+    const int samplesPerFrame = qRound(sampleRate / profile.fps());
+
+    if (only.isEmpty() || only == QLatin1String("scopes")) {
+        // A few different frames are cycled through, to keep the memory use low
+        QList <QImage> frames;
+        for (int i = 0; i < qMin(frameCount, framePool); ++i) {
+            if (producer) {
+                frames << KThumb::getFrame(producer, i * producer->get_length() / framePool, profile.width(), profile.height());
+            } else {
+                frames << syntheticFrame(frameSize, i);
+            }
+        }
+        benchScopes(frames, frameCount);
+    }
+
+    if (only.isEmpty() || only == QLatin1String("audio")) {
+        audioShortVector audio;
+        if (producer) {
+            // Read the audio of the benchmarked frames
+            mlt_audio_format format = mlt_audio_s16;
+            for (int i = 0; i < frameCount; ++i) {
+                producer->seek(i);
+                Mlt::Frame *frame = producer->get_frame();
+                int frequency = sampleRate;
+                int frameChannels = channels;
+                int samples = samplesPerFrame;
+                const qint16 *data = static_cast<qint16 *>(frame->get_audio(format, frequency, frameChannels, samples));
+                audioShortVector frameAudio(samplesPerFrame * channels, 0);
+                if (data != NULL && frameChannels == channels) {
+                    memcpy(frameAudio.data(), data, qMin(samples, samplesPerFrame) * channels * sizeof(qint16));
+                }
+                audio += frameAudio;
+                delete frame;
+            }
+        } else {
+            audio = syntheticAudio(frameCount, profile.fps());
+        }
+        benchAudio(audio, samplesPerFrame, producer, file);
+    }
+
+    if (only.isEmpty() || only == QLatin1String("thumbs")) {
+        if (producer) {
+            benchThumbnails(producer, frameCount, file);
+        } else {
+            Mlt::Producer noise(profile, "noise:");
+            benchThumbnails(&noise, frameCount, QStringLiteral("MLT noise producer"));
+        }
+    }
+
+    delete producer;
+    return 0;
+}